@@ -61,6 +61,7 @@
 #include "ns3/GeohashHelper.h"
 #include "ns3/GlobalPacketDropController.h"
 #include "ns3/run_number.h"
+#include "ns3/ChannelUtilizationSink.h"
 #include "ns3/TxCounter.h"
 
 
@@ -160,6 +161,7 @@ std::string tracefile_1600 = "/home/zxz/idle-satmac/mobility/map.mobility-1600n.
 
 int m_loadBuildings = 0;
 std::string bldgFile;// = "src/wave/examples/9gong/buildings.xml";
+double mobilityLookAhead = 0;  // Streaming look-ahead of the mobility trace in s, 0 loads it at once
 
 // Responders users 
 //NodeContainer ueVeh;
@@ -230,6 +232,15 @@ GlobalPacketDropController& dropController = GlobalPacketDropController::GetInst
 //     Simulator::Schedule(Seconds(s_period), &PrintStatus, s_period,log_simtime);
 // }
 
+// One line per period: time count p50 p90 p99 p99.9 max, delays in us
+void PrintDelayQuantiles(Ptr<OutputStreamWrapper> log, double t, const BsmDelayHistogram &delay)
+{
+	*log->GetStream() << t << " " << delay.GetCount()
+			<< " " << delay.GetQuantile(0.5) << " " << delay.GetQuantile(0.9)
+			<< " " << delay.GetQuantile(0.99) << " " << delay.GetQuantile(0.999)
+			<< " " << delay.GetMax() << std::endl;
+}
+
 void PrintStatus(uint32_t s_period)
 {
     // 获取周期性和非周期性统计对象
@@ -244,19 +255,8 @@ void PrintStatus(uint32_t s_period)
     int periodicDelayMax, periodicDelayMin;
     periodicDelayMean = periodicStats->GetPktRecvDeltaTimeUs(&periodicDelayMax, &periodicDelayMin);
 
-	std::vector<int> *tmpvec1 = periodicStats->GetPktRecvDeltaTimeUs_vec();
-	std::vector<int>::iterator iter1;
-	for(iter1 = tmpvec1->begin(); iter1 != tmpvec1->end(); iter1++)
-	{
-		*log_deltatime_bsm->GetStream() << *iter1 << std::endl;
-	}
-
-	std::vector<int> *tmpvec2 = aperiodicStats->GetPktRecvDeltaTimeUs_vec();
-	std::vector<int>::iterator iter2;
-	for(iter2 = tmpvec2->begin(); iter2 != tmpvec2->end(); iter2++)
-	{
-		*log_deltatime_aper->GetStream() << *iter2 << std::endl;
-	}
+	PrintDelayQuantiles(log_deltatime_bsm, Simulator::Now().GetSeconds(), periodicStats->GetDelayHistogram());
+	PrintDelayQuantiles(log_deltatime_aper, Simulator::Now().GetSeconds(), aperiodicStats->GetDelayHistogram());
 
 	double bsmpdr = periodicStats->GetBsmPdr(1);
 	double culbsmpdr = periodicStats->GetCumulativeBsmPdr(1);
@@ -379,6 +379,7 @@ main (int argc, char *argv[])
     //NOTICE:obstacle shadowing model is disabled.
     cmd.AddValue ("building", "Use obstacle building shadowing.", m_loadBuildings);
     cmd.AddValue ("buildingfile", "Path of building file", bldgFile);
+    cmd.AddValue ("mobilityLookAhead", "Read the mobility trace this many seconds ahead (0: all at once)", mobilityLookAhead);
 
 
 	cmd.AddValue("run_num", "The run number", run_num);  // 将 run_num 作为命令行参数传递
@@ -424,6 +425,10 @@ main (int argc, char *argv[])
 	Simulator::Stop(MilliSeconds(simTime*1000+40));
 	Simulator::Run();
 
+	// whole run, on a last line
+	PrintDelayQuantiles(log_deltatime_bsm, Simulator::Now().GetSeconds(), m_waveBsmHelper.GetWaveBsmStats()->GetTotalDelayHistogram());
+	PrintDelayQuantiles(log_deltatime_aper, Simulator::Now().GetSeconds(), m_waveBsmHelper.GetAperiodicStats()->GetTotalDelayHistogram());
+
 	Simulator::Destroy();
 
 	NS_LOG_INFO("Simulation done.");
@@ -652,6 +657,7 @@ void config()
         std::cout<<"===Loading trace file...===" << tracefile << std::endl;
 
         Ns2MobilityHelper ns2 = Ns2MobilityHelper(tracefile);
+        ns2.SetStreamingLookAhead (Seconds (mobilityLookAhead));
         ns2.Install();
     }
 
@@ -721,6 +727,11 @@ void config()
 //    t4->TraceConnectWithoutContext ("BCHTrace", MakeBoundCallback (&SidelinkV2xAnnouncementMacTrace, host));
     tdmaDataDevices.Get (0) ->GetObject<WifiNetDevice> () -> GetPhy ()->TraceConnectWithoutContext ("PhyRxCollisionDrop", MakeCallback (&PhyRxCollisionDropTrace));
     csmaDataDevices.Get (0) ->GetObject<WifiNetDevice> () -> GetPhy ()->TraceConnectWithoutContext ("PhyRxCollisionDrop", MakeCallback (&PhyRxCollisionDropTrace));
+
+    // one line per second with the channel utilization of every tdma node
+    Ptr<ChannelUtilizationSink> channelUtilizationSink = CreateObject<ChannelUtilizationSink> ();
+    channelUtilizationSink->SetAttribute ("FileName", StringValue ("channel_utilization_run" + std::to_string (RunNumber::GetInstance ().GetRunNum ()) + ".txt"));
+    channelUtilizationSink->Install (tdmaDataDevices);
 //PhyRxCollisionDrop
 }
 
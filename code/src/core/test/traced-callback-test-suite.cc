@@ -67,6 +67,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // these methods do is to set corresponding member variables m_one and m_two.
   //
   TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "New TracedCallback not empty");
 
   //
   // Connect both callbacks to their respective test methods.  If we hit the 
@@ -75,6 +76,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   //
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbOne, this));
   trace.ConnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Connected TracedCallback empty");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -85,6 +87,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // If we now disconnect callback one then only callback two should be called.
   //
   trace.DisconnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbOne, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "TracedCallback empty with CbTwo connected");
   m_one = false;
   m_two = false;
   trace (1, 2);
@@ -95,6 +98,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // If we now disconnect callback two then neither callback should be called.
   //
   trace.DisconnectWithoutContext (MakeCallback (&BasicTracedCallbackTestCase::CbTwo, this));
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "TracedCallback not empty after the last disconnect");
   m_one = false;
   m_two = false;
   trace (1, 2);
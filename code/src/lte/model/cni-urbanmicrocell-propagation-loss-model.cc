@@ -24,6 +24,8 @@
 #include <ns3/boolean.h>
 #include "ns3/enum.h"
 #include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/rng-seed-manager.h"
 #include <cmath>
 #include "cni-urbanmicrocell-propagation-loss-model.h"
 #include <ns3/node.h>
@@ -50,6 +52,18 @@ CniUrbanmicrocellPropagationLossModel::GetTypeId (void)
 				   BooleanValue (false),
 				   MakeBooleanAccessor (&CniUrbanmicrocellPropagationLossModel::m_isLosEnabled),
 				   MakeBooleanChecker ())
+    .AddAttribute ("StatelessLos",
+                   "Derive the LOS random number of a pair of nodes from their ids and the "
+                   "seed and run number, instead of drawing and keeping one per pair.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&CniUrbanmicrocellPropagationLossModel::m_statelessLos),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LosRefreshPeriod",
+                   "With StatelessLos, the period after which a pair of nodes gets a new "
+                   "LOS random number; zero keeps it for the run.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&CniUrbanmicrocellPropagationLossModel::m_losRefreshPeriod),
+                   MakeTimeChecker (Seconds (0)))
     ;
 
   return tid;
@@ -63,7 +77,9 @@ CniUrbanmicrocellPropagationLossModel::SetFrequency (double freq)
 
 
 CniUrbanmicrocellPropagationLossModel::CniUrbanmicrocellPropagationLossModel ()
-  : PropagationLossModel ()
+  : PropagationLossModel (),
+    m_pairSeed (0),
+    m_pairSeeded (false)
 { 
   m_rand = CreateObject<UniformRandomVariable> ();
 }
@@ -72,6 +88,62 @@ CniUrbanmicrocellPropagationLossModel::~CniUrbanmicrocellPropagationLossModel ()
 {
 }
 
+// The splitmix64 finalizer: every bit of x affects every bit of the result
+static uint64_t
+MixBits (uint64_t x)
+{
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+double
+CniUrbanmicrocellPropagationLossModel::GetPairRandom (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  Ptr<Node> na = a->GetObject<Node> ();
+  Ptr<Node> nb = b->GetObject<Node> ();
+  if (m_statelessLos && na != 0 && nb != 0)
+  {
+    if (!m_pairSeeded)
+    {
+      m_pairSeed = MixBits (MixBits (RngSeedManager::GetSeed ()) ^ RngSeedManager::GetRun ());
+      m_pairSeeded = true;
+    }
+    uint64_t lo = std::min (na->GetId (), nb->GetId ());
+    uint64_t hi = std::max (na->GetId (), nb->GetId ());
+    uint64_t h = MixBits (m_pairSeed ^ (lo << 32 | hi));
+    if (m_losRefreshPeriod.IsStrictlyPositive ())
+    {
+      // each pair starts its periods at its own offset, so that the
+      // pairs do not all change together
+      uint64_t period = m_losRefreshPeriod.GetTimeStep ();
+      uint64_t epoch = (Simulator::Now ().GetTimeStep () + h % period) / period;
+      h = MixBits (h ^ MixBits (epoch + 1));
+    }
+    // the 53 high bits, scaled to [0, 1)
+    return (MixBits (h) >> 11) * (1.0 / (1ULL << 53));
+  }
+
+  MobilityDuo couple;
+  couple.a = a;
+  couple.b = b;
+  std::map<MobilityDuo, double>::iterator it_a = m_randomMap.find (couple);
+  if (it_a != m_randomMap.end ())
+  {
+    return it_a->second;
+  }
+  couple.a = b;
+  couple.b = a;
+  std::map<MobilityDuo, double>::iterator it_b = m_randomMap.find (couple);
+  if (it_b != m_randomMap.end ())
+  {
+    return it_b->second;
+  }
+  double r = m_rand->GetValue (0,1);
+  m_randomMap[couple] = r;
+  return r;
+}
+
 double
 CniUrbanmicrocellPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
 {
@@ -90,7 +162,7 @@ CniUrbanmicrocellPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobili
   double hbs1 = hbs - 1;
   double hms1 = hms - 1;
   // Propagation velocity in free space
-  double c = 3 * std::pow (10, 8);
+  double c = 3e8;
 
   // NLOS offset = NLOS loss to add to the computed pathloss
   double nlos = -5;
@@ -106,32 +178,9 @@ CniUrbanmicrocellPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobili
   double loss_free  = 20*std::log10 (dist) + 46.4 + 20*std::log10(fc/5.0); 
   NS_LOG_INFO (this << "Outdoor , the free space loss = " << loss_free);
 
-  // Generate a random number between 0 and 1 (if it doesn't already exist) to evaluate the LOS/NLOS situation
-  double r = 0.0;
-   
-  MobilityDuo couple;
-  couple.a = a;
-  couple.b = b;
-  std::map<MobilityDuo, double>::iterator it_a = m_randomMap.find (couple);
-  if (it_a != m_randomMap.end ())
-  {
-    r = it_a->second;
-  }
-  else
-  {
-    couple.a = b;
-    couple.b = a;
-    std::map<MobilityDuo, double>::iterator it_b = m_randomMap.find (couple);
-    if (it_b != m_randomMap.end ())
-    {
-      r = it_b->second;
-    }
-    else
-    {
-      m_randomMap[couple] = m_rand->GetValue (0,1);
-      r = m_randomMap[couple];
-    }
-  }
+  // Get the random number between 0 and 1 of the pair to evaluate the
+  // LOS/NLOS situation; with LOS enabled it is not needed
+  double r = m_isLosEnabled ? 0.0 : GetPairRandom (a, b);
 
   // Compute the pathloss based on 3GPP specifications
   // This model is only valid to a minimum distance of 3 meters 
@@ -178,4 +227,51 @@ CniUrbanmicrocellPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+bool
+CniUrbanmicrocellPropagationLossModel::DoIsBatchSupported (void) const
+{
+  return m_isLosEnabled;
+}
+
+void
+CniUrbanmicrocellPropagationLossModel::DoCalcRxPowerBatch (const Vector &txPosition, const Vector *positions,
+                                                           double *rxPowerDbm, uint32_t n) const
+{
+  NS_ASSERT (m_isLosEnabled);
+  // The LOS loss of GetLoss, with both branches computed and selected
+  // so that the loop has no jump. Only the logarithms are hoisted: the
+  // sums keep the order of GetLoss, so the results are bit-identical.
+  double fc = m_frequency / 1e9;
+  double c = 3e8;
+  double hms = txPosition.z;
+  double hms1 = hms - 1;
+  double logFc = std::log10 (fc);
+  double logFc5 = std::log10(fc/5.0);
+  double logHms1 = std::log10 (hms1);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    double dx = positions[i].x - txPosition.x;
+    double dy = positions[i].y - txPosition.y;
+    double dz = positions[i].z - txPosition.z;
+    double dist = std::sqrt (dx * dx + dy * dy + dz * dz);
+    double hbs1 = positions[i].z - 1;
+    double d_bp = 4 * hbs1 * hms1 * m_frequency * (1 / c);
+    double logDist = std::log10 (dist);
+    double loss_free  = 20*logDist + 46.4 + 20*logFc5;
+    double near = 22.7 * logDist + 27.0 + 20.0 * logFc;
+    double far = 40.0 * logDist + 7.56 - 17.3 * std::log10 (hbs1) - 17.3 * logHms1 + 2.7 * logFc;
+    double loss = dist >= 3 ? (dist <= d_bp ? near : far) : 0.0;
+    loss = std::max (loss_free, loss);
+    rxPowerDbm[i] -= std::max (0.0, loss);
+  }
+}
+
+double
+CniUrbanmicrocellPropagationLossModel::DoGetRxPowerUpperBound (double txPowerDbm, double distance) const
+{
+  double fc = m_frequency / 1e9;
+  double loss_free  = 20*std::log10 (distance) + 46.4 + 20*std::log10(fc/5.0);
+  return txPowerDbm - std::max (0.0, loss_free);
+}
+
 } // namespace ns3
@@ -25,6 +25,7 @@
 
 #include <ns3/propagation-loss-model.h>
 #include <ns3/propagation-environment.h>
+#include <ns3/nstime.h>
 
 namespace ns3 {
 
@@ -35,6 +36,13 @@ namespace ns3 {
  * 
  * This class implements the outdoor propagation model for 6 GHz based on 3GPP sepcifications:
  * 3GPP TR 36.885 V14.0.0 (2016-06) / Section A.1.4
+ *
+ * Whether two nodes are in LOS is decided by a uniform random number
+ * per pair of nodes. By default it is drawn on first use and kept for
+ * the run. With StatelessLos, it is instead derived by hashing the ids
+ * of the nodes with the seed and run number, so that nothing is kept
+ * per pair; with a LosRefreshPeriod, a new number is derived every
+ * period, each pair at its own phase.
  */
 class CniUrbanmicrocellPropagationLossModel : public PropagationLossModel
 {
@@ -94,10 +102,23 @@ public:
   double GetLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
 private:
+  /**
+   * \param a the first mobility model
+   * \param b the second mobility model
+   * \return the uniform random number of the pair, which decides
+   * whether the two nodes are in LOS
+   */
+  double GetPairRandom (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
 
   // inherited from PropagationLossModel
   virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  // the free space loss is a floor of GetLoss, whatever the LOS state
+  virtual double DoGetRxPowerUpperBound (double txPowerDbm, double distance) const;
+  // only with LOS enabled, when the loss depends on the positions alone
+  virtual bool DoIsBatchSupported (void) const;
+  virtual void DoCalcRxPowerBatch (const Vector &txPosition, const Vector *positions,
+                                   double *rxPowerDbm, uint32_t n) const;
   
   // The propagation frequency in Hz
   double m_frequency;
@@ -106,6 +127,13 @@ private:
   // Map to keep track of random numbers generated per pair of nodes
   //mutable std::map<Ptr<MobilityModel>, std::map<Ptr<MobilityModel>, double> > m_randomMap;
   mutable std::map<MobilityDuo, double> m_randomMap;
+  // Whether to derive the random number of a pair instead of keeping it
+  bool m_statelessLos;
+  // Period of the derived random numbers, zero to keep them for the run
+  Time m_losRefreshPeriod;
+  // Hash of the seed and run number, derived on first use
+  mutable uint64_t m_pairSeed;
+  mutable bool m_pairSeeded;
 
 };
 
@@ -43,6 +43,9 @@
 #include <ns3/boolean.h>
 #include <bitset>
 #include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
 
 
 #include "ns3/lte-rlc-tag.h"
@@ -3209,14 +3212,12 @@ std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo>
 LteUeMac::GetTxResources(SidelinkCommResourcePoolV2x::SubframeInfo subframe, PoolInfoV2x pool)
 { 		
 	NS_LOG_INFO (this << "Start Resource Allocation - Semi Persistent Scheduling"); 
-	std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo> csrA, csrB, copyCsrA; 
+	std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo> csrA, csrB; 
 	std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo>::iterator csrIt;
-	std::list<CandidateResource>::iterator sortedCsrIt; 
 	std::list<SensingData>::iterator sensingIt;  
 
 	uint16_t numCsr; // number of all Candidate Resources
 	int threshRsrp; 
-	bool erase; 
 
 	if(m_partialSensing) 
 	{		
@@ -3227,113 +3228,108 @@ LteUeMac::GetTxResources(SidelinkCommResourcePoolV2x::SubframeInfo subframe, Poo
 		// init
 		csrA = pool.m_pool->GetCandidateResources(subframe, m_t1, m_t2, m_subchLen); // SA = {ALL CSRs}
 		numCsr = csrA.size();
-		copyCsrA = csrA; 
-		//std::cout << "---------------" << std::endl; 
-
-		//std::cout << subframe.frameNo << "/" << subframe.subframeNo <<"\t NumCsr=" << (int) csrA.size() << std::endl; 
+		std::vector<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo> csrs (csrA.begin (), csrA.end ()); 
 		threshRsrp = -110;
 
-		/*for (csrIt = csrA.begin(); csrIt != csrA.end(); ++csrIt)
+		// A CSR is excluded if one of its transmissions over the next m_reselCtr
+		// reservation periods overlaps the RBs that a sensed transmission with an
+		// S-RSRP above the threshold reserved for its next 15 periods. Instead of
+		// matching every CSR against the whole sensing history for every
+		// threshold, index the subframes the CSRs are projected to, record on
+		// each of their RBs the highest S-RSRP reserved there, and derive for
+		// each CSR the highest S-RSRP reserved on its own transmissions: the CSR
+		// is excluded as long as the threshold is below it.
+		uint16_t nbRb = 0; 
+		for (uint32_t i = 0; i < csrs.size(); i++)
 		{
-			std::cout << " " << csrIt->subframe.frameNo << "/" << csrIt->subframe.subframeNo << "\t rbStart=" << (int) csrIt->rbStart << "\t rbLen=" << (int) csrIt->rbLen << std::endl; 
-		}*/
-
-		/*std::cout << "Sensed Data" << std::endl; 
-		for (sensingIt = m_sensingData.begin(); sensingIt != m_sensingData.end(); ++sensingIt)
+			nbRb = std::max<uint16_t> (nbRb, csrs[i].rbStart + csrs[i].rbLen); 
+		}
+		std::vector<int32_t> subframeSlot (1024 * 10, -1); // slot of each frameNo/subframeNo in slotRsrp, -1 if no CSR uses it
+		std::vector<double> slotRsrp; // highest reserved S-RSRP on each RB of each slot
+		std::vector<int32_t> csrSlots (csrs.size() * m_reselCtr, -1); // slot of each proposed transmission of each CSR
+		uint32_t nbSlots = 0; 
+		for (uint32_t i = 0; i < csrs.size(); i++)
 		{
-			std::cout << " " << sensingIt->m_rxInfo.subframe.frameNo << "/" << sensingIt->m_rxInfo.subframe.subframeNo << "\t rbStart=" << (int) sensingIt->m_rxInfo.rbStart << "\t rbLen=" << (int) sensingIt->m_rxInfo.rbLen << std::endl; 
-		}*/
+			for (uint8_t ctr = 0; ctr < m_reselCtr; ctr++)
+			{
+				uint32_t frameNo = csrs[i].subframe.frameNo + ctr*m_pRsvp/10;
+				if (frameNo > 2048) {
+					frameNo -= 2048; 
+				}
+				else if (frameNo > 1024) {
+					frameNo -= 1024; 
+				}
+				NS_ASSERT (frameNo > 0 && frameNo <= 1024 && csrs[i].subframe.subframeNo > 0 && csrs[i].subframe.subframeNo <= 10);
+				if (frameNo == 0 || frameNo > 1024 || csrs[i].subframe.subframeNo == 0 || csrs[i].subframe.subframeNo > 10) {
+					continue; 
+				}
+				int32_t &slot = subframeSlot[(frameNo - 1) * 10 + csrs[i].subframe.subframeNo - 1]; 
+				if (slot < 0) {
+					slot = nbSlots++; 
+					slotRsrp.resize (nbSlots * nbRb, -std::numeric_limits<double>::infinity ()); 
+				}
+				csrSlots[i * m_reselCtr + ctr] = slot; 
+			}
+		}
 
-		do
+		// check all sensed data
+		for (sensingIt = m_sensingData.begin(); sensingIt != m_sensingData.end(); sensingIt++)
 		{	
-			csrA = copyCsrA; 	
-
-			// iterate over all Candidate Resources 	
-			csrIt = csrA.begin();	
-			while (csrIt != csrA.end())
-			{	
-				erase = false; 
-
-				// calculate all proposed transmissions of current candidate resource
-				SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo csrTransmission; 
-				csrTransmission.subframe.subframeNo = csrIt->subframe.subframeNo;
-				csrTransmission.rbStart = csrIt->rbStart;
-				csrTransmission.rbLen = csrIt->rbLen;
-
-				std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo> csrTx;
-				for (uint8_t ctr = 0; ctr < m_reselCtr; ctr++)
+			uint32_t subframeNo = sensingIt->m_rxInfo.subframe.subframeNo; 
+			if (subframeNo == 0 || subframeNo > 10) {
+				continue; 
+			}
+			uint16_t rbEnd = std::min<uint16_t> (sensingIt->m_rxInfo.rbStart + sensingIt->m_rxInfo.rbLen, nbRb); 
+			// for all possible transmissions of sensed data
+			for(uint8_t ctr = 1; ctr <= 15; ctr++)
+			{
+				uint32_t frameNo = sensingIt->m_rxInfo.subframe.frameNo + ctr*sensingIt->m_pRsvpRx/10; 
+				if (frameNo > 2048) {
+					frameNo -= 2048; 
+				}
+				else if (frameNo > 1024) {
+					frameNo -= 1024; 
+				}
+				if (frameNo == 0 || frameNo > 1024) {
+					continue; 
+				}
+				int32_t slot = subframeSlot[(frameNo - 1) * 10 + subframeNo - 1]; 
+				if (slot < 0) {
+					continue; 
+				}
+				for (uint16_t rb = sensingIt->m_rxInfo.rbStart; rb < rbEnd; rb++)
 				{
-					csrTransmission.subframe.frameNo = csrIt->subframe.frameNo + ctr*m_pRsvp/10;
-					if (csrTransmission.subframe.frameNo > 2048) {
-						csrTransmission.subframe.frameNo -= 2048; 
-					}
-					else if (csrTransmission.subframe.frameNo > 1024) {
-						csrTransmission.subframe.frameNo -= 1024; 
-					}
-					csrTx.push_back (csrTransmission);
+					double &rsrp = slotRsrp[slot * nbRb + rb]; 
+					rsrp = std::max (rsrp, sensingIt->m_slRsrp); 
 				}
+			}
+		}
 
-				// check all sensed data
-				for (sensingIt = m_sensingData.begin(); sensingIt != m_sensingData.end(); sensingIt++)
-				{	
-					// calculate all possible transmissions of sensed data
-					SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo sensTransmission;
-					sensTransmission.subframe.subframeNo = sensingIt->m_rxInfo.subframe.subframeNo; 
-					sensTransmission.rbStart = sensingIt->m_rxInfo.rbStart;
-					sensTransmission.rbLen = sensingIt->m_rxInfo.rbLen; 
-
-					std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo> sensTx; 
-					for(uint8_t ctr = 1; ctr <= 15; ctr++)
-					{
-						sensTransmission.subframe.frameNo = sensingIt->m_rxInfo.subframe.frameNo + ctr*sensingIt->m_pRsvpRx/10; 
-						if (sensTransmission.subframe.frameNo > 2048) {
-							sensTransmission.subframe.frameNo -= 2048; 
-						}
-						else if (sensTransmission.subframe.frameNo > 1024) {
-							sensTransmission.subframe.frameNo -= 1024; 
-						}
-						sensTx.push_back (sensTransmission); 
-					}
+		std::vector<double> csrRsrp (csrs.size(), -std::numeric_limits<double>::infinity ()); 
+		for (uint32_t i = 0; i < csrs.size(); i++)
+		{
+			for (uint8_t ctr = 0; ctr < m_reselCtr; ctr++)
+			{
+				int32_t slot = csrSlots[i * m_reselCtr + ctr]; 
+				if (slot < 0) {
+					continue; 
+				}
+				for (uint16_t rb = csrs[i].rbStart; rb < csrs[i].rbStart + csrs[i].rbLen; rb++)
+				{
+					csrRsrp[i] = std::max (csrRsrp[i], slotRsrp[slot * nbRb + rb]); 
+				}
+			}
+		}
 
-					// for all proposed transmissions of current candidate resource
-					std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo>::iterator csrTxIt; 
-					for (csrTxIt = csrTx.begin(); csrTxIt != csrTx.end(); csrTxIt++)
-					{
-						NS_ASSERT (csrTxIt->subframe.frameNo > 0 && csrTxIt->subframe.frameNo <= 1024 && csrTxIt->subframe.subframeNo > 0 && csrTxIt->subframe.subframeNo <= 10);
-				
-						std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo>::iterator sensTxIt; 
-						for (sensTxIt = sensTx.begin(); sensTxIt != sensTx.end(); sensTxIt++)
-						{
-							// check if candidate resource transmission and possible transmission
-							// of sensed data occur in the same subframe
-							if(csrTxIt->subframe.frameNo == sensTxIt->subframe.frameNo && csrTxIt->subframe.subframeNo == sensTxIt->subframe.subframeNo)
-							{	
-								// check if the utilizied RBs overlaps with candidate resource RBs
-								for (int i = csrTxIt->rbStart; i < csrTxIt->rbStart+csrTxIt->rbLen; i++)
-								{
-									for(int j = sensTxIt->rbStart; j < sensTxIt->rbStart+sensTxIt->rbLen; j++)
-									{
-										if (i == j && sensingIt->m_slRsrp > threshRsrp) {
-											erase = true; 
-											break;
-										}	
-									}
-									if (erase) break;
-								}			
-							}
-							if (erase) break;
-						}
-					} // end for all proposed transmission of current candidate resource
-					if (erase) break;
-				} // end for all sensed data
-				if (erase) {
-					//std::cout << "erase \t" << csrIt->subframe.frameNo << "/" << csrIt->subframe.subframeNo << "\t rbStart=" << (int) csrIt->rbStart << "\t rbLen=" << (int) csrIt->rbLen << std::endl; 
-					csrIt = csrA.erase(csrIt);
+		do
+		{	
+			csrA.clear(); 
+			for (uint32_t i = 0; i < csrs.size(); i++)
+			{
+				if (csrRsrp[i] <= threshRsrp) {
+					csrA.push_back(csrs[i]); 
 				}
-				else {
-					csrIt++; 
-				}	
-			} // end while
+			}
 			threshRsrp += 3; 
 		} // end do 
 		while(csrA.size() < 0.2*numCsr); // Step 7: Repeat until the size of the resulting CSR-list is greater than the 20% of the size of all CSR
@@ -3345,44 +3341,63 @@ LteUeMac::GetTxResources(SidelinkCommResourcePoolV2x::SubframeInfo subframe, Poo
 		}*/
 
 		// Step 8: Calculate metric E defined as the linear average of S-RSSI
-		std::list <CandidateResource> m_csr; 
+		// over the last 10 transmissions on the frameNo/subframeNo of each
+		// remaining CSR. The S-RSSI of a transmission is the one of the first
+		// data sensed on that frameNo/subframeNo and subchannel, looked up by
+		// (frameNo, subframeNo, rbStart) in sensedRssi.
+		std::map<uint32_t, const SensingData *> sensedRssi; 
+		std::vector<uint32_t> rssiKeys; 
+		rssiKeys.reserve (csrA.size() * 10); 
 		for(csrIt = csrA.begin(); csrIt != csrA.end(); csrIt++) // for all remaining CSRs
 		{
-			double avg_rssi = 0; 
-			uint8_t nbTx = 0; 
-			
 			// Calculate the first transmission of current CSR frameNo/subframeNo in the sensing Window 
-			SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo sensingWindowTransmission; 
-			sensingWindowTransmission.subframe.subframeNo = csrIt->subframe.subframeNo;
-			sensingWindowTransmission.rbStart = csrIt->rbStart;
-			sensingWindowTransmission.rbLen = csrIt->rbLen;  
-
+			uint32_t frameNo; 
 			if (csrIt->subframe.frameNo <= 100) {
 				uint8_t diff = 100 - csrIt->subframe.frameNo; 
-				sensingWindowTransmission.subframe.frameNo = 1024 - diff; 
+				frameNo = 1024 - diff; 
 			}
 			else {
-				sensingWindowTransmission.subframe.frameNo = csrIt->subframe.frameNo - 100;
+				frameNo = csrIt->subframe.frameNo - 100;
+			}
+			for (uint8_t i = 0; i < 10; i++)
+			{
+				frameNo +=  10; 
+				if(frameNo > 1024) {
+					frameNo -= 1024; 
+				} 
+				uint32_t key = ((frameNo - 1) * 10 + csrIt->subframe.subframeNo - 1) * 65536 + csrIt->rbStart; 
+				rssiKeys.push_back (key); 
+				sensedRssi[key] = 0; 
 			}
+		}
+		for (sensingIt = m_sensingData.begin(); sensingIt != m_sensingData.end(); sensingIt++)
+		{
+			uint32_t key = ((sensingIt->m_rxInfo.subframe.frameNo - 1) * 10 + sensingIt->m_rxInfo.subframe.subframeNo - 1) * 65536 + sensingIt->m_rxInfo.rbStart; 
+			std::map<uint32_t, const SensingData *>::iterator rssiIt = sensedRssi.find (key); 
+			if (rssiIt != sensedRssi.end() && rssiIt->second == 0 && sensingIt->m_rxInfo.subframe.frameNo > 0 && sensingIt->m_rxInfo.subframe.frameNo <= 1024
+				&& sensingIt->m_rxInfo.subframe.subframeNo > 0 && sensingIt->m_rxInfo.subframe.subframeNo <= 10) {
+				rssiIt->second = &(*sensingIt); 
+			}
+		}
 
+		std::vector<CandidateResource> m_csr; 
+		m_csr.reserve (csrA.size()); 
+		std::vector<uint32_t>::const_iterator keyIt = rssiKeys.begin(); 
+		for(csrIt = csrA.begin(); csrIt != csrA.end(); csrIt++) // for all remaining CSRs
+		{
+			double avg_rssi = 0; 
+			uint8_t nbTx = 0; 
+			
 			// For the last 10 transmissions on CSR frameNo/subframeNo calculate
 			// the average S-RSSI 
-			for (uint8_t i = 0; i < 10; i++)
+			for (uint8_t i = 0; i < 10; i++, keyIt++)
 			{
-				sensingWindowTransmission.subframe.frameNo +=  10; 
-				if(sensingWindowTransmission.subframe.frameNo > 1024) {
-					sensingWindowTransmission.subframe.frameNo -= 1024; 
-				} 
 				// check if we received data on the frameNo/subframeNo and same subchannel
-				for (sensingIt = m_sensingData.begin(); sensingIt != m_sensingData.end(); sensingIt++)
+				const SensingData *sensed = sensedRssi[*keyIt]; 
+				if (sensed != 0)
 				{
-					//if (sensingWindowTransmission.subframe.frameNo == sensingIt->m_rxInfo.subframe.frameNo && sensingWindowTransmission.subframe.subframeNo == sensingIt->m_rxInfo.subframe.subframeNo)
-					if (sensingWindowTransmission.subframe.frameNo == sensingIt->m_rxInfo.subframe.frameNo && sensingWindowTransmission.subframe.subframeNo == sensingIt->m_rxInfo.subframe.subframeNo && sensingWindowTransmission.rbStart == sensingIt->m_rxInfo.rbStart)
-					{
-						nbTx++;
-						avg_rssi += sensingIt->m_slRssi; 
-						break; // if we find frameNo/subframeNo we can skip to next transmission 
-					}
+					nbTx++;
+					avg_rssi += sensed->m_slRssi; 
 				}
 			}
 
@@ -3401,31 +3416,28 @@ LteUeMac::GetTxResources(SidelinkCommResourcePoolV2x::SubframeInfo subframe, Poo
 
 		// mix values in m_csr otherwise only the first resources in 
 		// selection window will be choosen 
-		std::list<CandidateResource> copy = m_csr; 
-		m_csr.clear(); 
+		std::vector<CandidateResource> copy; 
+		copy.swap (m_csr); 
+		m_csr.reserve (copy.size()); 
 
 		while (copy.size() != 0)
 		{	
-			std::list<CandidateResource>::iterator it = copy.begin(); 
-			std::advance(it, m_ueSelectedUniformVariable->GetInteger (0, copy.size()-1));
+			std::vector<CandidateResource>::iterator it = copy.begin() + m_ueSelectedUniformVariable->GetInteger (0, copy.size()-1); 
 			m_csr.push_back((*it)); 
 			copy.erase(it); 
 		}
 
 		// Step 9: Select CSRs with smallest metric until the size of SB is greater than or equal to 20% of the size of all CSRs 
 		// sort by average RSSI
-		if (m_csr.size() != 0)
-		{
-			m_csr.sort([](const CandidateResource & a, const CandidateResource & b){return a.m_avg_rssi < b.m_avg_rssi;}); 
-		}
+		std::stable_sort(m_csr.begin(), m_csr.end(), [](const CandidateResource & a, const CandidateResource & b){return a.m_avg_rssi < b.m_avg_rssi;}); 
 		
-		for(sortedCsrIt = m_csr.begin(); sortedCsrIt != m_csr.end(); sortedCsrIt++)
+		for(uint32_t i = 0; i < m_csr.size(); i++)
 		{
 			if(csrB.size() >= 0.2*numCsr) {
 				break;
 			}
 			else {
-				csrB.push_back((sortedCsrIt->m_txInfo)); 
+				csrB.push_back((m_csr[i].m_txInfo)); 
 			}
 		}
 	}
@@ -42,6 +42,7 @@
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 
+class LteV2xResourceSelectionTestCase;
 
 namespace ns3 {
 
@@ -55,6 +56,8 @@ class LteUeMac :   public Object
   friend class UeMemberLteMacSapProvider;
   /// allow UeMemberLteUePhySapUser class friend access
   friend class UeMemberLteUePhySapUser;
+  /// allow the resource selection test access to the sensing state
+  friend class ::LteV2xResourceSelectionTestCase;
 
 public:
   /**
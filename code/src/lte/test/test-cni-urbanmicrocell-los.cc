@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mobility-model.h"
+#include "ns3/cni-urbanmicrocell-propagation-loss-model.h"
+#include <cmath>
+
+using namespace ns3;
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Check the LOS random numbers derived with StatelessLos
+ *
+ * Node 0 is at the centre of a circle of 100 m, with the other nodes on
+ * it, so that the loss of each pair with node 0 only depends on whether
+ * it is in LOS.
+ */
+class CniUrbanmicrocellLosTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the name of the test
+   * \param refresh the LosRefreshPeriod
+   */
+  CniUrbanmicrocellLosTestCase (std::string name, Time refresh);
+  virtual ~CniUrbanmicrocellLosTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param model the model
+   * \param los set to the LOS state of each pair with node 0
+   * \return the fraction of the pairs in LOS
+   */
+  double GetLos (Ptr<CniUrbanmicrocellPropagationLossModel> model, std::vector<bool> &los);
+  /// Check the LOS states at the time of the call against the first ones
+  void Check (void);
+
+  Time m_refresh;                                       ///< the LosRefreshPeriod
+  NodeContainer m_nodes;                                ///< the nodes
+  Ptr<CniUrbanmicrocellPropagationLossModel> m_model;   ///< the model under test
+  std::vector<bool> m_first;                            ///< the LOS states of the first check
+  double m_changed;                                     ///< fraction of the states changed at the last check
+};
+
+CniUrbanmicrocellLosTestCase::CniUrbanmicrocellLosTestCase (std::string name, Time refresh)
+  : TestCase (name),
+    m_refresh (refresh),
+    m_changed (-1)
+{
+}
+
+CniUrbanmicrocellLosTestCase::~CniUrbanmicrocellLosTestCase ()
+{
+}
+
+double
+CniUrbanmicrocellLosTestCase::GetLos (Ptr<CniUrbanmicrocellPropagationLossModel> model, std::vector<bool> &los)
+{
+  Ptr<MobilityModel> centre = m_nodes.Get (0)->GetObject<MobilityModel> ();
+  los.clear ();
+  uint32_t count = 0;
+  for (uint32_t i = 1; i < m_nodes.GetN (); i++)
+    {
+      Ptr<MobilityModel> other = m_nodes.Get (i)->GetObject<MobilityModel> ();
+      double loss = model->GetLoss (centre, other);
+      // the order of the nodes does not matter
+      NS_TEST_EXPECT_MSG_EQ (model->GetLoss (other, centre), loss, "asymmetric loss for node " << i);
+      // at 100 m the LOS loss is about 100 dB, the NLOS one about 120 dB
+      los.push_back (loss < 110);
+      count += los.back ();
+    }
+  return double (count) / los.size ();
+}
+
+void
+CniUrbanmicrocellLosTestCase::Check (void)
+{
+  std::vector<bool> los;
+  GetLos (m_model, los);
+  uint32_t changed = 0;
+  for (uint32_t i = 0; i < los.size (); i++)
+    {
+      changed += los[i] != m_first[i];
+    }
+  m_changed = double (changed) / los.size ();
+}
+
+void
+CniUrbanmicrocellLosTestCase::DoRun (void)
+{
+  m_nodes.Create (2001);
+  MobilityHelper mobility;
+  mobility.Install (m_nodes);
+  m_nodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (0, 0, 1.5));
+  for (uint32_t i = 1; i < m_nodes.GetN (); i++)
+    {
+      double angle = 2 * M_PI * i / (m_nodes.GetN () - 1);
+      m_nodes.Get (i)->GetObject<MobilityModel> ()->SetPosition (Vector (100 * std::cos (angle), 100 * std::sin (angle), 1.5));
+    }
+
+  m_model = CreateObject<CniUrbanmicrocellPropagationLossModel> ();
+  m_model->SetAttribute ("StatelessLos", BooleanValue (true));
+  m_model->SetAttribute ("LosRefreshPeriod", TimeValue (m_refresh));
+  double fraction = GetLos (m_model, m_first);
+  // the LOS probability at 100 m
+  double plos = 0.18 * (1 - std::exp (-100.0 / 36)) + std::exp (-100.0 / 36);
+  NS_TEST_ASSERT_MSG_EQ_TOL (fraction, plos, 0.03, "LOS fraction does not follow the LOS probability");
+
+  // a second model of the same run derives the same numbers
+  Ptr<CniUrbanmicrocellPropagationLossModel> other = CreateObject<CniUrbanmicrocellPropagationLossModel> ();
+  other->SetAttribute ("StatelessLos", BooleanValue (true));
+  other->SetAttribute ("LosRefreshPeriod", TimeValue (m_refresh));
+  std::vector<bool> los;
+  GetLos (other, los);
+  NS_TEST_ASSERT_MSG_EQ ((los == m_first), true, "LOS states differ between two models");
+
+  Simulator::Schedule (Seconds (10), &CniUrbanmicrocellLosTestCase::Check, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  if (m_refresh.IsZero ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_changed, 0, "LOS states changed without a refresh period");
+    }
+  else
+    {
+      // a state changes when two independent draws disagree
+      NS_TEST_ASSERT_MSG_EQ_TOL (m_changed, 2 * plos * (1 - plos), 0.05, "LOS states not refreshed");
+    }
+  m_model = 0;
+  m_nodes = NodeContainer ();
+}
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Check the batched Rx power against the one of each receiver,
+ * with LOS enabled
+ */
+class CniUrbanmicrocellBatchTestCase : public TestCase
+{
+public:
+  CniUrbanmicrocellBatchTestCase ();
+  virtual ~CniUrbanmicrocellBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CniUrbanmicrocellBatchTestCase::CniUrbanmicrocellBatchTestCase ()
+  : TestCase ("Check the batched Rx power of CniUrbanmicrocellPropagationLossModel")
+{
+}
+
+CniUrbanmicrocellBatchTestCase::~CniUrbanmicrocellBatchTestCase ()
+{
+}
+
+void
+CniUrbanmicrocellBatchTestCase::DoRun (void)
+{
+  Ptr<CniUrbanmicrocellPropagationLossModel> model = CreateObject<CniUrbanmicrocellPropagationLossModel> ();
+  NS_TEST_ASSERT_MSG_EQ (model->IsBatchSupported (), false, "LOS draws need the nodes");
+  model->SetAttribute ("LosEnabled", BooleanValue (true));
+  NS_TEST_ASSERT_MSG_EQ (model->IsBatchSupported (), true, "LOS enabled supports batches");
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  MobilityHelper mobility;
+  mobility.Install (nodes);
+  Ptr<MobilityModel> a = nodes.Get (0)->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> b = nodes.Get (1)->GetObject<MobilityModel> ();
+  a->SetPosition (Vector (0, 0, 1.5));
+  std::vector<Vector> positions;
+  // the transmitter, below 3 m, and both sides of the breakpoint distance
+  for (uint32_t i = 0; i < 60; i++)
+    {
+      positions.push_back (Vector (i * i * 0.5, i, 1.5 + (i % 3) * 0.5));
+    }
+  std::vector<double> rxPowerDbm;
+  model->CalcRxPowerBatch (23.0, a, positions, rxPowerDbm);
+  for (uint32_t i = 0; i < positions.size (); i++)
+    {
+      b->SetPosition (positions[i]);
+      // bit-identical, as the batch may replace CalcRxPower in a channel
+      NS_TEST_EXPECT_MSG_EQ (rxPowerDbm[i], model->CalcRxPower (23.0, a, b),
+                             "wrong power at " << positions[i]);
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief CniUrbanmicrocellPropagationLossModel LOS Test Suite
+ */
+static class CniUrbanmicrocellLosTestSuite : public TestSuite
+{
+public:
+  CniUrbanmicrocellLosTestSuite () : TestSuite ("cni-urbanmicrocell-los", UNIT)
+  {
+    AddTestCase (new CniUrbanmicrocellLosTestCase ("Check the LOS random numbers derived with StatelessLos",
+                                                   Seconds (0)), TestCase::QUICK);
+    AddTestCase (new CniUrbanmicrocellLosTestCase ("Check the LOS random numbers refreshed every LosRefreshPeriod",
+                                                   Seconds (1)), TestCase::QUICK);
+    AddTestCase (new CniUrbanmicrocellBatchTestCase (), TestCase::QUICK);
+  }
+} g_cniUrbanmicrocellLosTestSuite; ///< the test suite
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/lte-ue-mac.h"
+#include "ns3/sl-pool.h"
+#include "ns3/sl-v2x-preconfig-pool-factory.h"
+#include <list>
+
+using namespace ns3;
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Pin the mode 4 resource selection of LteUeMac::GetTxResources
+ *
+ * A pool of 3 subchannels of 10 RBs and a selection window of 17 subframes
+ * give 51 candidate resources. The sensing history reserves most of them
+ * over several reservation periods with S-RSRPs that make the RSRP
+ * threshold step up once, and has S-RSSIs that rank the 14 remaining
+ * ones. The 11 resources selected are compared with the ones selected when
+ * the test was written.
+ */
+class LteV2xResourceSelectionTestCase : public TestCase
+{
+public:
+  LteV2xResourceSelectionTestCase ();
+  virtual ~LteV2xResourceSelectionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Add a sensed transmission to the sensing history of the mac.
+   * \param mac the mac
+   * \param frameNo the frame of the transmission
+   * \param subframeNo the subframe of the transmission
+   * \param subchannel the subchannel of the transmission
+   * \param pRsvp the reservation period announced, in ms
+   * \param rsrp the S-RSRP, in dBm
+   * \param rssi the S-RSSI, in dBm
+   */
+  static void AddSensed (Ptr<LteUeMac> mac, uint32_t frameNo, uint32_t subframeNo, uint16_t subchannel,
+                         uint16_t pRsvp, double rsrp, double rssi);
+};
+
+LteV2xResourceSelectionTestCase::LteV2xResourceSelectionTestCase ()
+  : TestCase ("Check the resources selected for a fixed sensing history")
+{
+}
+
+LteV2xResourceSelectionTestCase::~LteV2xResourceSelectionTestCase ()
+{
+}
+
+void
+LteV2xResourceSelectionTestCase::AddSensed (Ptr<LteUeMac> mac, uint32_t frameNo, uint32_t subframeNo, uint16_t subchannel,
+                                            uint16_t pRsvp, double rsrp, double rssi)
+{
+  LteUeMac::SensingData sensed;
+  sensed.m_rxInfo.subframe.frameNo = frameNo;
+  sensed.m_rxInfo.subframe.subframeNo = subframeNo;
+  sensed.m_rxInfo.rbStart = 10 * subchannel + 2;
+  sensed.m_rxInfo.rbLen = 8;
+  sensed.m_prioRx = 0;
+  sensed.m_pRsvpRx = pRsvp;
+  sensed.m_slRsrp = rsrp;
+  sensed.m_slRssi = rssi;
+  mac->m_sensingData.push_back (sensed);
+}
+
+void
+LteV2xResourceSelectionTestCase::DoRun (void)
+{
+  SlV2xPreconfigPoolFactory factory;
+  factory.SetHaveUeSelectedResourceConfig (true);
+  factory.SetSlSubframe (std::bitset<20> (0xFFFFF));
+  factory.SetAdjacencyPscchPssch (true);
+  factory.SetSizeSubchannel (10);
+  factory.SetNumSubchannel (3);
+  factory.SetStartRbSubchannel (0);
+  factory.SetStartRbPscchPool (0);
+  factory.SetDataTxP0 (-4);
+  factory.SetDataTxAlpha (0.9);
+  Ptr<SidelinkTxCommResourcePoolV2x> pool = CreateObject<SidelinkTxCommResourcePoolV2x> ();
+  pool->SetPool (factory.CreatePool ());
+
+  Ptr<LteUeMac> mac = CreateObject<LteUeMac> ();
+  mac->SetAttribute ("SlPrsvp", UintegerValue (100));
+  mac->SetAttribute ("SelectionWindowT1", UintegerValue (4));
+  mac->SetAttribute ("SelectionWindowT2", UintegerValue (20));
+  mac->m_ueSelectedUniformVariable->SetStream (1);
+  mac->m_reselCtr = 5;
+
+  // the candidates are frame 100 subframes 9 and 10, frame 101 and frame 102
+  // subframes 1 to 5; project sensed transmissions onto them
+  for (uint32_t i = 0; i < 17; i++)
+    {
+      uint32_t frameNo = 100 + (i + 8) / 10;
+      uint32_t subframeNo = (i + 8) % 10 + 1;
+      for (uint16_t subchannel = 0; subchannel < 3; subchannel++)
+        {
+          if ((i + subchannel) % 8 == 7)
+            {
+              continue;
+            }
+          double rsrp = -108.0 + 3 * ((3 * i + subchannel) % 5);
+          double rssi = -90.0 + (7 * i + 3 * subchannel) % 11;
+          // one period back
+          AddSensed (mac, frameNo - 10, subframeNo, subchannel, 100, rsrp, rssi);
+          if (i % 3 == 0)
+            {
+              // several periods back, reserved for the next 15 periods
+              AddSensed (mac, frameNo - 50, subframeNo, subchannel, 100, rsrp + 1, rssi - 4);
+            }
+        }
+      // a short reservation period, reaching the later transmissions of the candidates
+      if (i % 5 == 1)
+        {
+          AddSensed (mac, frameNo - 8, subframeNo, (i / 5) % 3, 20, -101, -85);
+        }
+    }
+  // a transmission across the frame number wrap
+  AddSensed (mac, 1020, 3, 1, 100, -95, -80);
+
+  SidelinkCommResourcePoolV2x::SubframeInfo subframe;
+  subframe.frameNo = 100;
+  subframe.subframeNo = 5;
+  LteUeMac::PoolInfoV2x poolInfo;
+  poolInfo.m_pool = pool;
+  std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo> selected = mac->GetTxResources (subframe, poolInfo);
+
+  // frameNo, subframeNo, rbStart of the selected resources, in order
+  const uint32_t expected[][3] = {
+    { 102, 2, 22 }, { 102, 4, 2 }, { 101, 4, 22 }, { 102, 3, 12 },
+    { 101, 6, 2 }, { 100, 9, 2 }, { 101, 2, 12 }, { 101, 5, 22 },
+    { 100, 10, 22 }, { 101, 4, 2 }, { 101, 7, 12 },
+  };
+  const uint32_t nbExpected = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (selected.size (), nbExpected, "wrong number of resources selected");
+  uint32_t i = 0;
+  for (std::list<SidelinkCommResourcePoolV2x::SidelinkTransmissionInfo>::const_iterator it = selected.begin ();
+       it != selected.end (); ++it, ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (it->subframe.frameNo, expected[i][0], "wrong frame of resource " << i);
+      NS_TEST_ASSERT_MSG_EQ (it->subframe.subframeNo, expected[i][1], "wrong subframe of resource " << i);
+      NS_TEST_ASSERT_MSG_EQ (it->rbStart, expected[i][2], "wrong first RB of resource " << i);
+      NS_TEST_ASSERT_MSG_EQ (it->rbLen, 8, "wrong RB count of resource " << i);
+    }
+  mac->Dispose ();
+}
+
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief V2X resource selection Test Suite
+ */
+static class LteV2xResourceSelectionTestSuite : public TestSuite
+{
+public:
+  LteV2xResourceSelectionTestSuite () : TestSuite ("lte-v2x-resource-selection", UNIT)
+  {
+    AddTestCase (new LteV2xResourceSelectionTestCase (), TestCase::QUICK);
+  }
+} g_lteV2xResourceSelectionTestSuite; ///< the test suite
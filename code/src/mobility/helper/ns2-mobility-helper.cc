@@ -165,10 +165,30 @@ static bool IsSchedSetPos (ParseResult pr);
  */
 static bool IsSchedMobilityPos (ParseResult pr);
 
+/**
+ * Check that the time of a scheduled event is a valid time
+ * \param pr the parsed line
+ * \param at the time to return
+ * \return true if the time is a non negative number
+ */
+static bool GetSchedTime (ParseResult const &pr, double &at);
+
+/**
+ * Schedule the mobility changes of a setdest or scheduled set line
+ * \param pr the parsed line
+ * \param model mobility model of the node
+ * \param lastPos previous movement scheduled for the node
+ * \param base time the trace times are relative to
+ * \param at time of the event
+ * \param parsePosition the position scheduled sets apply to, or 0 to use the model position
+ */
+static void ScheduleEvent (ParseResult const &pr, Ptr<ConstantVelocityMobilityModel> model, DestinationPoint &lastPos,
+                           Time base, double at, Vector *parsePosition);
+
 /**
  * Set waypoints and speed for movement.
  */
-static DestinationPoint SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector lastPos, double at,
+static DestinationPoint SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector lastPos, Time base, double at,
                                      double xFinalPosition, double yFinalPosition, double speed);
 
 /**
@@ -179,16 +199,146 @@ static Vector SetInitialPosition (Ptr<ConstantVelocityMobilityModel> model, std:
 /** 
  * Schedule a set of position for a node
  */
-static Vector SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, double at, std::string coord, double coordVal);
+static Vector SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, Time base, double at, std::string coord, double coordVal,
+                                Vector *parsePosition);
+
+
+/**
+ * Reads the scheduled events of a trace as the simulation advances,
+ * see Ns2MobilityHelper::SetStreamingLookAhead. The stream is kept alive
+ * by the event of its next read.
+ */
+class Ns2MobilityStream : public SimpleRefCount<Ns2MobilityStream>
+{
+public:
+  /**
+   * \param filename the trace file
+   * \param base time the trace times are relative to
+   * \param lookAhead how far ahead of the simulation events are read
+   */
+  Ns2MobilityStream (std::string filename, Time base, Time lookAhead);
+  /**
+   * Schedule the events up to the look-ahead horizon, then schedule the
+   * next read.
+   */
+  void Read (void);
+
+  std::map<int, Ptr<ConstantVelocityMobilityModel> > m_models; //!< Mobility model of each node of the trace
+  std::map<int, DestinationPoint> m_lastPos; //!< Previous movement scheduled for each node
+  std::map<int, Vector> m_parsePosition;     //!< Position scheduled sets apply to for each node
+
+private:
+  /**
+   * Read the next scheduled event of the trace
+   * \return false at the end of the trace
+   */
+  bool Next (void);
+
+  std::ifstream m_file;   //!< The trace
+  Time m_base;            //!< Time the trace times are relative to
+  Time m_lookAhead;       //!< How far ahead of the simulation events are read
+  ParseResult m_pending;  //!< Next event to schedule
+  int m_nodeId;           //!< Node of the next event
+  double m_at;            //!< Time of the next event
+  bool m_hasPending;      //!< Whether m_pending holds an event
+};
+
+Ns2MobilityStream::Ns2MobilityStream (std::string filename, Time base, Time lookAhead)
+  : m_file (filename.c_str (), std::ios::in),
+    m_base (base),
+    m_lookAhead (lookAhead),
+    m_nodeId (-1),
+    m_at (0),
+    m_hasPending (false)
+{
+}
+
+bool
+Ns2MobilityStream::Next (void)
+{
+  std::string line;
+  while (getline (m_file, line))
+    {
+      // initial positions, bad lines and unknown nodes were dealt with
+      // when the trace was first scanned
+      if (line.empty ())
+        {
+          continue;
+        }
+      m_pending = ParseNs2Line (line);
+      if (m_pending.tokens.size () != 7 && m_pending.tokens.size () != 8)
+        {
+          continue;
+        }
+      m_nodeId = GetNodeIdInt (m_pending);
+      if (m_models.find (m_nodeId) == m_models.end ())
+        {
+          continue;
+        }
+      if (!GetSchedTime (m_pending, m_at))
+        {
+          continue;
+        }
+      if (IsSchedMobilityPos (m_pending) || IsSchedSetPos (m_pending))
+        {
+          return true;
+        }
+      NS_LOG_WARN ("Format Line is not correct: " << line << "\n");
+    }
+  return false;
+}
+
+void
+Ns2MobilityStream::Read (void)
+{
+  if (!m_hasPending)
+    {
+      m_hasPending = Next ();
+    }
+  while (m_hasPending)
+    {
+      Time when = m_base + Seconds (m_at);
+      if (when > Simulator::Now () + m_lookAhead)
+        {
+          Simulator::Schedule (when - m_lookAhead - Simulator::Now (), &Ns2MobilityStream::Read,
+                               Ptr<Ns2MobilityStream> (this));
+          return;
+        }
+      if (when < Simulator::Now ())
+        {
+          NS_FATAL_ERROR ("Event at " << m_at << "s read at " << (Simulator::Now () - m_base).GetSeconds ()
+                                      << "s: the trace is not sorted within the streaming look-ahead");
+        }
+      // An event may cancel the stop of the previous movement of its node,
+      // which must not have run yet
+      DestinationPoint &lastPos = m_lastPos[m_nodeId];
+      if (m_at < lastPos.m_travelStartTime)
+        {
+          NS_FATAL_ERROR ("Event at " << m_at << "s of node " << m_nodeId << " follows one at "
+                                      << lastPos.m_travelStartTime << "s: the trace must be sorted by time for streaming");
+        }
+      ScheduleEvent (m_pending, m_models[m_nodeId], lastPos, m_base, m_at, &m_parsePosition[m_nodeId]);
+      m_hasPending = Next ();
+    }
+  m_file.close ();
+}
 
 
 Ns2MobilityHelper::Ns2MobilityHelper (std::string filename)
-  : m_filename (filename)
+  : m_filename (filename),
+    m_lookAhead (Seconds (0))
 {
   std::ifstream file (m_filename.c_str (), std::ios::in);
   if (!(file.is_open ())) NS_FATAL_ERROR("Could not open trace file " << m_filename.c_str() << " for reading, aborting here \n"); 
 }
 
+void
+Ns2MobilityHelper::SetStreamingLookAhead (Time lookAhead)
+{
+  NS_ASSERT (!lookAhead.IsStrictlyNegative ());
+  m_lookAhead = lookAhead;
+}
+
 Ptr<ConstantVelocityMobilityModel>
 Ns2MobilityHelper::GetMobilityModel (std::string idString, const ObjectStore &store) const
 {
@@ -215,6 +365,17 @@ void
 Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 {
   std::map<int, DestinationPoint> last_pos;    // Stores previous movement scheduled for each node
+  Time base = Simulator::Now ();               // Trace times are relative to the install time
+
+  // In streaming mode the first parse also resolves the mobility models
+  // of the nodes of the scheduled events, and replays the position
+  // updates the second parse would make when scheduling a set.
+  Ptr<Ns2MobilityStream> stream;
+  std::map<std::pair<int, std::string>, double> sched_sets; // Last scheduled set of each node and coordinate
+  if (m_lookAhead.IsStrictlyPositive ())
+    {
+      stream = Create<Ns2MobilityStream> (m_filename, base, m_lookAhead);
+    }
 
   //*****************************************************************
   // Parse the file the first time to get the initial node positions.
@@ -244,7 +405,7 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 
           // Check if the line corresponds with setting the initial
           // node positions
-          if (pr.tokens.size () != 4)
+          if (pr.tokens.size () != 4 && (stream == 0 || (pr.tokens.size () != 7 && pr.tokens.size () != 8)))
             {
               continue;
             }
@@ -268,6 +429,15 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
               continue;
             }
 
+          if (stream != 0)
+            {
+              stream->m_models[iNodeId] = model;
+              double at;
+              if (pr.tokens.size () == 7 && IsSchedSetPos (pr) && GetSchedTime (pr, at))
+                {
+                  sched_sets[std::make_pair (iNodeId, pr.tokens[5])] = pr.dvals[6];
+                }
+            }
 
           /*
            * In this case a initial position is being seted
@@ -288,6 +458,27 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
       file.close ();
     }
 
+  if (stream != 0)
+    {
+      // Scheduled sets apply to the position the previous ones left,
+      // which the second parse takes from the model and sets back.
+      std::map<int, Ptr<ConstantVelocityMobilityModel> >::const_iterator i;
+      for (i = stream->m_models.begin (); i != stream->m_models.end (); ++i)
+        {
+          stream->m_parsePosition[i->first] = i->second->GetPosition ();
+        }
+      std::map<std::pair<int, std::string>, double>::iterator j;
+      for (j = sched_sets.begin (); j != sched_sets.end (); ++j)
+        {
+          Ptr<ConstantVelocityMobilityModel> model = stream->m_models[j->first.first];
+          std::string coord = j->first.second;
+          model->SetPosition (SetOneInitialCoord (model->GetPosition (), coord, j->second));
+        }
+      stream->m_lastPos = last_pos;
+      stream->Read ();
+      return;
+    }
+
   //*****************************************************************
   // Parse the file a second time to get the rest of its values
   //*****************************************************************
@@ -358,63 +549,14 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
               // This is a scheduled event, so time at should be present
               double at;
 
-              if (!IsNumber (pr.tokens[2]))
+              if (!GetSchedTime (pr, at))
                 {
-                  NS_LOG_WARN ("Time is not a number: " << pr.tokens[2]);
                   continue;
                 }
 
-              at = pr.dvals[2]; // set time at
-
-              if ( at < 0 )
-                {
-                  NS_LOG_WARN ("Time is less than cero: " << at);
-                  continue;
-                }
-
-
-
-              /*
-               * In this case a new waypoint is added
-               * line like $ns_ at 1 "$node_(0) setdest 2 3 4"
-               */
-              if (IsSchedMobilityPos (pr))
-                {
-                  if (last_pos[iNodeId].m_targetArrivalTime > at)
-                    {
-                      NS_LOG_LOGIC ("Did not reach a destination! stoptime = " << last_pos[iNodeId].m_targetArrivalTime << ", at = "<<  at);
-                      double actuallytraveled = at - last_pos[iNodeId].m_travelStartTime;
-                      Vector reached = Vector (
-                          last_pos[iNodeId].m_startPosition.x + last_pos[iNodeId].m_speed.x * actuallytraveled,
-                          last_pos[iNodeId].m_startPosition.y + last_pos[iNodeId].m_speed.y * actuallytraveled,
-                          0
-                          );
-                      NS_LOG_LOGIC ("Final point = " << last_pos[iNodeId].m_finalPosition << ", actually reached = " << reached);
-                      last_pos[iNodeId].m_stopEvent.Cancel ();
-                      last_pos[iNodeId].m_finalPosition = reached;
-                    }
-                  //                                     last position     time  X coord     Y coord      velocity
-                  last_pos[iNodeId] = SetMovement (model, last_pos[iNodeId].m_finalPosition, at, pr.dvals[5], pr.dvals[6], pr.dvals[7]);
-
-                  // Log new position
-                  NS_LOG_DEBUG ("Positions after parse for node " << iNodeId << " " << nodeId << " position =" << last_pos[iNodeId].m_finalPosition);
-                }
-
-
-              /*
-               * Scheduled set position
-               * line like $ns_ at 4.634906291962 "$node_(0) set X_ 28.675920486450"
-               */
-              else if (IsSchedSetPos (pr))
+              if (IsSchedMobilityPos (pr) || IsSchedSetPos (pr))
                 {
-                  //                                         time  coordinate   coord value
-                  last_pos[iNodeId].m_finalPosition = SetSchedPosition (model, at, pr.tokens[5], pr.dvals[6]);
-                  if (last_pos[iNodeId].m_targetArrivalTime > at)
-                    {
-                      last_pos[iNodeId].m_stopEvent.Cancel ();
-                    }
-                  last_pos[iNodeId].m_targetArrivalTime = at;
-                  last_pos[iNodeId].m_travelStartTime = at;
+                  ScheduleEvent (pr, model, last_pos[iNodeId], base, at, 0);
                   // Log new position
                   NS_LOG_DEBUG ("Positions after parse for node " << iNodeId << " " << nodeId <<
                                 " position =" << last_pos[iNodeId].m_finalPosition);
@@ -430,6 +572,72 @@ Ns2MobilityHelper::ConfigNodesMovements (const ObjectStore &store) const
 }
 
 
+bool
+GetSchedTime (ParseResult const &pr, double &at)
+{
+  if (!IsNumber (pr.tokens[2]))
+    {
+      NS_LOG_WARN ("Time is not a number: " << pr.tokens[2]);
+      return false;
+    }
+
+  at = pr.dvals[2]; // set time at
+
+  if ( at < 0 )
+    {
+      NS_LOG_WARN ("Time is less than cero: " << at);
+      return false;
+    }
+  return true;
+}
+
+
+void
+ScheduleEvent (ParseResult const &pr, Ptr<ConstantVelocityMobilityModel> model, DestinationPoint &lastPos,
+               Time base, double at, Vector *parsePosition)
+{
+  /*
+   * In this case a new waypoint is added
+   * line like $ns_ at 1 "$node_(0) setdest 2 3 4"
+   */
+  if (IsSchedMobilityPos (pr))
+    {
+      if (lastPos.m_targetArrivalTime > at)
+        {
+          NS_LOG_LOGIC ("Did not reach a destination! stoptime = " << lastPos.m_targetArrivalTime << ", at = "<<  at);
+          double actuallytraveled = at - lastPos.m_travelStartTime;
+          Vector reached = Vector (
+              lastPos.m_startPosition.x + lastPos.m_speed.x * actuallytraveled,
+              lastPos.m_startPosition.y + lastPos.m_speed.y * actuallytraveled,
+              0
+              );
+          NS_LOG_LOGIC ("Final point = " << lastPos.m_finalPosition << ", actually reached = " << reached);
+          lastPos.m_stopEvent.Cancel ();
+          lastPos.m_finalPosition = reached;
+        }
+      //                              last position      base  time  X coord      Y coord      velocity
+      lastPos = SetMovement (model, lastPos.m_finalPosition, base, at, pr.dvals[5], pr.dvals[6], pr.dvals[7]);
+    }
+
+
+  /*
+   * Scheduled set position
+   * line like $ns_ at 4.634906291962 "$node_(0) set X_ 28.675920486450"
+   */
+  else if (IsSchedSetPos (pr))
+    {
+      //                                                  base  time  coordinate    coord value
+      lastPos.m_finalPosition = SetSchedPosition (model, base, at, pr.tokens[5], pr.dvals[6], parsePosition);
+      if (lastPos.m_targetArrivalTime > at)
+        {
+          lastPos.m_stopEvent.Cancel ();
+        }
+      lastPos.m_targetArrivalTime = at;
+      lastPos.m_travelStartTime = at;
+    }
+}
+
+
 ParseResult
 ParseNs2Line (const std::string& str)
 {
@@ -730,7 +938,7 @@ IsSchedMobilityPos (ParseResult pr)
 }
 
 DestinationPoint
-SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double at,
+SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, Time base, double at,
              double xFinalPosition, double yFinalPosition, double speed)
 {
   DestinationPoint retval;
@@ -742,7 +950,7 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
   if (speed == 0)
     {
       // We have to maintain last position, and stop the movement
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model,
+      retval.m_stopEvent = Simulator::Schedule (base + Seconds (at) - Simulator::Now (), &ConstantVelocityMobilityModel::SetVelocity, model,
                                                 Vector (0, 0, 0));
       return retval;
     }
@@ -766,8 +974,8 @@ SetMovement (Ptr<ConstantVelocityMobilityModel> model, Vector last_pos, double a
       NS_LOG_DEBUG ("Calculated Speed: X=" << xSpeed << " Y=" << ySpeed << " Z=" << zSpeed);
 
       // Set the Values
-      Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (xSpeed, ySpeed, zSpeed));
-      retval.m_stopEvent = Simulator::Schedule (Seconds (at + time), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
+      Simulator::Schedule (base + Seconds (at) - Simulator::Now (), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (xSpeed, ySpeed, zSpeed));
+      retval.m_stopEvent = Simulator::Schedule (base + Seconds (at + time) - Simulator::Now (), &ConstantVelocityMobilityModel::SetVelocity, model, Vector (0, 0, 0));
       retval.m_finalPosition.x += xSpeed * time;
       retval.m_finalPosition.y += ySpeed * time;
       retval.m_targetArrivalTime += time;
@@ -791,18 +999,28 @@ SetInitialPosition (Ptr<ConstantVelocityMobilityModel> model, std::string coord,
 
 // Schedule a set of position for a node
 Vector
-SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, double at, std::string coord, double coordVal)
+SetSchedPosition (Ptr<ConstantVelocityMobilityModel> model, Time base, double at, std::string coord, double coordVal,
+                  Vector *parsePosition)
 {
-  // update position
-  model->SetPosition (SetOneInitialCoord (model->GetPosition (), coord, coordVal));
-
   Vector position;
-  position.x = model->GetPosition ().x;
-  position.y = model->GetPosition ().y;
-  position.z = model->GetPosition ().z;
+  if (parsePosition != 0)
+    {
+      // streaming: the model was already given its final parse position
+      *parsePosition = SetOneInitialCoord (*parsePosition, coord, coordVal);
+      position = *parsePosition;
+    }
+  else
+    {
+      // update position
+      model->SetPosition (SetOneInitialCoord (model->GetPosition (), coord, coordVal));
+
+      position.x = model->GetPosition ().x;
+      position.y = model->GetPosition ().y;
+      position.z = model->GetPosition ().z;
+    }
 
   // Chedule next positions
-  Simulator::Schedule (Seconds (at), &ConstantVelocityMobilityModel::SetPosition, model,position);
+  Simulator::Schedule (base + Seconds (at) - Simulator::Now (), &ConstantVelocityMobilityModel::SetPosition, model,position);
 
   return position;
 }
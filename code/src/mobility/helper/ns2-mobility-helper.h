@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include "ns3/ptr.h"
 #include "ns3/object.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
@@ -69,6 +70,11 @@ class ConstantVelocityMobilityModel;
  *
  *  See usage example in examples/mobility/ns2-mobility-trace.cc
  *
+ * By default the whole trace is read at install time and every movement
+ * event is scheduled up front. For long traces of many nodes,
+ * SetStreamingLookAhead makes the helper read the scheduled events as
+ * the simulation advances instead, keeping only a window of them pending.
+ *
  * \bug Rounding errors may cause movement to diverge from the mobility
  * pattern in ns-2 (using the same trace).
  * See https://www.nsnam.org/bugzilla/show_bug.cgi?id=1316
@@ -82,6 +88,26 @@ public:
    */
   Ns2MobilityHelper (std::string filename);
 
+  /**
+   * \param lookAhead how far ahead of the simulation time scheduled
+   *        events are read from the trace; zero, the default, reads
+   *        the whole trace at install time.
+   *
+   * In streaming mode the trace is still scanned once at install time
+   * for the initial node positions, but the movement events are read
+   * incrementally: an event at time t is scheduled no later than
+   * t - lookAhead, so at most the events of a lookAhead window are
+   * pending at any time. The resulting trajectories are the same as
+   * with the default mode, provided that the events of each node are
+   * sorted by time and that the trace as a whole is sorted closely
+   * enough: an event earlier than a previous event of its node, or
+   * earlier than a previous event of the trace by more than lookAhead,
+   * is a fatal error. Mobility events
+   * are scheduled later than in the default mode, so they may run after
+   * other events scheduled for the very same time.
+   */
+  void SetStreamingLookAhead (Time lookAhead);
+
   /**
    * Read the ns2 trace file and configure the movement
    * patterns of all nodes contained in the global ns3::NodeList
@@ -131,6 +157,7 @@ public:
    */
   Ptr<ConstantVelocityMobilityModel> GetMobilityModel (std::string idString, const ObjectStore &store) const;
   std::string m_filename; //!< filename of file containing ns-2 mobility trace 
+  Time m_lookAhead; //!< look-ahead of the streaming mode, zero if disabled
 };
 
 } // namespace ns3
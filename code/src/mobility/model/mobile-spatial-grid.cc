@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mobile-spatial-grid.h"
+#include "mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MobileSpatialGrid");
+
+MobileSpatialGrid::MobileSpatialGrid ()
+  : m_valid (false),
+    m_maxSpeed (0.0)
+{
+}
+
+MobileSpatialGrid::~MobileSpatialGrid ()
+{
+  Clear ();
+}
+
+void
+MobileSpatialGrid::Rebuild (const std::vector<Ptr<MobilityModel> > &mobility, double range)
+{
+  NS_LOG_FUNCTION (this << mobility.size () << range);
+  m_grid.Reset (std::max (range, 10.0));
+  m_maxSpeed = 0;
+  m_time = Simulator::Now ();
+  // stop following the models past the end of the new list
+  for (uint32_t i = mobility.size (); i < m_mobility.size (); i++)
+    {
+      Callback<void, uint32_t, Ptr<const MobilityModel> > cb = MakeCallback (&MobileSpatialGrid::CourseChanged, this);
+      m_mobility[i]->TraceDisconnectWithoutContext ("CourseChange", cb.Bind (i));
+    }
+  m_mobility.resize (mobility.size ());
+  for (uint32_t i = 0; i < mobility.size (); i++)
+    {
+      NS_ASSERT (mobility[i] != 0);
+      if (mobility[i] != m_mobility[i])
+        {
+          Callback<void, uint32_t, Ptr<const MobilityModel> > cb = MakeCallback (&MobileSpatialGrid::CourseChanged, this);
+          if (m_mobility[i] != 0)
+            {
+              m_mobility[i]->TraceDisconnectWithoutContext ("CourseChange", cb.Bind (i));
+            }
+          mobility[i]->TraceConnectWithoutContext ("CourseChange", cb.Bind (i));
+          m_mobility[i] = mobility[i];
+        }
+      m_grid.Update (i, mobility[i]->GetPosition ());
+      m_maxSpeed = std::max (m_maxSpeed, mobility[i]->GetVelocity ().GetLength ());
+    }
+  m_valid = true;
+}
+
+void
+MobileSpatialGrid::Clear (void)
+{
+  for (uint32_t i = 0; i < m_mobility.size (); i++)
+    {
+      Callback<void, uint32_t, Ptr<const MobilityModel> > cb = MakeCallback (&MobileSpatialGrid::CourseChanged, this);
+      m_mobility[i]->TraceDisconnectWithoutContext ("CourseChange", cb.Bind (i));
+    }
+  m_mobility.clear ();
+  m_grid.Clear ();
+  m_valid = false;
+}
+
+void
+MobileSpatialGrid::Invalidate (void)
+{
+  m_valid = false;
+}
+
+bool
+MobileSpatialGrid::IsValid (void) const
+{
+  return m_valid;
+}
+
+bool
+MobileSpatialGrid::NeedsRebuild (double range) const
+{
+  return !m_valid || GetDrift () > range / 8 || m_grid.GetCellSize () < range / 2;
+}
+
+double
+MobileSpatialGrid::GetDrift (void) const
+{
+  if (!m_valid)
+    {
+      return 0;
+    }
+  // models may have drifted from the position they are filed under by at
+  // most the distance covered at the highest speed seen since the rebuild
+  return m_maxSpeed * (Simulator::Now () - m_time).GetSeconds ();
+}
+
+void
+MobileSpatialGrid::Query (const Vector &center, double range, std::vector<uint32_t> &result) const
+{
+  NS_ASSERT (m_valid);
+  m_grid.Query (center, range + GetDrift (), result);
+}
+
+void
+MobileSpatialGrid::CourseChanged (uint32_t index, Ptr<const MobilityModel> mobility)
+{
+  if (!m_valid)
+    {
+      return;
+    }
+  m_grid.Update (index, mobility->GetPosition ());
+  m_maxSpeed = std::max (m_maxSpeed, mobility->GetVelocity ().GetLength ());
+}
+
+} // namespace ns3
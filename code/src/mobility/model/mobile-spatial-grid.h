@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MOBILE_SPATIAL_GRID_H
+#define MOBILE_SPATIAL_GRID_H
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "spatial-grid.h"
+#include <vector>
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup mobility
+ * \brief a SpatialGrid of mobility models which never misses one in range
+ *
+ * The models are filed by their index in the vector they were rebuilt
+ * from, refiled from their CourseChange trace, and queries are padded by
+ * the distance covered at the highest speed seen since the last rebuild,
+ * so that a model within range is never missed, even if it moved without
+ * changing course. Callers rebuild the grid when NeedsRebuild () tells
+ * them the padding or the cell size no longer fit their query range.
+ */
+class MobileSpatialGrid
+{
+public:
+  MobileSpatialGrid ();
+  ~MobileSpatialGrid ();
+
+  /**
+   * File every model at its current position, and follow their course
+   * changes.
+   *
+   * \param mobility the mobility models, filed by index
+   * \param range the query range the cells are sized for (m)
+   */
+  void Rebuild (const std::vector<Ptr<MobilityModel> > &mobility, double range);
+  /**
+   * Stop following the course changes of the models, and forget them.
+   */
+  void Clear (void);
+  /**
+   * Make the next NeedsRebuild () return true, e.g., after the caller's
+   * list of models changed.
+   */
+  void Invalidate (void);
+  /**
+   * \return false if the grid was never built, or invalidated since
+   */
+  bool IsValid (void) const;
+  /**
+   * \param range the query range (m)
+   * \return true if the grid must be rebuilt before a query of \p range:
+   *         it is invalid, the models may have drifted by more than an
+   *         eighth of the range, or its cells are too small for the range
+   */
+  bool NeedsRebuild (double range) const;
+  /**
+   * \return the distance (m) by which the models may have drifted from
+   *         the position they are filed under
+   */
+  double GetDrift (void) const;
+  /**
+   * Append to \p result the indices of all models which may lie within
+   * \p range of \p center. The list may hold models a little out of range.
+   *
+   * \param center the query center
+   * \param range the query range (m)
+   * \param result the vector to append matching indices to
+   */
+  void Query (const Vector &center, double range, std::vector<uint32_t> &result) const;
+
+private:
+  /// Not copyable: the course change callbacks are bound to this object
+  MobileSpatialGrid (const MobileSpatialGrid &);
+  /// Not copyable: the course change callbacks are bound to this object
+  MobileSpatialGrid & operator = (const MobileSpatialGrid &);
+
+  /**
+   * Refile a model after it changed course.
+   *
+   * \param index the index of the model
+   * \param mobility the mobility model
+   */
+  void CourseChanged (uint32_t index, Ptr<const MobilityModel> mobility);
+
+  SpatialGrid m_grid;                          //!< Model indices, filed by position
+  bool m_valid;                                //!< Whether m_grid is up to date
+  Time m_time;                                 //!< Time of the last rebuild
+  double m_maxSpeed;                           //!< Upper bound on model speeds since the last rebuild (m/s)
+  std::vector<Ptr<MobilityModel> > m_mobility; //!< Mobility models whose course changes we follow
+};
+
+} // namespace ns3
+
+#endif /* MOBILE_SPATIAL_GRID_H */
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spatial-grid.h"
+#include "ns3/assert.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+SpatialGrid::SpatialGrid (double cellSize)
+  : m_cellSize (cellSize),
+    m_n (0)
+{
+  NS_ASSERT (cellSize > 0);
+}
+
+void
+SpatialGrid::Reset (double cellSize)
+{
+  NS_ASSERT (cellSize > 0);
+  Clear ();
+  m_cellSize = cellSize;
+}
+
+double
+SpatialGrid::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+void
+SpatialGrid::Clear (void)
+{
+  m_entries.clear ();
+  m_cells.clear ();
+  m_n = 0;
+}
+
+uint32_t
+SpatialGrid::GetN (void) const
+{
+  return m_n;
+}
+
+uint64_t
+SpatialGrid::MakeKey (int32_t x, int32_t y)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+}
+
+int32_t
+SpatialGrid::CellIndex (double v) const
+{
+  return static_cast<int32_t> (std::floor (v / m_cellSize));
+}
+
+void
+SpatialGrid::Unlink (uint64_t cell, uint32_t id)
+{
+  std::unordered_map<uint64_t, std::vector<uint32_t> >::iterator it = m_cells.find (cell);
+  NS_ASSERT (it != m_cells.end ());
+  std::vector<uint32_t> &ids = it->second;
+  std::vector<uint32_t>::iterator pos = std::find (ids.begin (), ids.end (), id);
+  NS_ASSERT (pos != ids.end ());
+  *pos = ids.back ();
+  ids.pop_back ();
+  if (ids.empty ())
+    {
+      m_cells.erase (it);
+    }
+}
+
+void
+SpatialGrid::Update (uint32_t id, const Vector &position)
+{
+  if (id >= m_entries.size ())
+    {
+      Entry empty;
+      empty.cell = 0;
+      empty.present = false;
+      m_entries.resize (id + 1, empty);
+    }
+  Entry &entry = m_entries[id];
+  uint64_t cell = MakeKey (CellIndex (position.x), CellIndex (position.y));
+  if (entry.present)
+    {
+      if (entry.cell != cell)
+        {
+          Unlink (entry.cell, id);
+          m_cells[cell].push_back (id);
+        }
+    }
+  else
+    {
+      m_cells[cell].push_back (id);
+      entry.present = true;
+      m_n++;
+    }
+  entry.cell = cell;
+  entry.position = position;
+}
+
+void
+SpatialGrid::Remove (uint32_t id)
+{
+  if (!Contains (id))
+    {
+      return;
+    }
+  Entry &entry = m_entries[id];
+  Unlink (entry.cell, id);
+  entry.present = false;
+  m_n--;
+}
+
+bool
+SpatialGrid::Contains (uint32_t id) const
+{
+  return id < m_entries.size () && m_entries[id].present;
+}
+
+Vector
+SpatialGrid::GetPosition (uint32_t id) const
+{
+  NS_ASSERT (Contains (id));
+  return m_entries[id].position;
+}
+
+void
+SpatialGrid::Query (const Vector &center, double radius, std::vector<uint32_t> &result) const
+{
+  double radiusSq = radius * radius;
+  double xMin = std::floor ((center.x - radius) / m_cellSize);
+  double xMax = std::floor ((center.x + radius) / m_cellSize);
+  double yMin = std::floor ((center.y - radius) / m_cellSize);
+  double yMax = std::floor ((center.y + radius) / m_cellSize);
+  double span = (xMax - xMin + 1) * (yMax - yMin + 1);
+  if (!(span <= m_cells.size ()))
+    {
+      // the query square covers more cells than are occupied: walk the
+      // occupied cells instead of the (possibly unbounded) square.
+      for (std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator c = m_cells.begin ();
+           c != m_cells.end (); ++c)
+        {
+          for (std::vector<uint32_t>::const_iterator i = c->second.begin (); i != c->second.end (); ++i)
+            {
+              const Vector &p = m_entries[*i].position;
+              double dx = p.x - center.x;
+              double dy = p.y - center.y;
+              if (dx * dx + dy * dy <= radiusSq)
+                {
+                  result.push_back (*i);
+                }
+            }
+        }
+      return;
+    }
+  for (int32_t x = static_cast<int32_t> (xMin); x <= static_cast<int32_t> (xMax); x++)
+    {
+      for (int32_t y = static_cast<int32_t> (yMin); y <= static_cast<int32_t> (yMax); y++)
+        {
+          std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator c = m_cells.find (MakeKey (x, y));
+          if (c == m_cells.end ())
+            {
+              continue;
+            }
+          for (std::vector<uint32_t>::const_iterator i = c->second.begin (); i != c->second.end (); ++i)
+            {
+              const Vector &p = m_entries[*i].position;
+              double dx = p.x - center.x;
+              double dy = p.y - center.y;
+              if (dx * dx + dy * dy <= radiusSq)
+                {
+                  result.push_back (*i);
+                }
+            }
+        }
+    }
+}
+
+uint32_t
+SpatialGrid::Count (const Vector &center, double radius) const
+{
+  std::vector<uint32_t> result;
+  Query (center, radius, result);
+  return result.size ();
+}
+
+} // namespace ns3
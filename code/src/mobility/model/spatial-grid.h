@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "ns3/vector.h"
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ * \brief a uniform 2d bucket grid over small integer ids
+ *
+ * Entries are identified by a caller-chosen id (typically an index into
+ * a caller-owned vector, or a node id) and are bucketed by the x and y
+ * coordinates of the position they were last inserted or updated with.
+ * The z coordinate is stored but ignored for bucketing and distance tests,
+ * so a query never misses an entry whose 3d distance is within range.
+ *
+ * The grid does not track mobility on its own: callers refresh entries
+ * with Update () when positions change, and must account for any drift
+ * between the stored and the actual positions themselves.
+ */
+class SpatialGrid
+{
+public:
+  /**
+   * \param cellSize the side length (in meters) of one square cell
+   */
+  SpatialGrid (double cellSize = 100.0);
+
+  /**
+   * Remove all entries and set a new cell size.
+   *
+   * \param cellSize the side length (in meters) of one square cell
+   */
+  void Reset (double cellSize);
+  /**
+   * \return the side length (in meters) of one square cell
+   */
+  double GetCellSize (void) const;
+  /**
+   * Remove all entries, keeping the current cell size.
+   */
+  void Clear (void);
+  /**
+   * \return the number of entries currently stored
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * Insert a new entry or move an existing one.
+   *
+   * \param id the entry identifier
+   * \param position the position to file the entry under
+   */
+  void Update (uint32_t id, const Vector &position);
+  /**
+   * Remove an entry. Removing an absent id is a no-op.
+   *
+   * \param id the entry identifier
+   */
+  void Remove (uint32_t id);
+  /**
+   * \param id the entry identifier
+   * \return true if the entry is currently stored
+   */
+  bool Contains (uint32_t id) const;
+  /**
+   * \param id the entry identifier, which must be stored
+   * \return the position the entry was last filed under
+   */
+  Vector GetPosition (uint32_t id) const;
+
+  /**
+   * Append to \p result the ids of all entries whose stored x/y position
+   * lies within \p radius of the x/y coordinates of \p center. Ids are
+   * appended in no particular order.
+   *
+   * \param center the query center
+   * \param radius the query radius (in meters)
+   * \param result the vector to append matching ids to
+   */
+  void Query (const Vector &center, double radius, std::vector<uint32_t> &result) const;
+  /**
+   * \param center the query center
+   * \param radius the query radius (in meters)
+   * \return the number of entries Query () would return
+   */
+  uint32_t Count (const Vector &center, double radius) const;
+
+private:
+  /// Per-id bookkeeping
+  struct Entry
+  {
+    Vector position;  //!< the position the entry is filed under
+    uint64_t cell;    //!< key of the cell holding the entry
+    bool present;     //!< whether the id is stored
+  };
+
+  /**
+   * \param x cell column
+   * \param y cell row
+   * \return the key of the cell
+   */
+  static uint64_t MakeKey (int32_t x, int32_t y);
+  /**
+   * \param v a coordinate
+   * \return the cell column or row holding \p v
+   */
+  int32_t CellIndex (double v) const;
+  /**
+   * \param cell the cell to unlink from
+   * \param id the id to unlink
+   */
+  void Unlink (uint64_t cell, uint32_t id);
+
+  double m_cellSize;                                              //!< cell side length
+  uint32_t m_n;                                                   //!< number of stored entries
+  std::vector<Entry> m_entries;                                   //!< entries indexed by id
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells;   //!< ids per cell
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_GRID_H */
@@ -126,7 +126,8 @@ public:
     : TestCase (name),
       m_timeLimit (timeLimit),
       m_nodeCount (nodes),
-      m_nextRefPoint (0)
+      m_nextRefPoint (0),
+      m_lookAhead (Seconds (0))
   {
   }
   /// Empty
@@ -148,6 +149,20 @@ public:
   {
     AddReferencePoint (ReferencePoint (id, Seconds (sec), p, v));
   }
+  /**
+   * Create a copy of this test which reads the trace in streaming mode
+   *
+   * \param lookAhead streaming look-ahead
+   * \return the new test case
+   */
+  Ns2MobilityHelperTest * Streaming (Time lookAhead) const
+  {
+    Ns2MobilityHelperTest * t = new Ns2MobilityHelperTest (GetName () + ", streaming", m_timeLimit, m_nodeCount);
+    t->m_trace = m_trace;
+    t->m_reference = m_reference;
+    t->m_lookAhead = lookAhead;
+    return t;
+  }
 
 private:
   /// Test time limit
@@ -162,6 +177,8 @@ private:
   size_t m_nextRefPoint;
   /// TMP trace file name
   std::string m_traceFile;
+  /// Streaming look-ahead, zero to read the whole trace at once
+  Time m_lookAhead;
 
 private:
   /// Dump NS-2 trace to tmp file
@@ -254,6 +271,7 @@ private:
         return;
       }
     Ns2MobilityHelper mobility (m_traceFile);
+    mobility.SetStreamingLookAhead (m_lookAhead);
     mobility.Install ();
     if (CheckInitialPositions ())
       {
@@ -357,6 +375,7 @@ public:
     t->AddReferencePoint ("0", 4, Vector (10, 15, 0), Vector (0, -5, 0));
     t->AddReferencePoint ("0", 5, Vector (10, 10, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
+    AddTestCase (t->Streaming (Seconds (1)), TestCase::QUICK);
 
     // Scheduled set position
     t = new Ns2MobilityHelperTest ("scheduled set position", Seconds (2));
@@ -368,6 +387,7 @@ public:
     t->AddReferencePoint ("0", 1, Vector (10, 0, 10), Vector (0, 0, 0));
     t->AddReferencePoint ("0", 1, Vector (10, 10, 10), Vector (0, 0, 0));
     AddTestCase (t, TestCase::QUICK);
+    AddTestCase (t->Streaming (Seconds (0.5)), TestCase::QUICK);
 
     // Malformed lines
     t = new Ns2MobilityHelperTest ("malformed lines", Seconds (2));
@@ -432,6 +452,7 @@ public:
     t->AddReferencePoint ("2", 4, Vector (0, 5, 0), Vector (0, -5, 0));
     t->AddReferencePoint ("2", 5, Vector (0, 0, 0), Vector (0,  0, 0));
     AddTestCase (t, TestCase::QUICK);
+    AddTestCase (t->Streaming (Seconds (0.5)), TestCase::QUICK);
 
     // Test for Speed == 0, that acts as stop the node.
     t = new Ns2MobilityHelperTest ("setdest with speed cero", Seconds (10));
@@ -490,6 +511,7 @@ public:
     t->AddReferencePoint ("0", 6, Vector (0, 5, 0), Vector (0,  -1, 0));
     t->AddReferencePoint ("0", 16, Vector (0, -10, 0), Vector (0, 0, 0));
     AddTestCase (t, TestCase::QUICK);
+    AddTestCase (t->Streaming (Seconds (1)), TestCase::QUICK);
     t = new Ns2MobilityHelperTest ("Bug 1059 testcase", Seconds (16));
     t->SetTrace ("$node_(0) set X_ 10.0\r\n"
                  "$node_(0) set Y_ 0.0\r\n"
@@ -531,6 +553,7 @@ public:
     t->AddReferencePoint ("0", 900.000, Vector (250.000,  650.000, 0.000), Vector (2.500, 0.000, 0.000));
     t->AddReferencePoint ("0", 920.000, Vector (300.000,  650.000, 0.000), Vector (0.000, 0.000, 0.000));
     AddTestCase (t, TestCase::QUICK);
+    AddTestCase (t->Streaming (Seconds (10)), TestCase::QUICK);
 
   }
 } g_ns2TransmobilityHelperTestSuite; ///< the test suite
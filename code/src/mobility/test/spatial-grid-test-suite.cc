@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/spatial-grid.h"
+#include "ns3/mobile-spatial-grid.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include <algorithm>
+#include <limits>
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Compare SpatialGrid queries against a brute force scan
+ */
+class SpatialGridQueryTestCase : public TestCase
+{
+public:
+  SpatialGridQueryTestCase ();
+  virtual ~SpatialGridQueryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check one query against a brute force scan of m_positions
+   * \param grid the grid to query
+   * \param center the query center
+   * \param radius the query radius
+   */
+  void CheckQuery (const SpatialGrid &grid, const Vector &center, double radius);
+
+  std::vector<Vector> m_positions; ///< reference positions, by id
+  std::vector<bool> m_present;     ///< reference membership, by id
+};
+
+SpatialGridQueryTestCase::SpatialGridQueryTestCase ()
+  : TestCase ("Check SpatialGrid queries against a brute force scan")
+{
+}
+
+SpatialGridQueryTestCase::~SpatialGridQueryTestCase ()
+{
+}
+
+void
+SpatialGridQueryTestCase::CheckQuery (const SpatialGrid &grid, const Vector &center, double radius)
+{
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < m_positions.size (); i++)
+    {
+      double dx = m_positions[i].x - center.x;
+      double dy = m_positions[i].y - center.y;
+      if (m_present[i] && dx * dx + dy * dy <= radius * radius)
+        {
+          expected.push_back (i);
+        }
+    }
+  std::vector<uint32_t> found;
+  grid.Query (center, radius, found);
+  std::sort (found.begin (), found.end ());
+  NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "wrong number of entries within " << radius << "m");
+  for (uint32_t i = 0; i < found.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (found[i], expected[i], "wrong entry within " << radius << "m");
+    }
+  NS_TEST_ASSERT_MSG_EQ (grid.Count (center, radius), expected.size (), "Count disagrees with Query");
+}
+
+void
+SpatialGridQueryTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+  x->SetAttribute ("Min", DoubleValue (-2000.0));
+  x->SetAttribute ("Max", DoubleValue (2000.0));
+
+  SpatialGrid grid (150.0);
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      m_positions.push_back (Vector (x->GetValue (), x->GetValue (), 1.5));
+      m_present.push_back (true);
+      grid.Update (i, m_positions[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (grid.GetN (), 500, "wrong number of entries");
+
+  double radii[] = { 0.0, 30.0, 149.9, 150.0, 420.0, 3000.0, std::numeric_limits<double>::infinity () };
+  for (uint32_t r = 0; r < sizeof (radii) / sizeof (radii[0]); r++)
+    {
+      CheckQuery (grid, Vector (x->GetValue (), x->GetValue (), 0.0), radii[r]);
+      CheckQuery (grid, m_positions[r], radii[r]);
+    }
+
+  // move and remove entries, including moves within the same cell
+  for (uint32_t i = 0; i < 500; i += 3)
+    {
+      m_positions[i] = Vector (m_positions[i].x + x->GetValue () / 20, m_positions[i].y, 1.5);
+      grid.Update (i, m_positions[i]);
+    }
+  for (uint32_t i = 1; i < 500; i += 7)
+    {
+      m_present[i] = false;
+      grid.Remove (i);
+      grid.Remove (i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (grid.GetN (), 500 - 72, "wrong number of entries after removal");
+  NS_TEST_ASSERT_MSG_EQ (grid.Contains (1), false, "removed entry still present");
+  NS_TEST_ASSERT_MSG_EQ (grid.GetPosition (3).x, m_positions[3].x, "moved entry filed at a stale position");
+  for (uint32_t r = 0; r < sizeof (radii) / sizeof (radii[0]); r++)
+    {
+      CheckQuery (grid, Vector (x->GetValue (), x->GetValue (), 0.0), radii[r]);
+    }
+
+  grid.Reset (40.0);
+  NS_TEST_ASSERT_MSG_EQ (grid.GetN (), 0, "Reset left entries behind");
+  NS_TEST_ASSERT_MSG_EQ (grid.Count (Vector (0.0, 0.0, 0.0), 1e9), 0, "Reset left cells behind");
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check that MobileSpatialGrid never misses a moving model in range
+ */
+class MobileSpatialGridTestCase : public TestCase
+{
+public:
+  MobileSpatialGridTestCase ();
+  virtual ~MobileSpatialGridTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that every model within range of the first one is a candidate
+   * \param range the query range
+   */
+  void CheckQuery (double range);
+
+  MobileSpatialGrid m_grid;                      ///< the grid under test
+  std::vector<Ptr<MobilityModel> > m_mobility;   ///< the filed models
+  uint32_t m_rebuilds;                           ///< number of rebuilds
+};
+
+MobileSpatialGridTestCase::MobileSpatialGridTestCase ()
+  : TestCase ("Check that MobileSpatialGrid never misses a moving model in range"),
+    m_rebuilds (0)
+{
+}
+
+MobileSpatialGridTestCase::~MobileSpatialGridTestCase ()
+{
+}
+
+void
+MobileSpatialGridTestCase::CheckQuery (double range)
+{
+  if (m_grid.NeedsRebuild (range))
+    {
+      m_grid.Rebuild (m_mobility, range);
+      m_rebuilds++;
+    }
+  std::vector<uint32_t> found;
+  Vector center = m_mobility[0]->GetPosition ();
+  m_grid.Query (center, range, found);
+  std::sort (found.begin (), found.end ());
+  for (uint32_t i = 0; i < m_mobility.size (); i++)
+    {
+      if (m_mobility[i]->GetDistanceFrom (m_mobility[0]) <= range)
+        {
+          NS_TEST_ASSERT_MSG_EQ (std::binary_search (found.begin (), found.end (), i), true,
+                                 "model " << i << " within " << range << "m missed at " << Simulator::Now ().GetSeconds () << "s");
+        }
+    }
+}
+
+void
+MobileSpatialGridTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> x = CreateObject<UniformRandomVariable> ();
+  x->SetAttribute ("Min", DoubleValue (-1000.0));
+  x->SetAttribute ("Max", DoubleValue (1000.0));
+  Ptr<UniformRandomVariable> v = CreateObject<UniformRandomVariable> ();
+  v->SetAttribute ("Min", DoubleValue (-30.0));
+  v->SetAttribute ("Max", DoubleValue (30.0));
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = CreateObject<ConstantVelocityMobilityModel> ();
+      mobility->SetPosition (Vector (x->GetValue (), x->GetValue (), 1.5));
+      mobility->SetVelocity (Vector (v->GetValue (), v->GetValue (), 0.0));
+      m_mobility.push_back (mobility);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (m_grid.IsValid (), false, "grid valid before the first rebuild");
+  // models keep moving without changing course, and some jump
+  for (uint32_t t = 0; t < 40; t++)
+    {
+      Simulator::Schedule (Seconds (0.25 * t), &MobileSpatialGridTestCase::CheckQuery, this, 300.0);
+      Simulator::Schedule (Seconds (0.25 * t + 0.1), &MobilityModel::SetPosition, m_mobility[1 + t],
+                           m_mobility[0]->GetPosition () + Vector (0.0, 30.0 * (t + 1), 0.0));
+    }
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_GT (m_rebuilds, 1, "models drifted without a rebuild");
+  NS_TEST_ASSERT_MSG_LT (m_rebuilds, 40, "grid rebuilt before every query");
+
+  m_grid.Invalidate ();
+  NS_TEST_ASSERT_MSG_EQ (m_grid.NeedsRebuild (300.0), true, "invalidated grid not rebuilt");
+  m_grid.Rebuild (m_mobility, 300.0);
+  NS_TEST_ASSERT_MSG_EQ (m_grid.NeedsRebuild (300.0), false, "fresh grid rebuilt");
+  NS_TEST_ASSERT_MSG_EQ (m_grid.NeedsRebuild (1000.0), true, "grid queried beyond its cell size");
+  m_grid.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (m_grid.IsValid (), false, "grid valid after Clear");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief SpatialGrid Test Suite
+ */
+static class SpatialGridTestSuite : public TestSuite
+{
+public:
+  SpatialGridTestSuite () : TestSuite ("spatial-grid", UNIT)
+  {
+    AddTestCase (new SpatialGridQueryTestCase (), TestCase::QUICK);
+    AddTestCase (new MobileSpatialGridTestCase (), TestCase::QUICK);
+  }
+} g_spatialGridTestSuite; ///< the test suite
@@ -0,0 +1,199 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "buildings-cache.h"
+#include "ns3/log.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BuildingsCache");
+
+// header of the binary cache of a buildings file; the cache then holds,
+// for each building, the length of its id and its number of vertices
+// (uint32_t each), its id and the x, y values of its vertices (doubles)
+struct BuildingsCacheHeader
+{
+  char magic[8];          // BUILDINGS_CACHE_MAGIC
+  uint32_t version;       // BUILDINGS_CACHE_VERSION
+  uint32_t obstacles;     // number of buildings
+  uint64_t sourceSize;    // size of the buildings file
+  uint64_t sourceInode;   // inode of the buildings file
+  int64_t sourceMtime;    // modification time of the buildings file (s)
+  int64_t sourceMtimeNs;  // and its nanoseconds
+  int64_t sourceCtime;    // status change time of the buildings file (s)
+  int64_t sourceCtimeNs;  // and its nanoseconds
+};
+
+static const char BUILDINGS_CACHE_MAGIC[8] = { 'N', 'S', '3', 'B', 'L', 'D', 'G', 'S' };
+static const uint32_t BUILDINGS_CACHE_VERSION = 2;
+
+// record the buildings file a cache is made from
+static void
+SetBuildingsCacheSource (BuildingsCacheHeader &header, const struct stat &source)
+{
+  header.sourceSize = source.st_size;
+  header.sourceInode = source.st_ino;
+  header.sourceMtime = source.st_mtim.tv_sec;
+  header.sourceMtimeNs = source.st_mtim.tv_nsec;
+  header.sourceCtime = source.st_ctim.tv_sec;
+  header.sourceCtimeNs = source.st_ctim.tv_nsec;
+}
+
+bool
+BuildingsCache::Read (std::string cacheFilename, const struct stat &source,
+                      std::vector<Building> &buildings)
+{
+  NS_LOG_FUNCTION (cacheFilename);
+
+  buildings.clear ();
+  int fd = open (cacheFilename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return false;
+    }
+  struct stat cacheStat;
+  if ((fstat (fd, &cacheStat) != 0) || (cacheStat.st_size < (off_t) sizeof (BuildingsCacheHeader)))
+    {
+      close (fd);
+      return false;
+    }
+  size_t size = cacheStat.st_size;
+  void *map = mmap (0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      return false;
+    }
+  const char *data = (const char *) map;
+
+  BuildingsCacheHeader header;
+  memcpy (&header, data, sizeof (header));
+  BuildingsCacheHeader expected;
+  SetBuildingsCacheSource (expected, source);
+  bool valid = (memcmp (header.magic, BUILDINGS_CACHE_MAGIC, sizeof (header.magic)) == 0)
+    && (header.version == BUILDINGS_CACHE_VERSION)
+    && (header.sourceSize == expected.sourceSize)
+    && (header.sourceInode == expected.sourceInode)
+    && (header.sourceMtime == expected.sourceMtime)
+    && (header.sourceMtimeNs == expected.sourceMtimeNs)
+    && (header.sourceCtime == expected.sourceCtime)
+    && (header.sourceCtimeNs == expected.sourceCtimeNs);
+
+  // check the whole cache before reading any building from it
+  size_t offset = sizeof (header);
+  for (uint32_t i = 0; valid && (i < header.obstacles); i++)
+    {
+      uint32_t counts[2];
+      if (size - offset < sizeof (counts))
+        {
+          valid = false;
+          break;
+        }
+      memcpy (counts, data + offset, sizeof (counts));
+      offset += sizeof (counts);
+      uint64_t length = (uint64_t) counts[0] + 2 * sizeof (double) * (uint64_t) counts[1];
+      if (size - offset < length)
+        {
+          valid = false;
+          break;
+        }
+      offset += length;
+    }
+  if (!valid || (offset != size))
+    {
+      NS_LOG_WARN ("Ignoring stale or invalid buildings cache " << cacheFilename);
+      munmap (map, size);
+      return false;
+    }
+
+  buildings.resize (header.obstacles);
+  offset = sizeof (header);
+  for (uint32_t i = 0; i < header.obstacles; i++)
+    {
+      uint32_t counts[2];
+      memcpy (counts, data + offset, sizeof (counts));
+      offset += sizeof (counts);
+
+      Building &building = buildings[i];
+      building.id = std::string (data + offset, counts[0]);
+      offset += counts[0];
+      building.x.resize (counts[1]);
+      building.y.resize (counts[1]);
+      for (uint32_t v = 0; v < counts[1]; v++)
+        {
+          double xy[2];
+          memcpy (xy, data + offset, sizeof (xy));
+          offset += sizeof (xy);
+          building.x[v] = xy[0];
+          building.y[v] = xy[1];
+        }
+    }
+
+  munmap (map, size);
+  return true;
+}
+
+bool
+BuildingsCache::Write (std::string cacheFilename, const struct stat &source,
+                       const std::vector<Building> &buildings)
+{
+  NS_LOG_FUNCTION (cacheFilename << buildings.size ());
+
+  BuildingsCacheHeader header;
+  memcpy (header.magic, BUILDINGS_CACHE_MAGIC, sizeof (header.magic));
+  header.version = BUILDINGS_CACHE_VERSION;
+  header.obstacles = buildings.size ();
+  SetBuildingsCacheSource (header, source);
+
+  std::ostringstream tmpFilename;
+  tmpFilename << cacheFilename << "." << getpid ();
+  std::ofstream file (tmpFilename.str ().c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file.is_open ())
+    {
+      NS_LOG_WARN ("Could not write buildings cache " << cacheFilename);
+      return false;
+    }
+  file.write ((const char *) &header, sizeof (header));
+  for (uint32_t i = 0; i < buildings.size (); i++)
+    {
+      const Building &building = buildings[i];
+      uint32_t counts[2] = { (uint32_t) building.id.size (), (uint32_t) building.x.size () };
+      file.write ((const char *) counts, sizeof (counts));
+      file.write (building.id.data (), building.id.size ());
+      for (uint32_t v = 0; v < counts[1]; v++)
+        {
+          double xy[2] = { building.x[v], building.y[v] };
+          file.write ((const char *) xy, sizeof (xy));
+        }
+    }
+  file.close ();
+  if (file.fail () || (rename (tmpFilename.str ().c_str (), cacheFilename.c_str ()) != 0))
+    {
+      NS_LOG_WARN ("Could not write buildings cache " << cacheFilename);
+      remove (tmpFilename.str ().c_str ());
+      return false;
+    }
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,76 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BUILDINGS_CACHE_H
+#define BUILDINGS_CACHE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup obstacle
+ * \brief the binary cache of a buildings file
+ *
+ * The cache holds the buildings parsed from a buildings file, and the
+ * size, inode, modification and status change times of that file. It is
+ * only read back while the file keeps all of them: a file rewritten
+ * within the same second, or replaced by another one, changes its status
+ * change time or its inode even if it keeps its size and modification
+ * time. The cache is in the byte order of the host.
+ */
+class BuildingsCache
+{
+public:
+  /// a building, as its id and its vertices, without the closing one
+  struct Building
+  {
+    std::string id;        //!< the id of the building
+    std::vector<double> x; //!< the x values of its vertices
+    std::vector<double> y; //!< the y values of its vertices
+  };
+
+  /**
+   * Read the buildings of a cache.
+   *
+   * \param cacheFilename the filename of the cache
+   * \param source the status of the buildings file
+   * \param buildings set to the buildings of the cache
+   * \return false, and \p buildings left empty, if the cache is missing,
+   *         invalid or made from another version of the buildings file
+   */
+  static bool Read (std::string cacheFilename, const struct stat &source,
+                    std::vector<Building> &buildings);
+  /**
+   * Write buildings to a cache. The cache is written to a file of its own
+   * and renamed, so that simulations started together never read a partly
+   * written cache.
+   *
+   * \param cacheFilename the filename of the cache
+   * \param source the status of the buildings file
+   * \param buildings the buildings parsed from the buildings file
+   * \return false if the cache could not be written
+   */
+  static bool Write (std::string cacheFilename, const struct stat &source,
+                     const std::vector<Building> &buildings);
+};
+
+} // namespace ns3
+
+#endif /* BUILDINGS_CACHE_H */
@@ -117,4 +117,11 @@ ObstacleShadowingPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+ObstacleShadowingPropagationLossModel::DoGetRxPowerUpperBound (double txPowerDbm, double distance) const
+{
+  // obstacles only ever add loss on top of the attached model and the fixed 15 dB
+  return m_attached_lossmodel.GetRxPowerUpperBound (txPowerDbm - 15, distance);
+}
+
 } // namespace ns3
@@ -78,6 +78,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetRxPowerUpperBound (double txPowerDbm, double distance) const;
 };
 
 } // namespace ns3
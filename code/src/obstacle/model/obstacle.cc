@@ -77,6 +77,7 @@ Obstacle::Locate()
 
   // get the bounding box of the obstacle
   Bbox_2 bbox = m_obstacle.bbox();
+  m_bbox = bbox;
 
   double bx = (double)bbox.xmin();
   double by = (double)bbox.ymin();
@@ -87,6 +88,21 @@ Obstacle::Locate()
   m_center = Point(cx, cy);
 
   m_radiusSq = (cx - bx) * (cx - bx) + (cy - by) * (cy - by);
+
+  // keep the vertices as doubles, in flat arrays, for the fast
+  // intersection tests
+  m_vertexX.clear();
+  m_vertexY.clear();
+  for (Polygon_2::Vertex_const_iterator v = m_obstacle.vertices_begin(); v != m_obstacle.vertices_end(); ++v)
+    {
+      m_vertexX.push_back(CGAL::to_double(v->x()));
+      m_vertexY.push_back(CGAL::to_double(v->y()));
+    }
+  if (!m_vertexX.empty())
+    {
+      m_vertexX.push_back(m_vertexX.front());
+      m_vertexY.push_back(m_vertexY.front());
+    }
 }
 
 const Point &
@@ -105,6 +121,30 @@ Obstacle::GetRadiusSq()
   return m_radiusSq;
 }
 
+const Bbox_2 &
+Obstacle::GetBbox()
+{
+  NS_LOG_FUNCTION (this);
+
+  return m_bbox;
+}
+
+const std::vector<double> &
+Obstacle::GetVertexX()
+{
+  NS_LOG_FUNCTION (this);
+
+  return m_vertexX;
+}
+
+const std::vector<double> &
+Obstacle::GetVertexY()
+{
+  NS_LOG_FUNCTION (this);
+
+  return m_vertexY;
+}
+
 double
 Obstacle::GetBeta()
 {
@@ -25,6 +25,7 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <vector>
 #include "ns3/core-module.h"
 
 // CGAL includes
@@ -109,6 +110,28 @@ public:
    */
   double GetRadiusSq();
 
+  /**
+   * \brief Gets the bounding box of the obstacle, set by Locate
+   * \return the bounding box of the obstacle
+   */
+  const Bbox_2 &GetBbox();
+
+  /**
+   * \brief Gets the x values of the vertices, as set by Locate, with the
+   * first vertex repeated at the end so that edge i runs from vertex i
+   * to vertex i + 1 (used for the fast, double precision, intersection
+   * tests)
+   * \return the x values of the vertices
+   */
+  const std::vector<double> &GetVertexX();
+
+  /**
+   * \brief Gets the y values of the vertices, as set by Locate, in the
+   * same order as GetVertexX
+   * \return the y values of the vertices
+   */
+  const std::vector<double> &GetVertexY();
+
   /**
    * \brief Gets the polygonal region that defines the obstacle
    * \return The polygonal region defining the obstacle
@@ -162,6 +185,13 @@ private:
   // radius squared from centerpoint to bounding box vertex
   double m_radiusSq;
 
+  // bounding box of the obstacle
+  Bbox_2 m_bbox;
+
+  // x and y values of the vertices, closed by the first one
+  std::vector<double> m_vertexX;
+  std::vector<double> m_vertexY;
+
   // For IEEE 802.11p propagation loss through obstacles
   // See C. Sommer et. al.:
   // A Computationally Inexpensive Empirical Model of IEEE 802.11p
@@ -0,0 +1,159 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "obstructed-loss-cache.h"
+#include <cmath>
+
+namespace ns3 {
+
+std::size_t
+ObstructedLossCache::KeyHash::operator () (const Key &k) const
+{
+  uint64_t h = 0;
+  const int64_t v[4] = { k.ax, k.ay, k.bx, k.by };
+  for (int i = 0; i < 4; i++)
+    {
+      // splitmix64 finalizer over the running hash
+      h ^= static_cast<uint64_t> (v[i]) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+      h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+      h ^= h >> 31;
+    }
+  return static_cast<std::size_t> (h);
+}
+
+ObstructedLossCache::ObstructedLossCache (uint32_t capacity)
+  : m_capacity (capacity),
+    m_hits (0),
+    m_misses (0),
+    m_evictions (0)
+{
+}
+
+void
+ObstructedLossCache::SetCapacity (uint32_t capacity)
+{
+  m_capacity = capacity;
+  while (m_entries.size () > m_capacity)
+    {
+      m_index.erase (m_entries.back ().first);
+      m_entries.pop_back ();
+      m_evictions++;
+    }
+}
+
+uint32_t
+ObstructedLossCache::GetCapacity (void) const
+{
+  return m_capacity;
+}
+
+uint32_t
+ObstructedLossCache::GetSize (void) const
+{
+  return m_index.size ();
+}
+
+ObstructedLossCache::Key
+ObstructedLossCache::MakeKey (double x1, double y1, double x2, double y2)
+{
+  int64_t qx1 = std::llround (x1 * 10.0);
+  int64_t qy1 = std::llround (y1 * 10.0);
+  int64_t qx2 = std::llround (x2 * 10.0);
+  int64_t qy2 = std::llround (y2 * 10.0);
+  Key k;
+  if (qx1 < qx2 || (qx1 == qx2 && qy1 <= qy2))
+    {
+      k.ax = qx1; k.ay = qy1; k.bx = qx2; k.by = qy2;
+    }
+  else
+    {
+      k.ax = qx2; k.ay = qy2; k.bx = qx1; k.by = qy1;
+    }
+  return k;
+}
+
+bool
+ObstructedLossCache::Lookup (double x1, double y1, double x2, double y2, double &loss)
+{
+  std::unordered_map<Key, EntryList::iterator, KeyHash>::const_iterator it = m_index.find (MakeKey (x1, y1, x2, y2));
+  if (it == m_index.end ())
+    {
+      m_misses++;
+      return false;
+    }
+  m_hits++;
+  m_entries.splice (m_entries.begin (), m_entries, it->second);
+  loss = it->second->second;
+  return true;
+}
+
+void
+ObstructedLossCache::Insert (double x1, double y1, double x2, double y2, double loss)
+{
+  if (m_capacity == 0)
+    {
+      return;
+    }
+  Key k = MakeKey (x1, y1, x2, y2);
+  std::unordered_map<Key, EntryList::iterator, KeyHash>::iterator it = m_index.find (k);
+  if (it != m_index.end ())
+    {
+      m_entries.splice (m_entries.begin (), m_entries, it->second);
+      it->second->second = loss;
+      return;
+    }
+  if (m_entries.size () >= m_capacity)
+    {
+      // recycle the least recently used entry
+      m_index.erase (m_entries.back ().first);
+      m_entries.splice (m_entries.begin (), m_entries, --m_entries.end ());
+      m_entries.front () = std::make_pair (k, loss);
+      m_evictions++;
+    }
+  else
+    {
+      m_entries.push_front (std::make_pair (k, loss));
+    }
+  m_index[k] = m_entries.begin ();
+}
+
+void
+ObstructedLossCache::Clear (void)
+{
+  m_entries.clear ();
+  m_index.clear ();
+}
+
+uint64_t
+ObstructedLossCache::GetHits (void) const
+{
+  return m_hits;
+}
+
+uint64_t
+ObstructedLossCache::GetMisses (void) const
+{
+  return m_misses;
+}
+
+uint64_t
+ObstructedLossCache::GetEvictions (void) const
+{
+  return m_evictions;
+}
+
+} // namespace ns3
@@ -0,0 +1,144 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OBSTRUCTED_LOSS_CACHE_H
+#define OBSTRUCTED_LOSS_CACHE_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup obstacle
+ * \brief a bounded, least recently used cache of obstructed losses
+ *
+ * Links are keyed by the positions of their two end points rounded to
+ * the nearest 0.1m, in either order, so a link looked up from either end
+ * hits the same entry. When the cache is full, the least recently used
+ * entry is recycled for the new one.
+ */
+class ObstructedLossCache
+{
+public:
+  /**
+   * \param capacity the maximum number of entries
+   */
+  ObstructedLossCache (uint32_t capacity = 65536);
+
+  /**
+   * Set the maximum number of entries, evicting the least recently used
+   * ones if needed. A capacity of 0 disables the cache.
+   *
+   * \param capacity the maximum number of entries
+   */
+  void SetCapacity (uint32_t capacity);
+  /**
+   * \return the maximum number of entries
+   */
+  uint32_t GetCapacity (void) const;
+  /**
+   * \return the number of entries held
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * Look up the loss of the link between (x1, y1) and (x2, y2), and
+   * count a hit or a miss.
+   *
+   * \param x1 x of the first end point
+   * \param y1 y of the first end point
+   * \param x2 x of the second end point
+   * \param y2 y of the second end point
+   * \param loss set to the cached loss on a hit
+   * \return true on a hit
+   */
+  bool Lookup (double x1, double y1, double x2, double y2, double &loss);
+  /**
+   * Store the loss of the link between (x1, y1) and (x2, y2).
+   *
+   * \param x1 x of the first end point
+   * \param y1 y of the first end point
+   * \param x2 x of the second end point
+   * \param y2 y of the second end point
+   * \param loss the loss
+   */
+  void Insert (double x1, double y1, double x2, double y2, double loss);
+  /**
+   * Drop all the entries; the counters are kept.
+   */
+  void Clear (void);
+
+  /**
+   * \return the number of lookups which found an entry
+   */
+  uint64_t GetHits (void) const;
+  /**
+   * \return the number of lookups which found no entry
+   */
+  uint64_t GetMisses (void) const;
+  /**
+   * \return the number of entries evicted to make room for others
+   */
+  uint64_t GetEvictions (void) const;
+
+private:
+  /// a link, as its two rounded end points in canonical order
+  struct Key
+  {
+    int64_t ax; //!< x of the lower end point, in 0.1m
+    int64_t ay; //!< y of the lower end point, in 0.1m
+    int64_t bx; //!< x of the upper end point, in 0.1m
+    int64_t by; //!< y of the upper end point, in 0.1m
+    /**
+     * \param o the other key
+     * \return true if both keys denote the same link
+     */
+    bool operator == (const Key &o) const
+    {
+      return ax == o.ax && ay == o.ay && bx == o.bx && by == o.by;
+    }
+  };
+  /// hash of a Key
+  struct KeyHash
+  {
+    /**
+     * \param k the key
+     * \return the hash of k
+     */
+    std::size_t operator () (const Key &k) const;
+  };
+  /// an entry, most recently used first
+  typedef std::list<std::pair<Key, double> > EntryList;
+
+  /**
+   * \return the key of the link between (x1, y1) and (x2, y2)
+   */
+  static Key MakeKey (double x1, double y1, double x2, double y2);
+
+  uint32_t m_capacity;                 //!< maximum number of entries
+  EntryList m_entries;                 //!< entries, most recently used first
+  std::unordered_map<Key, EntryList::iterator, KeyHash> m_index; //!< entries by key
+  uint64_t m_hits;                     //!< lookups which found an entry
+  uint64_t m_misses;                   //!< lookups which found no entry
+  uint64_t m_evictions;                //!< entries evicted to make room
+};
+
+} // namespace ns3
+
+#endif /* OBSTRUCTED_LOSS_CACHE_H */
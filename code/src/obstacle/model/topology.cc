@@ -20,11 +20,19 @@
  */
 
 #include "topology.h"
+#include <sys/stat.h>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("topology");
 
+static GlobalValue g_obstructedLossCacheSize = GlobalValue
+  ("ObstructedLossCacheSize",
+   "The number of links whose obstructed loss the topology caches "
+   "(0 disables the cache), read when the topology is created",
+   UintegerValue (65536),
+   MakeUintegerChecker<uint32_t> ());
+
 Topology::Topology () : 
   // initially very large values
   // so that obstacle bounding box
@@ -32,9 +40,19 @@ Topology::Topology () :
   m_minX(999999999.0),
   m_minY(999999999.0),
   m_maxX(-999999999.0),
-  m_maxY(-999999999.0)
+  m_maxY(-999999999.0),
+  m_maxObstacleWidth(0.0),
+  m_maxObstacleHeight(0.0),
+  m_fastIntersection(true),
+  m_fastIntersectionTests(0),
+  m_exactIntersectionFallbacks(0),
+  m_buildingsCacheReads(0)
 {
   NS_LOG_FUNCTION (this);
+
+  UintegerValue cacheSize;
+  g_obstructedLossCacheSize.GetValue (cacheSize);
+  m_obstructedLossCache.SetCapacity (cacheSize.Get ());
 }
 
 void Topology::CommandSetup (int argc, char **argv)
@@ -93,6 +111,15 @@ CreateVertex(Obstacle &obstacle, std::string vertex)
   double dx = atof(x.c_str ());
   double dy = atof(y.c_str ());
 
+  CreateVertex(obstacle, dx, dy);
+}
+
+void 
+Topology::
+CreateVertex(Obstacle &obstacle, double dx, double dy) 
+{
+  NS_LOG_FUNCTION (this << dx << dy);
+
   // create a 2D x,y point
   Point p(dx, dy);
   // add the point as a vertex to an obstacle
@@ -141,16 +168,29 @@ CreateShape(std::string id, std::string vertices)
   // so, we don't need to get it for polygonal obstacle
   // get last vertex
 
+  AddShape(obstacle);
+}
+
+void 
+Topology::
+AddShape(Obstacle &obstacle) 
+{
   // calculate the obstacle center of 
   // bounding box and radius(squared).
   obstacle.Locate();
 
-  // load centerpoint into Range Tree
+  // the largest obstacle bounds the search window around a link
+  const Bbox_2 &bbox = obstacle.GetBbox();
+  m_maxObstacleWidth = std::max(m_maxObstacleWidth, bbox.xmax() - bbox.xmin());
+  m_maxObstacleHeight = std::max(m_maxObstacleHeight, bbox.ymax() - bbox.ymin());
+
+  // load centerpoint into Range Tree, with the index of the obstacle
   Point c = obstacle.GetCenter();
-  Key k = Key(c, obstacle);
+  Key k = Key(c, m_obstacles.size());
 
   // add the obstacle to the topolgoy
-  m_obstacles.push_back(k);
+  m_obstacles.push_back(obstacle);
+  m_keys.push_back(k);
 }
 
 // range tree (binary space partition, BSP) 
@@ -161,16 +201,27 @@ void
 Topology::LoadBuildings(std::string bldgFilename)
 {
   NS_LOG_UNCOND ("Load buildings");
-  std::ifstream file (bldgFilename.c_str (), std::ios::in);
-  if (!(file.is_open ())) 
+  Topology * topology = Topology::GetTopology();
+  NS_ASSERT(topology != 0);
+
+  // a binary cache next to the buildings file saves parsing it again,
+  // as long as the file is neither changed nor replaced
+  std::string cacheFilename = bldgFilename + ".cache";
+  struct stat bldgStat;
+  bool haveStat = (stat(bldgFilename.c_str(), &bldgStat) == 0);
+  if (haveStat && topology->ReadBuildingsCache(cacheFilename, bldgStat))
     {
-      NS_FATAL_ERROR("Could not open buildings file " << bldgFilename.c_str() << " for reading, aborting here \n"); 
+      NS_LOG_UNCOND ("Reading cache: " << cacheFilename);
     }
   else
     {
-      Topology * topology = Topology::GetTopology();
-      NS_ASSERT(topology != 0);
+      std::ifstream file (bldgFilename.c_str (), std::ios::in);
+      if (!(file.is_open ())) 
+        {
+          NS_FATAL_ERROR("Could not open buildings file " << bldgFilename.c_str() << " for reading, aborting here \n"); 
+        }
 
+      uint32_t first = topology->m_obstacles.size();
       NS_LOG_UNCOND ("Reading file: " << bldgFilename);
       while (!file.eof () )
         {
@@ -178,7 +229,7 @@ Topology::LoadBuildings(std::string bldgFilename)
 
           getline (file, line);
 
-          NS_LOG_UNCOND (line);
+          NS_LOG_LOGIC (line);
 
           size_t posB = line.find("type=\"building");
           size_t posU = line.find("type=\"unknown");
@@ -213,11 +264,62 @@ Topology::LoadBuildings(std::string bldgFilename)
                 }
             }
         }
-      NS_LOG_UNCOND ("Topology buildings bounded by x:" << topology->GetMinX() << "," << topology->GetMaxX() << " y:" << topology->GetMinY() << "," << topology->GetMaxY());
-      // all obstacles have been loaded
-      // so now create a searchable range tree based on those obstacles
-      topology->MakeRangeTree();
+      if (haveStat)
+        {
+          topology->WriteBuildingsCache(cacheFilename, bldgStat, first);
+        }
     }
+  NS_LOG_UNCOND ("Topology buildings bounded by x:" << topology->GetMinX() << "," << topology->GetMaxX() << " y:" << topology->GetMinY() << "," << topology->GetMaxY());
+  // all obstacles have been loaded
+  // so now create a searchable range tree based on those obstacles
+  topology->MakeRangeTree();
+}
+
+bool
+Topology::ReadBuildingsCache(std::string cacheFilename, const struct stat &source)
+{
+  NS_LOG_FUNCTION (this << cacheFilename);
+
+  std::vector<BuildingsCache::Building> buildings;
+  if (!BuildingsCache::Read(cacheFilename, source, buildings))
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < buildings.size(); i++)
+    {
+      const BuildingsCache::Building &building = buildings[i];
+      Obstacle obstacle;
+      obstacle.SetId(building.id);
+      for (uint32_t v = 0; v < building.x.size(); v++)
+        {
+          CreateVertex(obstacle, building.x[v], building.y[v]);
+        }
+      AddShape(obstacle);
+    }
+  m_buildingsCacheReads++;
+  return true;
+}
+
+void
+Topology::WriteBuildingsCache(std::string cacheFilename, const struct stat &source, uint32_t first)
+{
+  NS_LOG_FUNCTION (this << cacheFilename << first);
+
+  std::vector<BuildingsCache::Building> buildings(m_obstacles.size() - first);
+  for (uint32_t i = first; i < m_obstacles.size(); i++)
+    {
+      BuildingsCache::Building &building = buildings[i - first];
+      building.id = m_obstacles[i].GetId();
+      // the vertices are closed by the first one, which is not stored
+      building.x = m_obstacles[i].GetVertexX();
+      building.y = m_obstacles[i].GetVertexY();
+      if (!building.x.empty())
+        {
+          building.x.pop_back();
+          building.y.pop_back();
+        }
+    }
+  BuildingsCache::Write(cacheFilename, source, buildings);
 }
 
 void
@@ -225,7 +327,41 @@ Topology::MakeRangeTree()
 {
   NS_LOG_FUNCTION (this);
 
-  m_rangeTree.make_tree(m_obstacles.begin(), m_obstacles.end());
+  m_rangeTree.make_tree(m_keys.begin(), m_keys.end());
+}
+
+// Tests whether the segment from (x1, y1) to (x2, y2) may cross the box
+// widened by margin on all sides, by clipping the segment parameter to
+// the x and then the y slab of the box (Liang-Barsky)
+static bool
+SegmentMayCrossBox(double x1, double y1, double x2, double y2, const Bbox_2 &box, double margin)
+{
+  double p[2] = { x1, y1 };
+  double d[2] = { x2 - x1, y2 - y1 };
+  double lo[2] = { box.xmin() - margin, box.ymin() - margin };
+  double hi[2] = { box.xmax() + margin, box.ymax() + margin };
+  double t0 = 0.0;
+  double t1 = 1.0;
+  for (int i = 0; i < 2; i++)
+    {
+      if (d[i] == 0.0)
+        {
+          if (p[i] < lo[i] || p[i] > hi[i])
+            {
+              return false;
+            }
+          continue;
+        }
+      double ta = (lo[i] - p[i]) / d[i];
+      double tb = (hi[i] - p[i]) / d[i];
+      t0 = std::max(t0, std::min(ta, tb));
+      t1 = std::min(t1, std::max(ta, tb));
+      if (t0 > t1)
+        {
+          return false;
+        }
+    }
+  return true;
 }
 
 void
@@ -308,6 +444,88 @@ Topology::GetObstructedDistance(const Point &p1, const Point &p2, Obstacle &obs,
     }
 }
 
+// relative error bound of the double precision orientation tests; the
+// rounding error of each is a few units of 1e-16 relative to the sum of
+// the magnitudes of its products, so this leaves a wide margin
+static const double FAST_INTERSECTION_EPS = 1e-12;
+
+bool
+Topology::GetObstructedDistanceFast(double p1x, double p1y, double p2x, double p2y, Obstacle &obs, double &obstructedDistance, int &intersections)
+{
+  NS_LOG_FUNCTION (this);
+
+  // initialize values as if no intersections found
+  obstructedDistance = 0.0;
+  intersections = 0;
+
+  const std::vector<double> &vx = obs.GetVertexX();
+  const std::vector<double> &vy = obs.GetVertexY();
+  if (vx.size() < 2)
+    {
+      return true;
+    }
+
+  // same as the exact test, but with the link p1 + t (p2 - p1) crossing
+  // the edges at parameters t between 0 and 1, so that the obstruction
+  // distance is (t_max - t_min) times the length of the link
+  double dx = p2x - p1x;
+  double dy = p2y - p1y;
+  double t_min = 2.0;
+  double t_max = -1.0;
+
+  size_t edges = vx.size() - 1;
+  for (size_t i = 0; i < edges; i++)
+    {
+      // edge end points a and b, relative to p1
+      double ax = vx[i] - p1x;
+      double ay = vy[i] - p1y;
+      double bx = vx[i + 1] - p1x;
+      double by = vy[i + 1] - p1y;
+
+      // sides of the link a and b are on
+      double o1 = dx * ay - dy * ax;
+      double e1 = FAST_INTERSECTION_EPS * (std::fabs(dx * ay) + std::fabs(dy * ax));
+      double o2 = dx * by - dy * bx;
+      double e2 = FAST_INTERSECTION_EPS * (std::fabs(dx * by) + std::fabs(dy * bx));
+      if ((o1 > e1 && o2 > e2) || (o1 < -e1 && o2 < -e2))
+        {
+          continue;
+        }
+
+      // sides of the edge p1 and p2 are on
+      double ex = bx - ax;
+      double ey = by - ay;
+      double o3 = ey * ax - ex * ay;
+      double e3 = FAST_INTERSECTION_EPS * (std::fabs(ey * ax) + std::fabs(ex * ay));
+      double o4 = ex * (dy - ay) - ey * (dx - ax);
+      double e4 = FAST_INTERSECTION_EPS * (std::fabs(ex * (dy - ay)) + std::fabs(ey * (dx - ax)));
+      if ((o3 > e3 && o4 > e4) || (o3 < -e3 && o4 < -e4))
+        {
+          continue;
+        }
+
+      // an end point on (or too close to) the other segment, or the
+      // segments collinear: leave it to the exact test
+      if (std::fabs(o1) <= e1 || std::fabs(o2) <= e2
+          || std::fabs(o3) <= e3 || std::fabs(o4) <= e4)
+        {
+          return false;
+        }
+
+      // the segments cross properly
+      intersections++;
+      double t = o3 / (o3 - o4);
+      t_min = std::min(t_min, t);
+      t_max = std::max(t_max, t);
+    }
+
+  if ((intersections > 0) && (t_min != t_max))
+    {
+      obstructedDistance = (t_max - t_min) * std::sqrt(dx * dx + dy * dy);
+    }
+  return true;
+}
+
 double 
 Topology::GetObstructedLossBetween(const Point &p1, const Point &p2, double r)
 {
@@ -328,38 +546,11 @@ Topology::GetObstructedLossBetween(const Point &p1, const Point &p2, double r)
   // test first to see if we have a cached value
   // for loss between these two points
   // using their positions to the nearest 0.1m
-
-  char buff[100];
-  sprintf(buff, "%010.1f %010.1f", p1x, p1y);
-  std::string p1Pos = buff;
-  sprintf(buff, "%010.1f %010.1f", p2x, p2y);
-  std::string p2Pos = buff;
-  sprintf(buff, "%s %s", p1Pos.c_str(), p2Pos.c_str());
-  std::string key = buff;
-
-  // check if cached
-  if (m_obstructedDistanceMap.count(key) > 0) 
+  // (B to A is same as A to B)
+  if (m_obstructedLossCache.Lookup(p1x, p1y, p2x, p2y, obstructedLoss))
     {
-      // found it
-      TStrDblMap::iterator it;
-      it = m_obstructedDistanceMap.find(key);
-      obstructedLoss = it->second;
       return obstructedLoss;
     }
-  else
-    {
-      // B to A is same as A to B
-      sprintf(buff, "%s %s", p2Pos.c_str(), p1Pos.c_str());
-      std::string key = buff;
-      if (m_obstructedDistanceMap.count(key) > 0) 
-        {
-          // found it
-          TStrDblMap::iterator it;
-          it = m_obstructedDistanceMap.find(key);
-          obstructedLoss = it->second;
-          return obstructedLoss;
-        }
-    }
 
   // optimization
   // only if dist between p1 and p2 < 2r
@@ -373,11 +564,15 @@ Topology::GetObstructedLossBetween(const Point &p1, const Point &p2, double r)
   if (distP1toP2sq < rSq)
     {
       // now search by range tree search
-      // get bounding box, and extend by r is all directions
-      double xmin = std::min(p1x, p2x) - 1000;
-      double xmax = std::max(p1x, p2x) + 1000;
-      double ymin = std::min(p1y, p2y) - 1000;
-      double ymax = std::max(p1y, p2y) + 1000;
+      // only obstacles whose bounding box overlaps the one of the link
+      // may intersect it; obstacles are keyed by the top right corner of
+      // their bounding box (see Obstacle::Locate), so extend the bounding
+      // box of the link up and right by the largest obstacle; a meter
+      // of margin on each side covers rounding and the window bounds
+      double xmin = std::min(p1x, p2x) - 1;
+      double xmax = std::max(p1x, p2x) + m_maxObstacleWidth + 1;
+      double ymin = std::min(p1y, p2y) - 1;
+      double ymax = std::max(p1y, p2y) + m_maxObstacleHeight + 1;
       Point pLow(xmin, ymin);
       Point pHigh(xmax, ymax);
       Interval win(Interval(pLow, pHigh));
@@ -386,12 +581,31 @@ Topology::GetObstructedLossBetween(const Point &p1, const Point &p2, double r)
       std::vector<Key>::iterator current = m_outputList.begin();
       while (current != m_outputList.end())
         {
-          Obstacle obstacle = (*current).second;
-
+          Obstacle &obstacle = m_obstacles[(*current).second];
+          // skip the exact intersection tests for obstacles the link
+          // clearly misses
+          if (!SegmentMayCrossBox(p1x, p1y, p2x, p2y, obstacle.GetBbox(), 0.001))
+            {
+              current++;
+              continue;
+            }
 
               double obstructedDistanceBetween = 0.0;
               int intersections = 0;
-              GetObstructedDistance(p1, p2, obstacle, obstructedDistanceBetween, intersections);
+              bool done = false;
+              if (m_fastIntersection)
+                {
+                  m_fastIntersectionTests++;
+                  done = GetObstructedDistanceFast(p1x, p1y, p2x, p2y, obstacle, obstructedDistanceBetween, intersections);
+                  if (!done)
+                    {
+                      m_exactIntersectionFallbacks++;
+                    }
+                }
+              if (!done)
+                {
+                  GetObstructedDistance(p1, p2, obstacle, obstructedDistanceBetween, intersections);
+                }
               // From C. Sommer et. al.:
               // A Computationally Inexpensive Empirical Model of IEEE 802.11p
               // Radio Shadowing in Urban Environments, 2011.
@@ -421,17 +635,53 @@ Topology::GetObstructedLossBetween(const Point &p1, const Point &p2, double r)
   else
     obstructedLoss = 0;
 
-  // cache results
-  if (m_obstructedDistanceMap.size() > 1000) 
-    {
-      // clear it every once in a while, to avoid bloat.
-      m_obstructedDistanceMap.clear();
-    }
-  m_obstructedDistanceMap.insert(TStrDblPair(key, obstructedLoss));
+  // cache results; the least recently used link
+  // makes room once the cache is full
+  m_obstructedLossCache.Insert(p1x, p1y, p2x, p2y, obstructedLoss);
 
   return obstructedLoss;
 }
 
+void
+Topology::SetObstructedLossCacheSize(uint32_t entries)
+{
+  NS_LOG_FUNCTION (this << entries);
+
+  m_obstructedLossCache.SetCapacity(entries);
+}
+
+const ObstructedLossCache &
+Topology::GetObstructedLossCache() const
+{
+  return m_obstructedLossCache;
+}
+
+void
+Topology::SetFastIntersection(bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+
+  m_fastIntersection = enable;
+}
+
+uint64_t
+Topology::GetFastIntersectionTests() const
+{
+  return m_fastIntersectionTests;
+}
+
+uint64_t
+Topology::GetExactIntersectionFallbacks() const
+{
+  return m_exactIntersectionFallbacks;
+}
+
+uint64_t
+Topology::GetBuildingsCacheReads() const
+{
+  return m_buildingsCacheReads;
+}
+
 double
 Topology::GetMinX()
 {
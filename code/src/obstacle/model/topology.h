@@ -23,16 +23,18 @@
 #define TOPOLOGY_H
 
 #include "obstacle.h"
+#include "obstructed-loss-cache.h"
+#include "buildings-cache.h"
+#include <sys/stat.h>
 
 namespace ns3 {
 
 // CGAL types
-typedef CGAL::Range_tree_map_traits_2<K, Obstacle> Traits;
+// the range tree maps the corner of each obstacle to its index in the topology
+typedef CGAL::Range_tree_map_traits_2<K, uint32_t> Traits;
 typedef CGAL::Range_tree_2<Traits> Range_tree_2_type;
 typedef Traits::Key Key;
 typedef Traits::Interval Interval;
-typedef std::map<std::string, double> TStrDblMap;
-typedef std::pair<std::string, double> TStrDblPair;
 
 /**
  * \ingroup obstacle
@@ -69,7 +71,10 @@ public:
   static Topology * GetTopology();
 
   /**
-   * \brief Load buildings into the topology
+   * \brief Load buildings into the topology.  The buildings are also
+   * written to a binary cache file, bldgFilename + ".cache", which later
+   * loads map instead of parsing the buildings file again, for as long
+   * as the buildings file is neither changed nor replaced
    * \param bldgFilename the filename that contains buildings data
    * \return none
    */
@@ -108,6 +113,49 @@ public:
    */
   double GetObstructedLossBetween(const Point &p1, const Point &p2, double r);
 
+  /**
+   * \brief Sets the number of links whose obstructed loss is cached.
+   * The topology starts with the ObstructedLossCacheSize global value
+   * \param entries the maximum number of cached links; 0 disables the cache
+   * \return none
+   */
+  void SetObstructedLossCacheSize(uint32_t entries);
+
+  /**
+   * \brief Gets the cache of obstructed losses, e.g., for its hit and miss counts
+   * \return the cache of obstructed losses
+   */
+  const ObstructedLossCache & GetObstructedLossCache() const;
+
+  /**
+   * \brief Sets whether links are first intersected with obstacles in
+   * double precision, falling back to the exact CGAL tests only when a
+   * test is too close to call (enabled by default)
+   * \param enable true to use the fast intersection tests
+   * \return none
+   */
+  void SetFastIntersection(bool enable);
+
+  /**
+   * \brief Gets the number of obstacles intersected with the fast tests
+   * \return the number of fast obstacle intersection tests
+   */
+  uint64_t GetFastIntersectionTests() const;
+
+  /**
+   * \brief Gets the number of fast obstacle intersection tests which
+   * fell back to the exact CGAL tests
+   * \return the number of fallbacks to the exact tests
+   */
+  uint64_t GetExactIntersectionFallbacks() const;
+
+  /**
+   * \brief Gets the number of buildings files whose obstacles were read
+   * from their binary cache instead of being parsed
+   * \return the number of buildings cache reads
+   */
+  uint64_t GetBuildingsCacheReads() const;
+
   /**
    * \brief Tests if the topology has any obstacles (loaded within it)
    * \return true if the topology has obstacles, false otherwise
@@ -146,6 +194,40 @@ private:
    */
   void CreateVertex(Obstacle &obstacle, std::string vertex);
 
+  /**
+   * \brief Create a vertex
+   * \param obstacle the obstacle to which the vertex should be added
+   * \param dx x value of the vertex
+   * \param dy y value of the vertex
+   * \return none
+   */
+  void CreateVertex(Obstacle &obstacle, double dx, double dy);
+
+  /**
+   * \brief Add a shape, once all its vertices are created, to the topology
+   * \param obstacle the obstacle to add
+   * \return none
+   */
+  void AddShape(Obstacle &obstacle);
+
+  /**
+   * \brief Add the obstacles of a binary cache of a buildings file
+   * \param cacheFilename the filename of the cache
+   * \param source the status of the buildings file
+   * \return false, and nothing added, if the cache is missing, invalid
+   * or made from another version of the buildings file
+   */
+  bool ReadBuildingsCache(std::string cacheFilename, const struct stat &source);
+
+  /**
+   * \brief Write the obstacles loaded from a buildings file to a binary cache
+   * \param cacheFilename the filename of the cache
+   * \param source the status of the buildings file
+   * \param first the index of the first obstacle loaded from the buildings file
+   * \return none
+   */
+  void WriteBuildingsCache(std::string cacheFilename, const struct stat &source, uint32_t first);
+
   /**
    * \brief Get the obstructed distance between two points
    * \param p1 point1
@@ -159,8 +241,32 @@ private:
    */
   void GetObstructedDistance(const Point &p1, const Point &p2, Obstacle &obs, double &obstructedDistanceBetween, int &intersections);
 
+  /**
+   * \brief Get the obstructed distance between two points with double
+   * precision edge tests.  Each orientation test is given an error bound;
+   * a test within its bound (e.g., a link along an edge, or through a
+   * vertex) cannot be decided and the exact test must be used instead.
+   * Otherwise the intersections are the same as the exact ones, and the
+   * obstructed distance is within 1e-9 m of the exact one for links of
+   * up to 10 km
+   * \param p1x x value of point1
+   * \param p1y y value of point1
+   * \param p2x x value of point2
+   * \param p2y y value of point2
+   * \param obs obstacle that may lie between p1 and p2
+   * \param obstructedDistanceBetween the total length within obs
+   * traversed by a line between p1 and p2
+   * \param intersections the number of intersections of the obstacle for
+   * a line between p1 and p2
+   * \return false if the exact test must be used instead
+   */
+  bool GetObstructedDistanceFast(double p1x, double p1y, double p2x, double p2y, Obstacle &obs, double &obstructedDistanceBetween, int &intersections);
+
   // list of obstacles in the topology
-  std::vector<Key> m_obstacles;
+  std::vector<Obstacle> m_obstacles;
+
+  // keys of the obstacles, from which the range tree is made
+  std::vector<Key> m_keys;
 
   // output list, used for sorting
   std::vector<Key> m_outputList;
@@ -180,7 +286,21 @@ private:
   // maximum y value of obstacles in the topology
   double m_maxY;
 
-  // a cache of obstructed distances between two points
+  // largest width (x) and height (y) of the bounding box of an obstacle,
+  // by which obstacle searches extend their window
+  double m_maxObstacleWidth;
+  double m_maxObstacleHeight;
+
+  // whether to try the fast intersection tests first, and how often
+  // they were used and fell back to the exact ones
+  bool m_fastIntersection;
+  uint64_t m_fastIntersectionTests;
+  uint64_t m_exactIntersectionFallbacks;
+
+  // number of buildings files read from their binary cache
+  uint64_t m_buildingsCacheReads;
+
+  // a cache of obstructed losses between two points
   // (used for performance optimization).
   // Assume that two points that have not moved more than
   // 0.1m from their last locations will have the same
@@ -189,7 +309,7 @@ private:
   // recalculated deterministically at every evaluation, 
   // e.g., when nodes are stationary (obstacle are, too) so
   // there is no change to previously calculated results.
-  TStrDblMap m_obstructedDistanceMap;
+  ObstructedLossCache m_obstructedLossCache;
 };
 
 } // namespace ns3
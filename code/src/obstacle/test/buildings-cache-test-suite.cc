@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/buildings-cache.h"
+#include "ns3/test.h"
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+// Check that buildings written to a cache are read back as written, and
+// only while the buildings file they were made from is left alone
+class BuildingsCacheTestCase : public TestCase
+{
+public:
+  BuildingsCacheTestCase ();
+  virtual ~BuildingsCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BuildingsCacheTestCase::BuildingsCacheTestCase ()
+  : TestCase ("Check the binary cache of a buildings file")
+{
+}
+
+BuildingsCacheTestCase::~BuildingsCacheTestCase ()
+{
+}
+
+void
+BuildingsCacheTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("buildings-cache-test.xml");
+  std::string cacheFilename = filename + ".cache";
+  std::ofstream file (filename.c_str ());
+  file << "<poly id=\"parsed\" type=\"building\" shape=\"0,0 10,0 10,10 0,10 0,0\"/>" << std::endl;
+  file.close ();
+  struct stat st;
+  NS_TEST_ASSERT_MSG_EQ (stat (filename.c_str (), &st), 0, "could not stat the buildings file");
+
+  std::vector<BuildingsCache::Building> buildings;
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Read (cacheFilename, st, buildings), false, "missing cache read");
+
+  // buildings unlike the ones of the file, to tell the cache from a parse
+  std::vector<BuildingsCache::Building> written (2);
+  written[0].id = "first";
+  written[0].x.push_back (100.25);
+  written[0].y.push_back (-3.5);
+  written[0].x.push_back (110.125);
+  written[0].y.push_back (-3.5);
+  written[0].x.push_back (105.0);
+  written[0].y.push_back (1e-9);
+  written[1].id = "";
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Write (cacheFilename, st, written), true, "could not write the cache");
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Read (cacheFilename, st, buildings), true, "cache not read");
+  NS_TEST_ASSERT_MSG_EQ (buildings.size (), written.size (), "wrong number of buildings");
+  for (uint32_t i = 0; i < written.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (buildings[i].id, written[i].id, "wrong id of building " << i);
+      NS_TEST_ASSERT_MSG_EQ (buildings[i].x.size (), written[i].x.size (), "wrong vertices of building " << i);
+      NS_TEST_ASSERT_MSG_EQ (buildings[i].y.size (), written[i].y.size (), "wrong vertices of building " << i);
+      for (uint32_t v = 0; v < written[i].x.size (); v++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (buildings[i].x[v], written[i].x[v], "wrong x of vertex " << v << " of building " << i);
+          NS_TEST_EXPECT_MSG_EQ (buildings[i].y[v], written[i].y[v], "wrong y of vertex " << v << " of building " << i);
+        }
+    }
+
+  // a truncated cache is ignored as a whole
+  struct stat cacheStat;
+  NS_TEST_ASSERT_MSG_EQ (stat (cacheFilename.c_str (), &cacheStat), 0, "could not stat the cache");
+  NS_TEST_ASSERT_MSG_EQ (truncate (cacheFilename.c_str (), cacheStat.st_size - 1), 0, "could not truncate the cache");
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Read (cacheFilename, st, buildings), false, "truncated cache read");
+  NS_TEST_ASSERT_MSG_EQ (buildings.empty (), true, "buildings of a truncated cache read");
+
+  // rewrite the file, restoring its size and its modification time to the
+  // nanosecond: its cache is stale all the same
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Write (cacheFilename, st, written), true, "could not write the cache");
+  file.open (filename.c_str ());
+  file << "<poly id=\"parsed\" type=\"building\" shape=\"0,0 20,0 20,20 0,20 0,0\"/>" << std::endl;
+  file.close ();
+  struct timespec times[2] = { st.st_atim, st.st_mtim };
+  NS_TEST_ASSERT_MSG_EQ (utimensat (AT_FDCWD, filename.c_str (), times, 0), 0, "could not set the modification time");
+  struct stat rewritten;
+  NS_TEST_ASSERT_MSG_EQ (stat (filename.c_str (), &rewritten), 0, "could not stat the buildings file");
+  NS_TEST_ASSERT_MSG_EQ (rewritten.st_size, st.st_size, "rewritten file of another size");
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Read (cacheFilename, rewritten, buildings), false, "stale cache read");
+
+  // a cache made from the rewritten file is read again
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Write (cacheFilename, rewritten, written), true, "could not write the cache");
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Read (cacheFilename, rewritten, buildings), true, "cache not read");
+  NS_TEST_ASSERT_MSG_EQ (buildings.size (), written.size (), "wrong number of buildings");
+
+  remove (cacheFilename.c_str ());
+  remove (filename.c_str ());
+}
+
+class BuildingsCacheTestSuite : public TestSuite
+{
+public:
+  BuildingsCacheTestSuite ();
+};
+
+BuildingsCacheTestSuite::BuildingsCacheTestSuite ()
+  : TestSuite ("obstacle-buildings-cache", UNIT)
+{
+  AddTestCase (new BuildingsCacheTestCase, TestCase::QUICK);
+}
+
+static BuildingsCacheTestSuite buildingsCacheTestSuite;
@@ -2,9 +2,15 @@
 
 // Include a header file from your module to test.
 #include "ns3/obstacle.h"
+#include "ns3/obstructed-loss-cache.h"
+#include "ns3/buildings-cache.h"
+#include "ns3/topology.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include <fcntl.h>
+#include <sys/stat.h>
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
@@ -46,6 +52,275 @@ ObstacleTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Check the keying, eviction order and counters of the obstructed loss cache
+class ObstructedLossCacheTestCase : public TestCase
+{
+public:
+  ObstructedLossCacheTestCase ();
+  virtual ~ObstructedLossCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ObstructedLossCacheTestCase::ObstructedLossCacheTestCase ()
+  : TestCase ("Check the obstructed loss cache")
+{
+}
+
+ObstructedLossCacheTestCase::~ObstructedLossCacheTestCase ()
+{
+}
+
+void
+ObstructedLossCacheTestCase::DoRun (void)
+{
+  ObstructedLossCache cache (3);
+  double loss = 0.0;
+
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (1.0, 2.0, 3.0, 4.0, loss), false, "empty cache hit");
+  cache.Insert (1.0, 2.0, 3.0, 4.0, 10.0);
+  // either direction, to the nearest 0.1m
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (3.0, 4.0, 1.0, 2.0, loss), true, "reversed link missed");
+  NS_TEST_ASSERT_MSG_EQ (loss, 10.0, "wrong loss");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (1.04, 1.96, 3.0, 4.0, loss), true, "link within 0.1m missed");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (1.1, 2.0, 3.0, 4.0, loss), false, "moved link hit");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (2.0, 1.0, 4.0, 3.0, loss), false, "swapped coordinates hit");
+
+  cache.Insert (0.0, 0.0, 5.0, 0.0, 20.0);
+  cache.Insert (0.0, 0.0, 0.0, 5.0, 30.0);
+  // touch the first link, so the second one is the least recently used
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (1.0, 2.0, 3.0, 4.0, loss), true, "first link missed");
+  cache.Insert (-5.0, 0.0, 0.0, 0.0, 40.0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 3, "cache grew past its capacity");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetEvictions (), 1, "wrong eviction count");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (0.0, 0.0, 5.0, 0.0, loss), false, "least recently used link kept");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (1.0, 2.0, 3.0, 4.0, loss), true, "recently used link evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (0.0, 0.0, -5.0, 0.0, loss), true, "new link missed");
+  NS_TEST_ASSERT_MSG_EQ (loss, 40.0, "wrong loss for recycled entry");
+
+  NS_TEST_ASSERT_MSG_EQ (cache.GetHits (), 5, "wrong hit count");
+  NS_TEST_ASSERT_MSG_EQ (cache.GetMisses (), 4, "wrong miss count");
+
+  cache.SetCapacity (1);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 1, "shrinking kept too many links");
+  NS_TEST_ASSERT_MSG_EQ (cache.Lookup (-5.0, 0.0, 0.0, 0.0, loss), true, "shrinking dropped the most recent link");
+  cache.SetCapacity (0);
+  cache.Insert (1.0, 2.0, 3.0, 4.0, 10.0);
+  NS_TEST_ASSERT_MSG_EQ (cache.GetSize (), 0, "disabled cache stored a link");
+
+  // a topology takes its cache size from the global value
+  Config::SetGlobal ("ObstructedLossCacheSize", UintegerValue (128));
+  Topology topology;
+  Config::SetGlobal ("ObstructedLossCacheSize", UintegerValue (65536));
+  NS_TEST_ASSERT_MSG_EQ (topology.GetObstructedLossCache ().GetCapacity (), 128, "global cache size ignored");
+}
+
+// Check the obstructed losses of links through, beside and far from buildings
+class TopologyObstructedLossTestCase : public TestCase
+{
+public:
+  TopologyObstructedLossTestCase ();
+  virtual ~TopologyObstructedLossTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TopologyObstructedLossTestCase::TopologyObstructedLossTestCase ()
+  : TestCase ("Check the obstructed losses of the topology")
+{
+}
+
+TopologyObstructedLossTestCase::~TopologyObstructedLossTestCase ()
+{
+}
+
+void
+TopologyObstructedLossTestCase::DoRun (void)
+{
+  // a 10m square, a 10m x 40m block far to the east, and a triangle whose
+  // bounding box, but not its shape, holds the point (25, 15)
+  std::string filename = CreateTempDirFilename ("obstacle-test-buildings.xml");
+  std::ofstream file (filename.c_str ());
+  file << "<poly id=\"square\" type=\"building\" shape=\"0,0 10,0 10,10 0,10 0,0\"/>" << std::endl;
+  file << "<poly id=\"block\" type=\"building\" shape=\"1200,0 1210,0 1210,40 1200,40 1200,0\"/>" << std::endl;
+  file << "<poly id=\"triangle\" type=\"building\" shape=\"20,0 30,0 20,10 20,0\"/>" << std::endl;
+  file.close ();
+  Topology::LoadBuildings (filename);
+  Topology *topology = Topology::GetTopology ();
+  topology->SetObstructedLossCacheSize (0);
+
+  // beta = 9 per wall, gamma = 0.4 per meter
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (-5, 5), Point (15, 5), 2000), 22.0, 1e-6,
+                             "wrong loss through the square");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (15, 5), Point (-5, 5), 2000), 22.0, 1e-6,
+                             "wrong loss through the square, reversed");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetObstructedLossBetween (Point (-5, 20), Point (15, 20), 2000), 0.0,
+                         "loss beside the square");
+  NS_TEST_ASSERT_MSG_EQ (topology->GetObstructedLossBetween (Point (24, 8), Point (30, 8), 2000), 0.0,
+                         "loss outside the triangle, within its bounding box");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (-5, 20), Point (1250, 20), 2000), 22.0, 1e-6,
+                             "wrong loss through the block");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (-5, 5), Point (1250, 5), 2000), 64.0, 1e-6,
+                             "wrong loss through the square, the triangle and the block");
+}
+
+// Check that the fast intersection tests give the losses of the exact
+// ones, and fall back to them for links along an edge or through a vertex
+class TopologyFastIntersectionTestCase : public TestCase
+{
+public:
+  TopologyFastIntersectionTestCase ();
+  virtual ~TopologyFastIntersectionTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TopologyFastIntersectionTestCase::TopologyFastIntersectionTestCase ()
+  : TestCase ("Check the fast obstacle intersection tests against the exact ones")
+{
+}
+
+TopologyFastIntersectionTestCase::~TopologyFastIntersectionTestCase ()
+{
+}
+
+void
+TopologyFastIntersectionTestCase::DoRun (void)
+{
+  // a tilted rectangle and a concave shape, away from the obstacles of
+  // the other test cases
+  std::string filename = CreateTempDirFilename ("obstacle-test-fast-buildings.xml");
+  std::ofstream file (filename.c_str ());
+  file << "<poly id=\"tilted\" type=\"building\" shape=\"5000,0 5010,3 5007,13 4997,10 5000,0\"/>" << std::endl;
+  file << "<poly id=\"notch\" type=\"building\" shape=\"5015,0 5025,0 5025,10 5020,4.5 5015,10 5015,0\"/>" << std::endl;
+  file.close ();
+  Topology::LoadBuildings (filename);
+  Topology *topology = Topology::GetTopology ();
+  topology->SetObstructedLossCacheSize (0);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Point p1 (rng->GetValue (4980, 5040), rng->GetValue (-20, 30));
+      Point p2 (rng->GetValue (4980, 5040), rng->GetValue (-20, 30));
+      topology->SetFastIntersection (true);
+      double fast = topology->GetObstructedLossBetween (p1, p2, 2000);
+      topology->SetFastIntersection (false);
+      double exact = topology->GetObstructedLossBetween (p1, p2, 2000);
+      NS_TEST_ASSERT_MSG_EQ_TOL (fast, exact, 1e-6, "fast and exact losses differ between " << p1 << " and " << p2);
+    }
+
+  // along an edge, through a vertex, and along a line through two vertices
+  Point degenerate[][2] = {
+    { Point (4990, -3), Point (5020, 6) },
+    { Point (5020, -5), Point (5020, 20) },
+    { Point (4990, 10), Point (5030, 10) }
+  };
+  for (uint32_t i = 0; i < sizeof (degenerate) / sizeof (degenerate[0]); i++)
+    {
+      topology->SetFastIntersection (true);
+      uint64_t fallbacks = topology->GetExactIntersectionFallbacks ();
+      double fast = topology->GetObstructedLossBetween (degenerate[i][0], degenerate[i][1], 2000);
+      NS_TEST_ASSERT_MSG_GT (topology->GetExactIntersectionFallbacks (), fallbacks,
+                             "no fallback for degenerate link " << i);
+      topology->SetFastIntersection (false);
+      double exact = topology->GetObstructedLossBetween (degenerate[i][0], degenerate[i][1], 2000);
+      NS_TEST_ASSERT_MSG_EQ_TOL (fast, exact, 1e-6, "fast and exact losses differ for degenerate link " << i);
+    }
+  topology->SetFastIntersection (true);
+}
+
+// Check that a buildings file is loaded from its cache while it is left
+// alone, and parsed again once it is rewritten, even with the same size
+// and modification time; the cache reads are counted, and a cache whose
+// geometry differs from the file shows which of the two was loaded
+class TopologyBuildingsCacheTestCase : public TestCase
+{
+public:
+  TopologyBuildingsCacheTestCase ();
+  virtual ~TopologyBuildingsCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TopologyBuildingsCacheTestCase::TopologyBuildingsCacheTestCase ()
+  : TestCase ("Check the binary cache of a buildings file")
+{
+}
+
+TopologyBuildingsCacheTestCase::~TopologyBuildingsCacheTestCase ()
+{
+}
+
+void
+TopologyBuildingsCacheTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("obstacle-test-cached-buildings.xml");
+  std::ofstream file (filename.c_str ());
+  file << "<poly id=\"cached\" type=\"building\" shape=\"8000,0 8010,0 8010,10 8000,10 8000,0\"/>" << std::endl;
+  file.close ();
+  Topology *topology = Topology::GetTopology ();
+  uint64_t reads = topology->GetBuildingsCacheReads ();
+  Topology::LoadBuildings (filename);
+  NS_TEST_ASSERT_MSG_EQ (topology->GetBuildingsCacheReads (), reads, "buildings file without a cache not parsed");
+  topology->SetObstructedLossCacheSize (0);
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (7995, 5), Point (8015, 5), 2000), 22.0, 1e-6,
+                             "wrong loss through the building");
+  std::ifstream cache ((filename + ".cache").c_str ());
+  NS_TEST_ASSERT_MSG_EQ (cache.is_open (), true, "no cache written");
+  cache.close ();
+
+  // the unchanged file is taken from the cache, which adds the building
+  // a second time
+  Topology::LoadBuildings (filename);
+  NS_TEST_ASSERT_MSG_EQ (topology->GetBuildingsCacheReads (), reads + 1, "building not loaded from the cache");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (7995, 5), Point (8015, 5), 2000), 44.0, 1e-6,
+                             "building not loaded from the cache");
+
+  // move the building, restoring the size and the modification time of
+  // the file to the nanosecond: it is parsed again
+  struct stat st;
+  NS_TEST_ASSERT_MSG_EQ (stat (filename.c_str (), &st), 0, "could not stat the buildings file");
+  file.open (filename.c_str ());
+  file << "<poly id=\"cached\" type=\"building\" shape=\"8100,0 8110,0 8110,10 8100,10 8100,0\"/>" << std::endl;
+  file.close ();
+  struct timespec times[2] = { st.st_atim, st.st_mtim };
+  NS_TEST_ASSERT_MSG_EQ (utimensat (AT_FDCWD, filename.c_str (), times, 0), 0, "could not set the modification time");
+  Topology::LoadBuildings (filename);
+  NS_TEST_ASSERT_MSG_EQ (topology->GetBuildingsCacheReads (), reads + 1, "stale cache loaded");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (8095, 5), Point (8115, 5), 2000), 22.0, 1e-6,
+                             "rewritten buildings file not parsed");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (7995, 5), Point (8015, 5), 2000), 44.0, 1e-6,
+                             "stale cache loaded");
+
+  // the cache now matches the rewritten file
+  Topology::LoadBuildings (filename);
+  NS_TEST_ASSERT_MSG_EQ (topology->GetBuildingsCacheReads (), reads + 2, "rewritten building not loaded from the cache");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (8095, 5), Point (8115, 5), 2000), 44.0, 1e-6,
+                             "rewritten building not loaded from the cache");
+
+  // a cache holding a building which is not in the file: only the cache
+  // can have added it
+  NS_TEST_ASSERT_MSG_EQ (stat (filename.c_str (), &st), 0, "could not stat the buildings file");
+  std::vector<BuildingsCache::Building> buildings (1);
+  buildings[0].id = "cache-only";
+  double x[] = { 8200, 8210, 8210, 8200 };
+  double y[] = { 0, 0, 10, 10 };
+  buildings[0].x.assign (x, x + 4);
+  buildings[0].y.assign (y, y + 4);
+  NS_TEST_ASSERT_MSG_EQ (BuildingsCache::Write (filename + ".cache", st, buildings), true, "could not write the cache");
+  Topology::LoadBuildings (filename);
+  NS_TEST_ASSERT_MSG_EQ (topology->GetBuildingsCacheReads (), reads + 3, "cache not read");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (8195, 5), Point (8215, 5), 2000), 22.0, 1e-6,
+                             "building of the cache not loaded");
+  NS_TEST_ASSERT_MSG_EQ_TOL (topology->GetObstructedLossBetween (Point (8095, 5), Point (8115, 5), 2000), 44.0, 1e-6,
+                             "buildings file parsed instead of its cache");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +336,10 @@ ObstacleTestSuite::ObstacleTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new ObstacleTestCase1, TestCase::QUICK);
+  AddTestCase (new ObstructedLossCacheTestCase, TestCase::QUICK);
+  AddTestCase (new TopologyObstructedLossTestCase, TestCase::QUICK);
+  AddTestCase (new TopologyFastIntersectionTestCase, TestCase::QUICK);
+  AddTestCase (new TopologyBuildingsCacheTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -29,6 +29,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -94,6 +95,67 @@ PropagationLossModel::AssignStreams (int64_t stream)
   return (currentStream - stream);
 }
 
+double
+PropagationLossModel::GetRxPowerUpperBound (double txPowerDbm, double distance) const
+{
+  double self = DoGetRxPowerUpperBound (txPowerDbm, distance);
+  if (m_next != 0 && self != std::numeric_limits<double>::infinity ())
+    {
+      self = m_next->GetRxPowerUpperBound (self, distance);
+    }
+  return self;
+}
+
+double
+PropagationLossModel::DoGetRxPowerUpperBound (double, double) const
+{
+  return std::numeric_limits<double>::infinity ();
+}
+
+bool
+PropagationLossModel::IsBatchSupported (void) const
+{
+  for (const PropagationLossModel *model = this; model != 0; model = PeekPointer (model->m_next))
+    {
+      if (!model->DoIsBatchSupported ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+PropagationLossModel::CalcRxPowerBatch (double txPowerDbm, Ptr<MobilityModel> a,
+                                        const std::vector<Vector> &positions,
+                                        std::vector<double> &rxPowerDbm) const
+{
+  NS_ASSERT (IsBatchSupported ());
+  rxPowerDbm.assign (positions.size (), txPowerDbm);
+  if (positions.empty ())
+    {
+      return;
+    }
+  Vector txPosition = a->GetPosition ();
+  for (const PropagationLossModel *model = this; model != 0; model = PeekPointer (model->m_next))
+    {
+      model->DoCalcRxPowerBatch (txPosition, &positions[0], &rxPowerDbm[0], positions.size ());
+    }
+}
+
+bool
+PropagationLossModel::DoIsBatchSupported (void) const
+{
+  return false;
+}
+
+void
+PropagationLossModel::DoCalcRxPowerBatch (const Vector &, const Vector *,
+                                          double *, uint32_t) const
+{
+  NS_FATAL_ERROR ("DoCalcRxPowerBatch not implemented by " << GetInstanceTypeId ());
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (RandomPropagationLossModel);
@@ -277,6 +339,43 @@ FriisPropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FriisPropagationLossModel::DoGetRxPowerUpperBound (double txPowerDbm, double distance) const
+{
+  if (distance <= 0)
+    {
+      return txPowerDbm - m_minLoss;
+    }
+  double numerator = m_lambda * m_lambda;
+  double denominator = 16 * M_PI * M_PI * distance * distance * m_systemLoss;
+  double lossDb = -10 * log10 (numerator / denominator);
+  return txPowerDbm - std::max (lossDb, m_minLoss);
+}
+
+bool
+FriisPropagationLossModel::DoIsBatchSupported (void) const
+{
+  return true;
+}
+
+void
+FriisPropagationLossModel::DoCalcRxPowerBatch (const Vector &txPosition, const Vector *positions,
+                                               double *rxPowerDbm, uint32_t n) const
+{
+  double numerator = m_lambda * m_lambda;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = positions[i].x - txPosition.x;
+      double dy = positions[i].y - txPosition.y;
+      double dz = positions[i].z - txPosition.z;
+      double distance = std::sqrt (dx * dx + dy * dy + dz * dz);
+      // at distance zero the loss is -infinity, and m_minLoss applies
+      double denominator = 16 * M_PI * M_PI * distance * distance * m_systemLoss;
+      double lossDb = -10 * log10 (numerator / denominator);
+      rxPowerDbm[i] -= std::max (lossDb, m_minLoss);
+    }
+}
+
 // ------------------------------------------------------------------------- //
 // -- Two-Ray Ground Model ported from NS-2 -- tomhewer@mac.com -- Nov09 //
 
@@ -540,6 +639,39 @@ LogDistancePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+LogDistancePropagationLossModel::DoGetRxPowerUpperBound (double txPowerDbm, double distance) const
+{
+  if (distance <= m_referenceDistance)
+    {
+      return txPowerDbm - m_referenceLoss;
+    }
+  double pathLossDb = 10 * m_exponent * std::log10 (distance / m_referenceDistance);
+  return txPowerDbm - m_referenceLoss - pathLossDb;
+}
+
+bool
+LogDistancePropagationLossModel::DoIsBatchSupported (void) const
+{
+  return true;
+}
+
+void
+LogDistancePropagationLossModel::DoCalcRxPowerBatch (const Vector &txPosition, const Vector *positions,
+                                                     double *rxPowerDbm, uint32_t n) const
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = positions[i].x - txPosition.x;
+      double dy = positions[i].y - txPosition.y;
+      double dz = positions[i].z - txPosition.z;
+      // within the reference distance the path loss is zero
+      double distance = std::max (std::sqrt (dx * dx + dy * dy + dz * dz), m_referenceDistance);
+      double pathLossDb = 10 * m_exponent * std::log10 (distance / m_referenceDistance);
+      rxPowerDbm[i] += -m_referenceLoss - pathLossDb;
+    }
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (ThreeLogDistancePropagationLossModel);
@@ -804,6 +936,12 @@ FixedRssLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+FixedRssLossModel::DoGetRxPowerUpperBound (double, double) const
+{
+  return m_rss;
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (MatrixPropagationLossModel);
@@ -930,6 +1068,16 @@ RangePropagationLossModel::DoAssignStreams (int64_t stream)
   return 0;
 }
 
+double
+RangePropagationLossModel::DoGetRxPowerUpperBound (double txPowerDbm, double distance) const
+{
+  if (distance <= m_range)
+    {
+      return txPowerDbm;
+    }
+  return -1000;
+}
+
 // ------------------------------------------------------------------------- //
 
 } // namespace ns3
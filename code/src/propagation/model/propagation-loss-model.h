@@ -27,7 +27,9 @@
 
 #include "ns3/object.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/vector.h"
 #include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -106,6 +108,47 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Returns an upper bound on the Rx power that CalcRxPower can return,
+   * taking into account all the PropagationLossModel(s) chained to the
+   * current one, for any pair of nodes at least \p distance meters apart.
+   *
+   * Channels use this bound to skip receivers that cannot possibly hear
+   * a transmission. The bound is +infinity as soon as one model of the
+   * chain cannot bound its output.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the minimum distance between source and destination (in meters)
+   * \returns an upper bound on the reception power (in dBm)
+   */
+  double GetRxPowerUpperBound (double txPowerDbm, double distance) const;
+
+  /**
+   * \returns true if every PropagationLossModel chained to the current
+   * one, and the current one, can compute the Rx power of a batch of
+   * destinations from their positions alone
+   */
+  bool IsBatchSupported (void) const;
+
+  /**
+   * Returns the Rx power at each of a batch of destinations, taking into
+   * account all the PropagationLossModel(s) chained to the current one.
+   * The result is bit-identical to the one of CalcRxPower for each
+   * destination. Only valid if IsBatchSupported returns true.
+   *
+   * Channels use this to compute the Rx power of all the receivers of a
+   * transmission at once, in loops the compiler can vectorize, rather
+   * than through the virtual chain one receiver at a time.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param a the mobility model of the source
+   * \param positions the positions of the destinations
+   * \param rxPowerDbm set to the reception power at each destination (in dBm)
+   */
+  void CalcRxPowerBatch (double txPowerDbm, Ptr<MobilityModel> a,
+                         const std::vector<Vector> &positions,
+                         std::vector<double> &rxPowerDbm) const;
+
 private:
   /**
    * \brief Copy constructor
@@ -140,6 +183,43 @@ private:
    */
   virtual int64_t DoAssignStreams (int64_t stream) = 0;
 
+  /**
+   * Returns an upper bound on the Rx power taking into account only the
+   * particular PropagationLossModel, for any pair of nodes at least
+   * \p distance meters apart. The bound must not increase with distance
+   * and must not decrease with transmission power. The default
+   * implementation returns +infinity, i.e., no bound.
+   *
+   * \param txPowerDbm current transmission power (in dBm)
+   * \param distance the minimum distance between source and destination (in meters)
+   * \returns an upper bound on the reception power (in dBm)
+   */
+  virtual double DoGetRxPowerUpperBound (double txPowerDbm, double distance) const;
+
+  /**
+   * Returns whether this particular PropagationLossModel implements
+   * DoCalcRxPowerBatch. The default implementation returns false.
+   *
+   * \returns true if DoCalcRxPowerBatch is implemented
+   */
+  virtual bool DoIsBatchSupported (void) const;
+
+  /**
+   * Replaces each power in \p rxPowerDbm with the reception power
+   * DoCalcRxPower would return for it as transmission power, at the
+   * matching position, bit for bit: implementations may hoist terms out
+   * of the loop, but must keep the order of the floating point operations
+   * of DoCalcRxPower. Must be implemented if DoIsBatchSupported returns
+   * true.
+   *
+   * \param txPosition the position of the source
+   * \param positions the positions of the destinations
+   * \param rxPowerDbm the powers to transform (in dBm)
+   * \param n the number of destinations
+   */
+  virtual void DoCalcRxPowerBatch (const Vector &txPosition, const Vector *positions,
+                                   double *rxPowerDbm, uint32_t n) const;
+
   Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
 };
 
@@ -322,6 +402,10 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetRxPowerUpperBound (double txPowerDbm, double distance) const;
+  virtual bool DoIsBatchSupported (void) const;
+  virtual void DoCalcRxPowerBatch (const Vector &txPosition, const Vector *positions,
+                                   double *rxPowerDbm, uint32_t n) const;
 
   /**
    * Transforms a Dbm value to Watt
@@ -530,6 +614,10 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetRxPowerUpperBound (double txPowerDbm, double distance) const;
+  virtual bool DoIsBatchSupported (void) const;
+  virtual void DoCalcRxPowerBatch (const Vector &txPosition, const Vector *positions,
+                                   double *rxPowerDbm, uint32_t n) const;
 
   /**
    *  Creates a default reference loss model
@@ -747,6 +835,7 @@ private:
                                 Ptr<MobilityModel> b) const;
 
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetRxPowerUpperBound (double txPowerDbm, double distance) const;
   double m_rss; //!< the received signal strength
 };
 
@@ -852,6 +941,7 @@ private:
                                 Ptr<MobilityModel> a,
                                 Ptr<MobilityModel> b) const;
   virtual int64_t DoAssignStreams (int64_t stream);
+  virtual double DoGetRxPowerUpperBound (double txPowerDbm, double distance) const;
 private:
   double m_range; //!< Maximum Transmission Range (meters)
 };
@@ -436,6 +436,71 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class BatchPropagationLossModelTestCase : public TestCase
+{
+public:
+  BatchPropagationLossModelTestCase ();
+  virtual ~BatchPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Compare CalcRxPowerBatch with CalcRxPower for the given chain
+  void Check (Ptr<PropagationLossModel> model, std::string name);
+};
+
+BatchPropagationLossModelTestCase::BatchPropagationLossModelTestCase ()
+  : TestCase ("Test CalcRxPowerBatch against CalcRxPower")
+{
+}
+
+BatchPropagationLossModelTestCase::~BatchPropagationLossModelTestCase ()
+{
+}
+
+void
+BatchPropagationLossModelTestCase::Check (Ptr<PropagationLossModel> model, std::string name)
+{
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  a->SetPosition (Vector (10, -20, 1.5));
+  std::vector<Vector> positions;
+  // the transmitter itself, within the reference distance, then further
+  positions.push_back (a->GetPosition ());
+  positions.push_back (Vector (10.5, -20, 1.5));
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      positions.push_back (Vector (10 + 7.3 * i, -20 - 3.1 * i, 1.5 + 0.01 * i));
+    }
+  std::vector<double> rxPowerDbm;
+  model->CalcRxPowerBatch (16.0, a, positions, rxPowerDbm);
+  NS_TEST_ASSERT_MSG_EQ (rxPowerDbm.size (), positions.size (), name << ": wrong number of powers");
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+  for (uint32_t i = 0; i < positions.size (); i++)
+    {
+      b->SetPosition (positions[i]);
+      // bit-identical, as the batch may replace CalcRxPower in a channel
+      NS_TEST_EXPECT_MSG_EQ (rxPowerDbm[i], model->CalcRxPower (16.0, a, b),
+                             name << ": wrong power at " << positions[i]);
+    }
+}
+
+void
+BatchPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<FriisPropagationLossModel> friis = CreateObject<FriisPropagationLossModel> ();
+  NS_TEST_ASSERT_MSG_EQ (friis->IsBatchSupported (), true, "Friis supports batches");
+  Check (friis, "Friis");
+
+  Ptr<LogDistancePropagationLossModel> logDistance = CreateObject<LogDistancePropagationLossModel> ();
+  Check (logDistance, "LogDistance");
+
+  logDistance->SetNext (friis);
+  Check (logDistance, "LogDistance then Friis");
+
+  friis->SetNext (CreateObject<RandomPropagationLossModel> ());
+  NS_TEST_ASSERT_MSG_EQ (logDistance->IsBatchSupported (), false, "a model of the chain does not support batches");
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +515,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new BatchPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -0,0 +1,596 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * SATMAC benchmark.
+ *
+ * The macro benchmark runs BSM traffic over the TDMA and CSMA devices of
+ * the v2x example, with vehicles placed on a synthetic highway or grid
+ * instead of read from a mobility trace, and reports the wall time, the
+ * simulator events per second, the peak resident set size and the wall
+ * time spent per simulated second:
+ *
+ *   ./waf --run "satmac-benchmark --scenario=highway --nodes=800 --simTime=10"
+ *
+ * Receiver culling (YansWifiChannel::RxCulling) is off by default, as the
+ * culled signals are missing from the interference at the culled
+ * receivers; --rxCulling=1 measures its speed-up with a 30 dB margin,
+ * under which the culled signals leave the receptions unchanged.
+ *
+ * Each run builds a single scenario, so that the peak RSS it reports is
+ * its own; sweep the node counts (200, 400, 800, 1600) from the shell.
+ *
+ * The micro benchmarks time the FI encoding and decoding, merge_fi and
+ * determine_BCH on random frames:
+ *
+ *   ./waf --run "satmac-benchmark --micro=1"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/wifi-80211p-helper.h"
+#include "ns3/wave-mac-helper.h"
+#include "ns3/wave-bsm-helper.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/tdma-satmac.h"
+#include "ns3/satmac-packet.h"
+#include "ns3/MacLayerController.h"
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::satmac;
+
+NS_LOG_COMPONENT_DEFINE ("SatmacBenchmark");
+
+namespace ns3 {
+
+/**
+ * \brief a MapScheduler which counts the events it hands out
+ *
+ * The simulator does not count the events it runs, so the benchmark
+ * installs this scheduler to compute its event rate.
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual Scheduler::Event RemoveNext (void);
+  /// \return the number of events removed from any CountingScheduler
+  static uint64_t GetCount (void);
+
+private:
+  static uint64_t m_count; ///< the number of events removed
+};
+
+uint64_t CountingScheduler::m_count = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .SetGroupName ("Satmac")
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+Scheduler::Event
+CountingScheduler::RemoveNext (void)
+{
+  m_count++;
+  return MapScheduler::RemoveNext ();
+}
+
+uint64_t
+CountingScheduler::GetCount (void)
+{
+  return m_count;
+}
+
+/**
+ * \brief micro benchmarks of the FI handling of TdmaSatmac
+ *
+ * A friend of TdmaSatmac, to reach merge_fi and determine_BCH.
+ */
+class SatmacMicroBenchmark
+{
+public:
+  /**
+   * Run every micro benchmark for each frame length.
+   *
+   * \param iterations the number of timed calls of each benchmark
+   */
+  static void Run (uint32_t iterations);
+
+private:
+  /**
+   * Fill a frame with random slot states.
+   *
+   * \param fi the frame
+   * \param rng the random variable
+   * \param busyRatio the ratio of occupied slots
+   * \param ownSti an sti to mark some of the occupied slots with, or 0
+   */
+  static void Randomize (Frame_info *fi, Ptr<UniformRandomVariable> rng, double busyRatio, int ownSti);
+  /**
+   * Time FiHeader encoding and decoding.
+   *
+   * \param frameLen the frame length
+   * \param iterations the number of FIs to encode and decode
+   */
+  static void FiCodec (int frameLen, uint32_t iterations);
+  /**
+   * Time merge_fi with a neighbourhood of received FIs.
+   *
+   * \param frameLen the frame length
+   * \param iterations the number of merges
+   */
+  static void MergeFi (int frameLen, uint32_t iterations);
+  /**
+   * Time determine_BCH on a half occupied frame.
+   *
+   * \param frameLen the frame length
+   * \param iterations the number of slot choices
+   */
+  static void DetermineBch (int frameLen, uint32_t iterations);
+  /**
+   * Print a result line.
+   *
+   * \param name the benchmark
+   * \param frameLen the frame length
+   * \param iterations the number of timed calls
+   * \param start the start of the timed calls
+   */
+  static void Report (std::string name, int frameLen, uint32_t iterations,
+                      std::chrono::steady_clock::time_point start);
+};
+
+void
+SatmacMicroBenchmark::Report (std::string name, int frameLen, uint32_t iterations,
+                              std::chrono::steady_clock::time_point start)
+{
+  double ns = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+  std::cout << std::left << std::setw (16) << name
+            << " frameLen=" << std::setw (4) << frameLen
+            << std::right << std::fixed << std::setprecision (1)
+            << std::setw (10) << ns / iterations << " ns/call"
+            << std::setw (8) << ns / iterations / frameLen << " ns/slot" << std::endl;
+}
+
+void
+SatmacMicroBenchmark::Randomize (Frame_info *fi, Ptr<UniformRandomVariable> rng, double busyRatio, int ownSti)
+{
+  for (int i = 0; i < fi->frame_len; i++)
+    {
+      slot_tag &tag = fi->slot_describe[i];
+      tag = slot_tag ();
+      if (rng->GetValue () >= busyRatio)
+        {
+          continue;
+        }
+      tag.busy = rng->GetInteger (SLOT_2HOP, SLOT_COLLISION);
+      tag.sti = (ownSti != 0 && rng->GetValue () < 0.05) ? ownSti : rng->GetInteger (1, 4095);
+      tag.count_2hop = rng->GetInteger (1, 3);
+      tag.count_3hop = rng->GetInteger (0, 3);
+      tag.life_time = 3;
+    }
+}
+
+void
+SatmacMicroBenchmark::FiCodec (int frameLen, uint32_t iterations)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  Frame_info table (frameLen);
+  Randomize (&table, rng, 0.5, 0);
+
+  std::vector<Ptr<Packet> > packets (iterations);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t k = 0; k < iterations; k++)
+    {
+      FiHeader header (frameLen, 1 + k % 4095, table.slot_describe);
+      packets[k] = Create<Packet> ();
+      packets[k]->AddHeader (header);
+    }
+  Report ("fi-encode", frameLen, iterations, start);
+
+  Frame_info fi (frameLen);
+  unsigned long sink = 0;
+  start = std::chrono::steady_clock::now ();
+  for (uint32_t k = 0; k < iterations; k++)
+    {
+      FiHeader header;
+      packets[k]->RemoveHeader (header);
+      unsigned int bytePos = 0;
+      unsigned int bitPos = 7;
+      sink += header.decode_value (bytePos, bitPos, BIT_LENGTH_STI);
+      sink += header.decode_value (bytePos, bitPos, BIT_LENGTH_FRAMELEN);
+      for (int i = 0; i < frameLen; i++)
+        {
+          header.decode_slot_tag (bytePos, bitPos, i, &fi);
+        }
+      sink += fi.slot_describe[frameLen - 1].sti;
+    }
+  Report ("fi-decode", frameLen, iterations, start);
+  NS_LOG_DEBUG ("decoded " << sink);
+}
+
+void
+SatmacMicroBenchmark::MergeFi (int frameLen, uint32_t iterations)
+{
+  const int neighbors = 32;
+  const int ownSti = 1;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  Ptr<TdmaSatmac> mac = CreateObject<TdmaSatmac> ();
+  mac->global_sti = ownSti;
+  delete mac->collected_fi_;
+  mac->collected_fi_ = new Frame_info (frameLen);
+  Frame_info local (frameLen);
+  Randomize (&local, rng, 0.5, ownSti);
+  std::vector<Frame_info *> received;
+  for (int n = 0; n < neighbors; n++)
+    {
+      received.push_back (new Frame_info (frameLen));
+      Randomize (received.back (), rng, 0.6, ownSti);
+      received.back ()->sti = rng->GetInteger (2, 4095);
+    }
+
+  // each round merges the FIs of every neighbour into the local frame,
+  // as synthesize_fi_list does once per frame
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t k = 0; k < iterations; k++)
+    {
+      if (k % neighbors == 0)
+        {
+          std::copy (local.slot_describe, local.slot_describe + frameLen, mac->collected_fi_->slot_describe);
+          mac->m_frame_len = frameLen;
+        }
+      mac->merge_fi (mac->collected_fi_, received[k % neighbors], mac->decision_fi_);
+    }
+  Report ("merge_fi", frameLen, iterations, start);
+
+  for (int n = 0; n < neighbors; n++)
+    {
+      delete received[n];
+    }
+  mac->Dispose ();
+}
+
+void
+SatmacMicroBenchmark::DetermineBch (int frameLen, uint32_t iterations)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  Ptr<TdmaSatmac> mac = CreateObject<TdmaSatmac> ();
+  mac->global_sti = 1;
+  mac->m_frame_len = frameLen;
+  delete mac->collected_fi_;
+  mac->collected_fi_ = new Frame_info (frameLen);
+  Randomize (mac->collected_fi_, rng, 0.5, 0);
+
+  long sink = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t k = 0; k < iterations; k++)
+    {
+      sink += mac->determine_BCH (k % 2);
+    }
+  Report ("determine_BCH", frameLen, iterations, start);
+  NS_LOG_DEBUG ("chose " << sink);
+  mac->Dispose ();
+}
+
+void
+SatmacMicroBenchmark::Run (uint32_t iterations)
+{
+  int frameLengths[] = { 32, 64, 128, 256 };
+  for (uint32_t f = 0; f < sizeof (frameLengths) / sizeof (frameLengths[0]); f++)
+    {
+      FiCodec (frameLengths[f], iterations);
+      MergeFi (frameLengths[f], iterations);
+      DetermineBch (frameLengths[f], iterations);
+    }
+}
+
+} // namespace ns3
+
+/**
+ * \brief the SATMAC macro benchmark
+ */
+class SatmacBenchmark
+{
+public:
+  SatmacBenchmark ();
+  /**
+   * Parse the command line.
+   *
+   * \param argc the argument count
+   * \param argv the arguments
+   */
+  void Configure (int argc, char **argv);
+  /// Run the micro benchmarks or the scenario and print the results
+  void Run (void);
+
+private:
+  /// Create the nodes and their devices, stacks and MAC controllers
+  void CreateDevices (void);
+  /// Place the vehicles on a multi-lane highway
+  void SetupHighway (void);
+  /// Place the vehicles on the streets of a square grid
+  void SetupGrid (void);
+  /// Install the BSM applications
+  void SetupApplications (void);
+  /// Sample the wall time of the last simulated second
+  void Probe (void);
+  /// \return the peak resident set size (kB)
+  static long GetPeakRss (void);
+
+  std::string m_scenario;                 ///< highway or grid
+  uint32_t m_nodes;                       ///< number of vehicles
+  double m_simTime;                       ///< simulated time (s)
+  bool m_micro;                           ///< run the micro benchmarks instead
+  uint32_t m_iterations;                  ///< calls per micro benchmark
+  bool m_rxCulling;                       ///< cull receivers out of detection range
+  NodeContainer m_vehicles;               ///< the vehicles
+  NetDeviceContainer m_tdmaDevices;       ///< the TDMA devices
+  NetDeviceContainer m_csmaDevices;       ///< the CSMA devices
+  Ipv4InterfaceContainer m_interfaces;    ///< the TDMA interfaces, used by the BSM applications
+  WaveBsmHelper m_waveBsmHelper;          ///< the BSM helper
+  Ptr<UniformRandomVariable> m_rng;       ///< vehicle placement
+  std::chrono::steady_clock::time_point m_lastProbe; ///< wall time of the last probe
+  std::vector<double> m_secondCost;       ///< wall time of each simulated second (ms)
+};
+
+SatmacBenchmark::SatmacBenchmark ()
+  : m_scenario ("highway"),
+    m_nodes (200),
+    m_simTime (10),
+    m_micro (false),
+    m_iterations (20000),
+    m_rxCulling (false)
+{
+}
+
+void
+SatmacBenchmark::Configure (int argc, char **argv)
+{
+  CommandLine cmd;
+  cmd.AddValue ("scenario", "Vehicle layout: highway or grid", m_scenario);
+  cmd.AddValue ("nodes", "Number of vehicles", m_nodes);
+  cmd.AddValue ("simTime", "Simulated time (s)", m_simTime);
+  cmd.AddValue ("micro", "Run the micro benchmarks instead of a scenario", m_micro);
+  cmd.AddValue ("iterations", "Calls per micro benchmark", m_iterations);
+  cmd.AddValue ("rxCulling", "Skip the receivers 30 dB below the detection threshold", m_rxCulling);
+  cmd.Parse (argc, argv);
+  if (m_scenario != "highway" && m_scenario != "grid")
+    {
+      NS_FATAL_ERROR ("Unknown scenario " << m_scenario);
+    }
+}
+
+void
+SatmacBenchmark::CreateDevices (void)
+{
+  m_vehicles.Create (m_nodes);
+
+  Config::SetDefault ("ns3::YansWifiChannel::RxCulling", BooleanValue (m_rxCulling));
+  Config::SetDefault ("ns3::YansWifiChannel::RxCullingMargin", DoubleValue (30.0));
+  YansWifiChannelHelper tdmaChannel;
+  tdmaChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  tdmaChannel.AddPropagationLoss ("ns3::CniUrbanmicrocellPropagationLossModel",
+                                  "Frequency", DoubleValue (5800e6), "LosEnabled", BooleanValue (true));
+  YansWifiChannelHelper csmaChannel;
+  csmaChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  csmaChannel.AddPropagationLoss ("ns3::CniUrbanmicrocellPropagationLossModel",
+                                  "Frequency", DoubleValue (5900e6), "LosEnabled", BooleanValue (true));
+
+  YansWifiPhyHelper tdmaPhy = YansWifiPhyHelper::Default ();
+  tdmaPhy.SetChannel (tdmaChannel.Create ());
+  YansWifiPhyHelper csmaPhy = YansWifiPhyHelper::Default ();
+  csmaPhy.SetChannel (csmaChannel.Create ());
+  YansWifiPhyHelper *phys[] = { &tdmaPhy, &csmaPhy };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      phys[i]->Set ("TxPowerStart", DoubleValue (6.7));
+      phys[i]->Set ("TxPowerEnd", DoubleValue (6.7));
+      phys[i]->Set ("EnergyDetectionThreshold", DoubleValue (-85));
+    }
+
+  NqosWaveMacHelper mac = NqosWaveMacHelper::Default ();
+  Wifi80211pHelper wifi = Wifi80211pHelper::Default ();
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate12MbpsBW10MHz"),
+                                "ControlMode", StringValue ("OfdmRate12MbpsBW10MHz"),
+                                "NonUnicastMode", StringValue ("OfdmRate12MbpsBW10MHz"));
+  m_tdmaDevices = wifi.Install (tdmaPhy, mac, m_vehicles, 1);
+  m_csmaDevices = wifi.Install (csmaPhy, mac, m_vehicles);
+
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/Tdma/FrameLen", IntegerValue (64));
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/Tdma/AdjFrameLowerBound", IntegerValue (32));
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/Tdma/AdjFrameUpperBound", IntegerValue (128));
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/Tdma/SlotLife", IntegerValue (3));
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/Tdma/C3HThreshold", IntegerValue (3));
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/Tdma/AdjThreshold", IntegerValue (3));
+
+  InternetStackHelper internet;
+  internet.Install (m_vehicles);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  m_interfaces = address.Assign (m_tdmaDevices);
+
+  // the CSMA devices share the address of the TDMA ones, as in the v2x example
+  for (uint32_t i = 0; i < m_vehicles.GetN (); i++)
+    {
+      Ptr<Node> node = m_vehicles.Get (i);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      int32_t ifIndex = ipv4->AddInterface (m_csmaDevices.Get (i));
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (m_interfaces.GetAddress (i), Ipv4Mask ("255.255.0.0")));
+      ipv4->SetMetric (ifIndex, 1);
+      ipv4->SetUp (ifIndex);
+
+      Ptr<MacLayerController> controller = CreateObject<MacLayerController> ();
+      controller->Initialize (DynamicCast<WifiNetDevice> (m_tdmaDevices.Get (i)),
+                              DynamicCast<WifiNetDevice> (m_csmaDevices.Get (i)), node);
+      node->AggregateObject (controller);
+    }
+}
+
+void
+SatmacBenchmark::SetupHighway (void)
+{
+  // three 3.5 m lanes per direction, 4 m median, at 25 to 35 m/s
+  const double length = 5000;
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (m_vehicles);
+  for (uint32_t i = 0; i < m_vehicles.GetN (); i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> model = m_vehicles.Get (i)->GetObject<ConstantVelocityMobilityModel> ();
+      uint32_t lane = m_rng->GetInteger (0, 5);
+      double direction = lane < 3 ? 1 : -1;
+      model->SetPosition (Vector (m_rng->GetValue (0, length), lane * 3.5 + (lane < 3 ? 0 : 4), 1.5));
+      model->SetVelocity (Vector (direction * m_rng->GetValue (25, 35), 0, 0));
+    }
+}
+
+void
+SatmacBenchmark::SetupGrid (void)
+{
+  // 2 km square, streets every 200 m, vehicles going straight at 8 to 15 m/s
+  const double size = 2000;
+  const uint32_t streets = 11;
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (m_vehicles);
+  for (uint32_t i = 0; i < m_vehicles.GetN (); i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> model = m_vehicles.Get (i)->GetObject<ConstantVelocityMobilityModel> ();
+      double street = m_rng->GetInteger (0, streets - 1) * size / (streets - 1);
+      double along = m_rng->GetValue (0, size);
+      double speed = m_rng->GetValue (8, 15) * (m_rng->GetValue () < 0.5 ? -1 : 1);
+      if (m_rng->GetValue () < 0.5)
+        {
+          model->SetPosition (Vector (along, street, 1.5));
+          model->SetVelocity (Vector (speed, 0, 0));
+        }
+      else
+        {
+          model->SetPosition (Vector (street, along, 1.5));
+          model->SetVelocity (Vector (0, speed, 0));
+        }
+    }
+}
+
+void
+SatmacBenchmark::SetupApplications (void)
+{
+  std::vector<double> ranges (1, 160);
+  m_waveBsmHelper.GetWaveBsmStats ()->SetLogging (0);
+  WaveBsmHelper::GetNodesMoving ().resize (m_nodes, 1);
+  m_waveBsmHelper.Install (m_interfaces, Seconds (m_simTime), 200, Seconds (0.1), 10000, ranges, 0, MilliSeconds (10));
+  m_waveBsmHelper.AssignStreams (m_vehicles, 100);
+}
+
+void
+SatmacBenchmark::Probe (void)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+  m_secondCost.push_back (std::chrono::duration<double, std::milli> (now - m_lastProbe).count ());
+  m_lastProbe = now;
+  Simulator::Schedule (Seconds (1), &SatmacBenchmark::Probe, this);
+}
+
+long
+SatmacBenchmark::GetPeakRss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+void
+SatmacBenchmark::Run (void)
+{
+  if (m_micro)
+    {
+      SatmacMicroBenchmark::Run (m_iterations);
+      return;
+    }
+
+  RngSeedManager::SetSeed (13);
+  Simulator::SetScheduler (ObjectFactory ("ns3::CountingScheduler"));
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+
+  std::chrono::steady_clock::time_point setupStart = std::chrono::steady_clock::now ();
+  CreateDevices ();
+  if (m_scenario == "highway")
+    {
+      SetupHighway ();
+    }
+  else
+    {
+      SetupGrid ();
+    }
+  SetupApplications ();
+  std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now ();
+
+  m_lastProbe = runStart;
+  Simulator::Schedule (Seconds (1), &SatmacBenchmark::Probe, this);
+  Simulator::Stop (Seconds (m_simTime));
+  Simulator::Run ();
+  std::chrono::steady_clock::time_point runEnd = std::chrono::steady_clock::now ();
+  uint64_t events = CountingScheduler::GetCount ();
+
+  double setup = std::chrono::duration<double> (runStart - setupStart).count ();
+  double wall = std::chrono::duration<double> (runEnd - runStart).count ();
+  double maxCost = m_secondCost.empty () ? 0 : *std::max_element (m_secondCost.begin (), m_secondCost.end ());
+  std::cout << "scenario=" << m_scenario
+            << " nodes=" << m_nodes
+            << " simTime=" << m_simTime << "s" << std::endl
+            << "setup " << setup << " s, run " << wall << " s" << std::endl
+            << "events " << events << " (" << events / wall << " events/s)" << std::endl
+            << "peak RSS " << GetPeakRss () << " kB" << std::endl
+            << "wall per simulated second " << 1000 * wall / m_simTime << " ms (max " << maxCost << " ms)" << std::endl
+            << "BSMs sent " << m_waveBsmHelper.GetWaveBsmStats ()->GetTxPktCount ()
+            << ", received " << m_waveBsmHelper.GetWaveBsmStats ()->GetRxPktCount () << std::endl;
+  for (uint32_t s = 0; s < m_secondCost.size (); s++)
+    {
+      std::cout << "  t=" << s + 1 << "s " << m_secondCost[s] << " ms" << std::endl;
+    }
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  SatmacBenchmark benchmark;
+  benchmark.Configure (argc, argv);
+  benchmark.Run ();
+  return 0;
+}
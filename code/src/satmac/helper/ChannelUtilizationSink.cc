@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ChannelUtilizationSink.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/ocb-wifi-mac.h"
+#include "ns3/tdma-satmac.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ChannelUtilizationSink");
+
+NS_OBJECT_ENSURE_REGISTERED (ChannelUtilizationSink);
+
+TypeId
+ChannelUtilizationSink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ChannelUtilizationSink")
+    .SetParent<Object> ()
+    .SetGroupName ("Satmac")
+    .AddConstructor<ChannelUtilizationSink> ()
+    .AddAttribute ("FileName",
+                   "The file the records are written to.",
+                   StringValue ("channel_utilization.txt"),
+                   MakeStringAccessor (&ChannelUtilizationSink::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Interval",
+                   "The period covered by one record.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&ChannelUtilizationSink::m_interval),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+ChannelUtilizationSink::ChannelUtilizationSink ()
+  : m_destroyScheduled (false),
+    m_current (-1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ChannelUtilizationSink::~ChannelUtilizationSink ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ChannelUtilizationSink::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_out.close ();
+  Object::DoDispose ();
+}
+
+void
+ChannelUtilizationSink::Install (NetDeviceContainer devices)
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (*i);
+      if (device == 0)
+        {
+          continue;
+        }
+      Ptr<OcbWifiMac> ocb = DynamicCast<OcbWifiMac> (device->GetMac ());
+      if (ocb != 0 && ocb->GetTdmaObject () != 0)
+        {
+          Install (ocb->GetTdmaObject ());
+        }
+    }
+}
+
+void
+ChannelUtilizationSink::Install (Ptr<TdmaSatmac> mac)
+{
+  NS_LOG_FUNCTION (this << mac);
+  mac->TraceConnectWithoutContext ("ChannelUtilization",
+                                   MakeCallback (&ChannelUtilizationSink::Record, this));
+  if (!m_destroyScheduled)
+    {
+      // the simulator holds a reference, so the last record survives the caller
+      Simulator::ScheduleDestroy (&ChannelUtilizationSink::Flush, Ptr<ChannelUtilizationSink> (this));
+      m_destroyScheduled = true;
+    }
+}
+
+void
+ChannelUtilizationSink::Record (uint32_t nodeId, double utilization)
+{
+  int64_t interval = Simulator::Now ().GetTimeStep () / m_interval.GetTimeStep ();
+  if (interval != m_current)
+    {
+      WriteRecord ();
+      m_current = interval;
+    }
+  if (nodeId >= m_samples.size ())
+    {
+      m_samples.resize (nodeId + 1, 0.0);
+      m_reported.resize (nodeId + 1, false);
+    }
+  m_samples[nodeId] = utilization;
+  m_reported[nodeId] = true;
+}
+
+void
+ChannelUtilizationSink::WriteRecord (void)
+{
+  if (m_current < 0)
+    {
+      return;
+    }
+  if (!m_out.is_open ())
+    {
+      m_out.open (m_fileName.c_str (), std::ios::app);
+    }
+  m_out << (m_interval * m_current).GetSeconds ();
+  for (uint32_t i = 0; i < m_samples.size (); i++)
+    {
+      if (m_reported[i])
+        {
+          m_out << ' ' << m_samples[i];
+        }
+      else
+        {
+          m_out << " -";
+        }
+    }
+  m_out << '\n';
+  std::fill (m_reported.begin (), m_reported.end (), false);
+  m_current = -1;
+}
+
+void
+ChannelUtilizationSink::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  WriteRecord ();
+  if (m_out.is_open ())
+    {
+      m_out.flush ();
+    }
+}
+
+} // namespace ns3
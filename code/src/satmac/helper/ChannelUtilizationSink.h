@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CHANNEL_UTILIZATION_SINK_H
+#define CHANNEL_UTILIZATION_SINK_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/net-device-container.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class TdmaSatmac;
+
+/**
+ * \ingroup satmac
+ *
+ * Collects the ChannelUtilization trace of many TdmaSatmac and writes one
+ * line per interval holding the samples of every node:
+ *
+ *   <interval start in s> <utilization of node 0> <utilization of node 1> ...
+ *
+ * with "-" for nodes that reported nothing in the interval. Samples are
+ * buffered until the first sample of a later interval arrives, and the file
+ * is opened once and flushed when the simulator is destroyed.
+ */
+class ChannelUtilizationSink : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ChannelUtilizationSink ();
+  virtual ~ChannelUtilizationSink ();
+
+  /**
+   * Connect the sink to the TdmaSatmac behind each device; devices without
+   * one are skipped.
+   * \param devices the wifi net devices with an OcbWifiMac
+   */
+  void Install (NetDeviceContainer devices);
+  /**
+   * Connect the sink to one mac.
+   * \param mac the mac to collect samples from
+   */
+  void Install (Ptr<TdmaSatmac> mac);
+  /**
+   * Buffer one sample.
+   * \param nodeId the node reporting
+   * \param utilization the utilization it sees
+   */
+  void Record (uint32_t nodeId, double utilization);
+  /**
+   * Write the pending interval, if any, and flush the file.
+   */
+  void Flush (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// write the pending interval
+  void WriteRecord (void);
+
+  std::string m_fileName;              ///< the output file
+  Time m_interval;                     ///< the record interval
+  std::ofstream m_out;                 ///< the output stream, opened on the first record
+  bool m_destroyScheduled;             ///< whether Flush is scheduled at simulator destroy
+  int64_t m_current;                   ///< index of the buffered interval, -1 if none
+  std::vector<double> m_samples;       ///< buffered samples, by node id
+  std::vector<bool> m_reported;        ///< whether the node reported in the buffered interval
+};
+
+} // namespace ns3
+
+#endif /* CHANNEL_UTILIZATION_SINK_H */
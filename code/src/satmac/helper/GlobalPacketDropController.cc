@@ -9,6 +9,10 @@
 NS_LOG_COMPONENT_DEFINE("GlobalPacketDropController");
 
 uint32_t GlobalPacketDropController::dropCount = 0;
+uint32_t GlobalPacketDropController::conflictCount = 0;
+
+// a CSMA send conflicts with the TDMA sends of the slot within this range
+static const double conflictRange = 158.0;
 
 GlobalPacketDropController& GlobalPacketDropController::GetInstance() {
     static GlobalPacketDropController instance;
@@ -20,32 +24,21 @@ GlobalPacketDropController::GlobalPacketDropController() : currentSlotStart(Simu
 
 bool GlobalPacketDropController::CheckIsNeedDrop(Time txTime, Ptr<YansWifiPhy> sender, std::string deviceType,  Ptr<const Packet> pkt) {
     // Check if we have entered a new slot
-    if ((txTime - currentSlotStart).GetMilliSeconds() >= slotDuration.GetMilliSeconds()) {
-        CleanOldEntries(txTime);
-        currentSlotStart = txTime;
-    }
-
+    CleanOldEntries(txTime);
 
-    
     // Register the new packet send before checking for conflicts
-    registeredSends[txTime] = {sender, deviceType};
+    Ptr<MobilityModel> senderMobility = sender->GetMobility();
+    sendGrids[deviceType].Update(registeredSends.size(), senderMobility->GetPosition());
+    registeredSends.push_back({sender, deviceType});
 
     BsmTimeTag apptag;
     // Detect conflict after registering the new packet send
-    if (DetectConflict(sender->GetMobility(), deviceType))
+    if (DetectConflict(senderMobility, deviceType))
      {
+        conflictCount++;
         if(pkt->PeekPacketTag(apptag))
         {
             dropCount++; // Increment the drop count if a conflict is detected
-            for (const auto& entry : registeredSends) {
-                Ptr<Node> node = entry.second.sender->GetDevice()->GetNode();
-                Ptr<MobilityModel> mobilityModel = node->GetObject<MobilityModel>();
-                Vector position = mobilityModel->GetPosition();
-                //NS_LOG_UNCOND("Registered send Node: "<< entry.second.sender->GetDevice()->GetNode()->GetId() <<" - Time: " << entry.first.GetMicroSeconds() << " ms, DeviceType: " << entry.second.deviceType);
-                // std::cout<<"Registered send Node: "<<node->GetId() 
-                //                   <<" - Time: " << entry.first.GetMicroSeconds() << " ms, DeviceType: " << entry.second.deviceType
-                //                   <<" Position: ( "<<position.x<<","<<position.y<<")"<<std::endl;
-            }
             Ptr<Node> senderNode = sender->GetDevice()->GetNode(); 
             Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(senderNode->GetDevice(0));
             Ptr<OcbWifiMac> ocb = DynamicCast<OcbWifiMac>(device->GetMac ());
@@ -65,20 +58,22 @@ bool GlobalPacketDropController::CheckIsNeedDrop(Time txTime, Ptr<YansWifiPhy> s
 
 
 bool GlobalPacketDropController::DetectConflict(Ptr<MobilityModel> senderMobility, std::string deviceType) {
-    for (const auto& entry : registeredSends) {
-        // 首先判断传输是否发生在当前时隙内
-        Time entrySlotStart = entry.first - NanoSeconds(entry.first.GetNanoSeconds() % slotDuration.GetNanoSeconds());
-        Time currentSlotStartTime = Simulator::Now() - NanoSeconds(Simulator::Now().GetNanoSeconds() % slotDuration.GetNanoSeconds());
-
-        if (entrySlotStart != currentSlotStartTime) {
-            continue;  // 如果不在同一个时隙中，直接跳过
-        }
-
+    // only the CSMA sends give way to the TDMA ones
+    if (deviceType != "csma") {
+        return false;
+    }
+    Vector position = senderMobility->GetPosition();
+    for (auto& grid : sendGrids) {
         // Check if the device type is different and the distance is within a specific range (e.g., 158 meters)
-        if (entry.second.deviceType != deviceType) {
-            double distance = senderMobility->GetDistanceFrom(entry.second.sender->GetMobility());
-            double distanceSquare = distance * distance;
-            if (distance < 158.0 && distance > 0 && deviceType == "csma") { // Assuming 158 meters as the communication range
+        if (grid.first == deviceType) {
+            continue;
+        }
+        // senders were filed when they sent during this slot: pad for the little they moved since
+        candidates.clear();
+        grid.second.Query(position, conflictRange + 1.0, candidates);
+        for (uint32_t index : candidates) {
+            double distance = senderMobility->GetDistanceFrom(registeredSends[index].sender->GetMobility());
+            if (distance < conflictRange && distance > 0) {
                 NS_LOG_DEBUG("Conflict detected between different device types within communication range.");
                 return true; // Conflict detected
             }
@@ -95,15 +90,23 @@ void GlobalPacketDropController::HandleConflict(Ptr<WifiPhy> sender) {
 
 void GlobalPacketDropController::CleanOldEntries(Time txTime) {
     // 检查是否进入了新的时隙
-    if ((txTime - currentSlotStart).GetNanoSeconds() >= slotDuration.GetNanoSeconds()) {
+    Time slotStart = txTime - NanoSeconds(txTime.GetNanoSeconds() % slotDuration.GetNanoSeconds());
+    if (slotStart != currentSlotStart) {
         // 进入了新的时隙，删除所有旧记录
         registeredSends.clear();
+        for (auto& grid : sendGrids) {
+            grid.second.Reset(conflictRange);
+        }
 
         // 更新当前时隙的开始时间
-        currentSlotStart = txTime - NanoSeconds(txTime.GetNanoSeconds() % slotDuration.GetNanoSeconds());
+        currentSlotStart = slotStart;
     }
 }
 
 uint32_t GlobalPacketDropController::GetDropCount() {
     return dropCount;
 }
+
+uint32_t GlobalPacketDropController::GetConflictCount() {
+    return conflictCount;
+}
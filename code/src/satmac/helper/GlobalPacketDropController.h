@@ -3,22 +3,32 @@
 #define GLOBAL_PACKET_DROP_CONTROLLER_H
 
 #include <map>
+#include <vector>
 #include <ns3/simulator.h>
 #include <ns3/ptr.h>
 #include <ns3/wifi-phy.h>
 #include <ns3/log.h>
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mobility-model.h"
-#include "ns3/yans-wifi-phy.h"
+#include "ns3/spatial-grid.h"
 
 using namespace ns3;
 
 
+/*
+ * Drops the BSMs a CSMA device sends within range of a TDMA transmission
+ * of the same 1 ms slot. Every send of the current slot is kept, filed
+ * in a spatial grid per device type, so a send is only checked against
+ * the transmitters of the other type around it.
+ */
 class GlobalPacketDropController {
 public:
     static GlobalPacketDropController& GetInstance();
     bool CheckIsNeedDrop(Time txTime, Ptr<YansWifiPhy> sender, std::string deviceType, Ptr<const Packet> pkt);
+    // BSMs dropped because of a conflict
     static uint32_t GetDropCount();
+    // conflicting sends detected, whether dropped or not
+    static uint32_t GetConflictCount();
 
 private:
     struct DeviceInfo {
@@ -27,10 +37,13 @@ private:
         std::string deviceType;
     };
 
-    std::map<Time, DeviceInfo> registeredSends;
+    std::vector<DeviceInfo> registeredSends;           // sends of the current slot
+    std::map<std::string, SpatialGrid> sendGrids;      // indices of registeredSends by device type
+    std::vector<uint32_t> candidates;                  // scratch space for grid queries
     Time currentSlotStart = NanoSeconds(0); 
     Time slotDuration = MilliSeconds(1.0);   
     static uint32_t dropCount;
+    static uint32_t conflictCount;
 
     GlobalPacketDropController();
     GlobalPacketDropController(const GlobalPacketDropController&) = delete;
@@ -2,7 +2,6 @@
 #include "ns3/log.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/ocb-wifi-mac.h"
-#include "AperiodicTag.h"
 #include "ns3/bsm-timetag.h"
 
 NS_LOG_COMPONENT_DEFINE("MacLayerController");
@@ -27,27 +26,72 @@ MacLayerController::GetTypeId (void)
                       "The currently active device (TDMA or CSMA).",
                       PointerValue(),
                       MakePointerAccessor(&MacLayerController::m_currentDevice),
-                      MakePointerChecker<WifiNetDevice> ());
+                      MakePointerChecker<WifiNetDevice> ())
+        .AddAttribute("SwitchPolicy",
+                      "The policy choosing between the TDMA and the CSMA device. "
+                      "If unset, the node uses CSMA during its slot groups and TDMA "
+                      "otherwise, and CheckAndSwitch uses a LoadSwitchPolicy.",
+                      PointerValue(),
+                      MakePointerAccessor(&MacLayerController::m_policy),
+                      MakePointerChecker<MacSwitchPolicy> ())
+        .AddTraceSource("SwitchDecision",
+                        "The load of the node and the device chosen on each check.",
+                        MakeTraceSourceAccessor(&MacLayerController::m_decisionTrace),
+                        "ns3::MacSwitchPolicy::DecisionTracedCallback");
     return tid;
 }
 
 MacLayerController::MacLayerController() : m_tdmaDevice(0), m_csmaDevice(0), m_currentDevice(0) {}
 
+void
+MacLayerController::DoDispose(void)
+{
+    // the queues may outlive the controller
+    if(m_satmac != 0 && m_satmac->GetTdmaQueue() != 0)
+    {
+        m_satmac->GetTdmaQueue()->SetExpiredCallback(MakeNullCallback<bool, Ptr<const Packet>, Time>());
+    }
+    if(m_txop != 0 && m_txop->GetWifiMacQueue() != 0)
+    {
+        m_txop->GetWifiMacQueue()->SetExpiredCallback(MakeNullCallback<bool, Ptr<const WifiMacQueueItem> >());
+    }
+    m_resumeEvent.Cancel();
+    m_satmac = 0;
+    m_txop = 0;
+    Object::DoDispose();
+}
+
 void
 MacLayerController::Initialize(Ptr<WifiNetDevice> tdmaDevice, Ptr<WifiNetDevice> csmaDevice, Ptr<Node> node) {
     m_tdmaDevice = tdmaDevice;
     m_csmaDevice = csmaDevice;
     m_currentDevice = tdmaDevice;  // 默认使用 TDMA 设备
     m_node = node;
+    ShareAperiodicQueue(DynamicCast<OcbWifiMac>(tdmaDevice->GetMac())->GetTdmaObject(),
+                        DynamicCast<OcbWifiMac>(csmaDevice->GetMac())->GetTxopObject());
 //    DisableDevice(csmaDevice);
 //    EnableDevice(tdmaDevice);
 }
 
+void
+MacLayerController::ShareAperiodicQueue(Ptr<TdmaSatmac> satmac, Ptr<Txop> txop)
+{
+    m_satmac = satmac;
+    m_txop = txop;
+    // the TDMA device is current: its mac serves the aperiodic queue
+    m_satmac->SetAperiodicTxop(m_txop);
+    m_satmac->SetAperiodicQueueOwned(true);
+    m_txop->SetAccessSuspended(true);
+    // the stale packets are dropped once they reach the head of a queue
+    m_satmac->GetTdmaQueue()->SetExpiredCallback(MakeCallback(&MacLayerController::IsStalePacket, this));
+    m_txop->GetWifiMacQueue()->SetExpiredCallback(MakeCallback(&MacLayerController::IsStaleItem, this));
+}
+
 void MacLayerController::SwitchToDevice(Ptr<WifiNetDevice> device)
 {
     if (m_currentDevice != device) {
         // 先转移数据包到新设备
-        TransferPackets(m_currentDevice, device);
+        TransferPackets(device);
     	// 禁用当前设备
         DisableDevice(m_currentDevice);
         // 启用新设备
@@ -68,90 +112,74 @@ void MacLayerController::CheckAndSwitch()
     }
 }
 
+void MacLayerController::SlotGroupStarted()
+{
+    if (m_policy == 0) {
+        SwitchToDevice(m_csmaDevice);
+    } else {
+        CheckAndSwitch();
+    }
+}
+
+void MacLayerController::SlotGroupEnded()
+{
+    if (m_policy == 0) {
+        SwitchToDevice(m_tdmaDevice);
+    } else {
+        CheckAndSwitch();
+    }
+}
+
 void MacLayerController::ScheduleDeviceCheck(Time interval)
 {
     Simulator::Schedule(interval, &MacLayerController::CheckAndSwitch, this);
 }
 
-void MacLayerController::TransferPackets(Ptr<WifiNetDevice> fromDevice, Ptr<WifiNetDevice> toDevice)
+// 数据包没有 BSM 时间标签，或者已经超过 100ms
+static bool IsStale(Ptr<const Packet> packet)
 {
-    Ptr<OcbWifiMac> fromMac = DynamicCast<OcbWifiMac>(fromDevice->GetMac());
-    Ptr<OcbWifiMac> toMac = DynamicCast<OcbWifiMac>(toDevice->GetMac());
-	AperiodicTag tag;
+    BsmTimeTag bsmtag;
+    if(!packet->PeekPacketTag(bsmtag))
+    {
+        return true;
+    }
+    uint32_t delta = Simulator::Now().GetMicroSeconds() - bsmtag.getSendingTimeUs();
+    return delta >= 100000;
+}
 
-    if(fromDevice == m_tdmaDevice)
+void MacLayerController::TransferPackets(Ptr<WifiNetDevice> toDevice)
+{
+    // Only the owner of the shared queue changes, whatever the backlog:
+    // the packets keep their order and their queueing time.
+    if(toDevice == m_csmaDevice)
     {
         //tdma to csma
-    	Ptr<TdmaSatmac> satmac = fromMac->GetTdmaObject();
-    	Ptr<TdmaMacQueue> tdma_q = satmac->GetTdmaQueue();
-    	Ptr<Txop> txop = toMac->GetTxopObject();
-    	std::vector<std::pair<Ptr<const Packet>, WifiMacHeader>> tempQueue;
-    	while(!tdma_q->IsEmpty())
-    	{
-    		WifiMacHeader header;
-    		Ptr<const Packet> packet = tdma_q->Dequeue(&header);
-			BsmTimeTag bsmtag;
-			if(packet->PeekPacketTag(bsmtag))
-			{
-				uint32_t delta = Simulator::Now().GetMicroSeconds() - bsmtag.getSendingTimeUs();
-				if(delta < 100000)
-				{
-					if(packet && packet->PeekPacketTag(tag))
-					{
-						//txop->Queue(packet, header);
-		//    			std::cout<<"node : "<<satmac->getNodePtr()->GetId()
-		//    					<<" transfer to csma at "<<Simulator::Now().GetMicroSeconds()<<std::endl;
-						Time ramdomDelay = GetRandomTimeDelay();
-						Simulator::Schedule(ramdomDelay, &OcbWifiMac::Enqueue, toMac, packet, header.GetAddr1());
-						//toMac->Enqueue(packet, header.GetAddr1());
-					}
-					else
-					{
-						tempQueue.push_back(std::make_pair(packet, header));
-					}
-				}
-			}
-    	}
-    	for(auto item : tempQueue)
-    	{
-    		fromMac->Enqueue(item.first, item.second.GetAddr1());
-    		//satmac->Queue(item.first, item.second);
-    	}
+        m_staleBefore = Simulator::Now();
+        m_satmac->SetAperiodicQueueOwned(false);
+        // the csma mac starts to contend after a random delay
+        m_resumeEvent = Simulator::Schedule(GetRandomTimeDelay(), &Txop::SetAccessSuspended, m_txop, false);
     }
     else
     {
-    	//csma to tdma
-    	Ptr<Txop> txop = fromMac->GetTxopObject();
-    	Ptr<TdmaSatmac> satmac = toMac->GetTdmaObject();
-    	Ptr<WifiMacQueue> txop_q = txop->GetWifiMacQueue();
-    	std::vector<Ptr<WifiMacQueueItem>> tempQueue;
-    	while(!txop_q->IsEmpty())
-    	{
-    		Ptr<WifiMacQueueItem> item = txop_q->Dequeue();
-    		NS_ASSERT(item != 0);
-    		Ptr<const Packet> packet = item->GetPacket();
-    		WifiMacHeader header = item->GetHeader();
-    		if(packet && packet->PeekPacketTag(tag))
-    		{
-        		//satmac->Queue(packet, header);
-//    			std::cout<<"node : "<<satmac->getNodePtr()->GetId()
-//    					<<" transfer to tdma at "<<Simulator::Now().GetMicroSeconds()<<std::endl;
-    			toMac->Enqueue(packet, header.GetAddr1());
-    		}
-    		else
-    		{
-    			tempQueue.push_back(item);
-    		}
-    	}
-    	for(auto item : tempQueue)
-    	{
-    		txop_q->Enqueue(item);
-    	}
+        //csma to tdma
+        m_resumeEvent.Cancel();
+        m_txop->SetAccessSuspended(true);
+        m_satmac->SetAperiodicQueueOwned(true);
     }
 
-    NS_LOG_INFO("Transferred packets from current device to new device");
+    NS_LOG_INFO("Handed the aperiodic queue over to the new device");
 }
 
+bool MacLayerController::IsStalePacket(Ptr<const Packet> packet, Time tstamp)
+{
+    // only the packets queued before the last handoff to CSMA were handed over
+    return tstamp < m_staleBefore && IsStale(packet);
+}
+
+bool MacLayerController::IsStaleItem(Ptr<const WifiMacQueueItem> item)
+{
+    return IsStalePacket(item->GetPacket(), item->GetTimeStamp());
+}
 
 // 启用指定设备
 void MacLayerController::EnableDevice(Ptr<WifiNetDevice> device) {
@@ -172,10 +200,32 @@ Ptr<WifiNetDevice> MacLayerController::GetCurrentDevice()
 
 bool MacLayerController::SomeMacLayerCondition()
 {
-    // 自定义逻辑：基于 MAC 层的某些条件进行判断是否需要切换
     // 返回 true 切换到 CSMA，否则切换到 TDMA
-    // 举个例子，这里可以使用信道状态、队列大小等条件
-    return rand() % 2 == 0; // 随机切换作为示例
+    Ptr<MacSwitchPolicy> policy = m_policy;
+    if(policy == 0)
+    {
+        if(m_defaultPolicy == 0)
+        {
+            m_defaultPolicy = CreateObject<LoadSwitchPolicy>();
+        }
+        policy = m_defaultPolicy;
+    }
+    MacSwitchPolicy::Load load = GetLoad();
+    bool useCsma = policy->UseCsma(load, m_currentDevice == m_csmaDevice);
+    m_decisionTrace(load, useCsma);
+    return useCsma;
+}
+
+MacSwitchPolicy::Load MacLayerController::GetLoad()
+{
+    MacSwitchPolicy::Load load;
+    Ptr<WifiMacQueue> txop_q = m_txop->GetWifiMacQueue();
+    load.queueSize = m_satmac->GetTdmaQueue()->GetSize() + txop_q->GetNPackets();
+    Ptr<const WifiMacQueueItem> item = txop_q->Peek();
+    load.headAge = item == 0 ? Time(0) : Simulator::Now() - item->GetTimeStamp();
+    load.channelUtilization = m_satmac->GetChannelUtilization();
+    load.slotGroupRatio = m_satmac->GetAvailableSlotGroupRatio();
+    return load;
 }
 
 Time MacLayerController::GetRandomTimeDelay()
@@ -6,13 +6,20 @@
 #include "ns3/wifi-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/ipv4.h"
+#include "MacSwitchPolicy.h"
 
 
 using namespace ns3;
 
+class MacLayerControllerTestCase;
+class MacLayerControllerSlotGroupTestCase;
 
 class MacLayerController : public Object
 {
+    /// Allow test cases to access private members
+    friend class ::MacLayerControllerTestCase;
+    /// Allow test cases to access private members
+    friend class ::MacLayerControllerSlotGroupTestCase;
 public:
 	static TypeId GetTypeId (void);
     MacLayerController();
@@ -24,6 +31,11 @@ public:
     // 根据 MAC 层条件检查并进行设备切换
     void CheckAndSwitch();
 
+    // TDMA mac 在时隙组的起止处调用：配置了切换策略时由策略决定，
+    // 否则时隙组内使用 CSMA，时隙组结束后回到 TDMA
+    void SlotGroupStarted();
+    void SlotGroupEnded();
+
     // 定期调度检查并切换设备
     void ScheduleDeviceCheck(Time interval);
 
@@ -53,12 +65,36 @@ private:
     Ptr<WifiNetDevice> m_currentDevice;
     Ptr<Node> m_node;
 
-    // 从一个设备的队列中取出数据包并将其转移到另一个设备
-    void TransferPackets(Ptr<WifiNetDevice> fromDevice, Ptr<WifiNetDevice> toDevice);
+    // The aperiodic packets of both devices stay in the queue of the CSMA
+    // txop, which the TDMA mac serves while the TDMA device is current.
+    Ptr<TdmaSatmac> m_satmac;
+    Ptr<Txop> m_txop;
+    EventId m_resumeEvent;
+
+    virtual void DoDispose(void);
+
+    // 让 TDMA mac 和 CSMA txop 共用 txop 的队列，由 TDMA mac 先服务
+    void ShareAperiodicQueue(Ptr<TdmaSatmac> satmac, Ptr<Txop> txop);
+
+    // 把非周期数据包的队列交给将要启用的设备
+    void TransferPackets(Ptr<WifiNetDevice> toDevice);
 
-    // 判断是否满足切换设备的条件（自定义条件）
+    // 最近一次切换到 CSMA 之前入队、且没有 BSM 时间标签或超过 100ms 的数据包，
+    // 在到达 TDMA 队列或共享队列的队头时被丢弃
+    bool IsStalePacket(Ptr<const Packet> packet, Time tstamp);
+    bool IsStaleItem(Ptr<const WifiMacQueueItem> item);
+    Time m_staleBefore;
+
+    // 判断是否满足切换设备的条件：由切换策略根据当前负载决定
     bool SomeMacLayerCondition();
 
+    // 节点当前的负载
+    MacSwitchPolicy::Load GetLoad();
+
+    Ptr<MacSwitchPolicy> m_policy;
+    Ptr<MacSwitchPolicy> m_defaultPolicy;  // CheckAndSwitch 在未配置切换策略时使用
+    TracedCallback<const MacSwitchPolicy::Load &, bool> m_decisionTrace;
+
     Time GetRandomTimeDelay();
 
 };
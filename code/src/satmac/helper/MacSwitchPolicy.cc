@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "MacSwitchPolicy.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MacSwitchPolicy");
+
+NS_OBJECT_ENSURE_REGISTERED (MacSwitchPolicy);
+NS_OBJECT_ENSURE_REGISTERED (LoadSwitchPolicy);
+
+TypeId
+MacSwitchPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MacSwitchPolicy")
+    .SetParent<Object> ()
+    .SetGroupName ("Satmac")
+  ;
+  return tid;
+}
+
+TypeId
+LoadSwitchPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LoadSwitchPolicy")
+    .SetParent<MacSwitchPolicy> ()
+    .SetGroupName ("Satmac")
+    .AddConstructor<LoadSwitchPolicy> ()
+    .AddAttribute ("UtilizationThreshold",
+                   "Use CSMA once the TDMA channel utilization reaches this value.",
+                   DoubleValue (0.8),
+                   MakeDoubleAccessor (&LoadSwitchPolicy::m_utilizationThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("QueueThreshold",
+                   "Use CSMA once this many packets are waiting.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&LoadSwitchPolicy::m_queueThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("AgeThreshold",
+                   "Use CSMA once the oldest aperiodic packet has waited this long.",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&LoadSwitchPolicy::m_ageThreshold),
+                   MakeTimeChecker ())
+    .AddAttribute ("SlotGroupThreshold",
+                   "Use CSMA once the available slot group ratio falls to this value.",
+                   DoubleValue (0.25),
+                   MakeDoubleAccessor (&LoadSwitchPolicy::m_slotGroupThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Hysteresis",
+                   "The share by which every signal must clear its threshold "
+                   "before moving back to TDMA.",
+                   DoubleValue (0.2),
+                   MakeDoubleAccessor (&LoadSwitchPolicy::m_hysteresis),
+                   MakeDoubleChecker<double> (0, 1))
+  ;
+  return tid;
+}
+
+LoadSwitchPolicy::LoadSwitchPolicy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LoadSwitchPolicy::~LoadSwitchPolicy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+LoadSwitchPolicy::IsCongested (const Load &load, double margin) const
+{
+  return load.channelUtilization >= m_utilizationThreshold * (1 - margin)
+         || load.queueSize >= m_queueThreshold * (1 - margin)
+         || load.headAge.GetSeconds () >= m_ageThreshold.GetSeconds () * (1 - margin)
+         || load.slotGroupRatio <= m_slotGroupThreshold * (1 + margin);
+}
+
+bool
+LoadSwitchPolicy::UseCsma (const Load &load, bool usingCsma)
+{
+  NS_LOG_FUNCTION (this << load.queueSize << load.headAge << load.channelUtilization
+                        << load.slotGroupRatio << usingCsma);
+  return IsCongested (load, usingCsma ? m_hysteresis : 0);
+}
+
+} // namespace ns3
@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef MAC_SWITCH_POLICY_H
+#define MAC_SWITCH_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup satmac
+ *
+ * Decides whether a node sends its aperiodic packets with its CSMA device
+ * or with its TDMA device. MacLayerController asks its policy on every
+ * device check, passing the current load of the node.
+ */
+class MacSwitchPolicy : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /// The load of a node, as seen by its TDMA mac
+  struct Load
+  {
+    uint32_t queueSize;          ///< packets waiting in the TDMA and the aperiodic queues
+    Time headAge;                ///< time the oldest aperiodic packet has been waiting
+    double channelUtilization;   ///< share of the frame in use
+    double slotGroupRatio;       ///< share of the slot groups still available
+  };
+
+  /**
+   * TracedCallback signature for switching decisions.
+   * \param load the load the decision was made on
+   * \param useCsma whether the CSMA device was chosen
+   */
+  typedef void (* DecisionTracedCallback)(const Load &load, bool useCsma);
+
+  /**
+   * \param load the current load of the node
+   * \param usingCsma whether the node currently uses its CSMA device
+   * \return true to use the CSMA device, false to use the TDMA device
+   */
+  virtual bool UseCsma (const Load &load, bool usingCsma) = 0;
+};
+
+/**
+ * \ingroup satmac
+ *
+ * Moves to CSMA when the TDMA side is congested: the channel utilization,
+ * the queue size or the age of the oldest aperiodic packet reaches its
+ * threshold, or the available slot group ratio falls to its threshold.
+ * It only moves back once every signal has cleared its threshold by the
+ * Hysteresis margin, so that a load hovering around a threshold does not
+ * flip the device on every check.
+ */
+class LoadSwitchPolicy : public MacSwitchPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LoadSwitchPolicy ();
+  virtual ~LoadSwitchPolicy ();
+
+  virtual bool UseCsma (const Load &load, bool usingCsma);
+
+private:
+  /**
+   * \param load the load of the node
+   * \param margin the share by which the thresholds are tightened
+   * \return whether the load reaches one of the thresholds
+   */
+  bool IsCongested (const Load &load, double margin) const;
+
+  double m_utilizationThreshold;  ///< channel utilization threshold
+  uint32_t m_queueThreshold;      ///< queue size threshold
+  Time m_ageThreshold;            ///< head of line age threshold
+  double m_slotGroupThreshold;    ///< available slot group ratio threshold
+  double m_hysteresis;            ///< margin to clear before moving back to TDMA
+};
+
+} // namespace ns3
+
+#endif /* MAC_SWITCH_POLICY_H */
@@ -1,6 +1,10 @@
 #ifndef SATMACCOMMON_H
 #define SATMACCOMMON_H
 
+#include <algorithm>
+#include <vector>
+#include "ns3/assert.h"
+
 //#define PRINT_SLOT_STATUS 1
 
 //#define FRAMEADJ_CUT_RATIO_THS 0.4
@@ -64,33 +68,35 @@ class Frame_info{
 public:
 	int sti;	//
 	int index;	//
-	int remain_time;
+	long long expire_time;	//fade clock of Frame_info_list at which the fi expires
 	int frame_len;
+	int capacity;	//number of slot_tag allocated in slot_describe
 	int valid_time;
 	int recv_slot;
 	int type;	//type=0 FI, type=1 短包
 	slot_tag *slot_describe;
-	Frame_info *next_fi;
 
 	Frame_info(){
 		sti = 0;
 		index = 0;
-		remain_time = 0;
+		expire_time = 0;
 		valid_time = 0;
 		recv_slot = -1;
 		frame_len=0;
+		capacity = 0;
 		type = -1;
+		slot_describe = NULL;
 	}
 	Frame_info(int framelen){
 		NS_ASSERT( framelen >= 0 );
 		sti = 0;
 		index = 0;
-		remain_time = 0;
+		expire_time = 0;
 		valid_time = 0;
 		recv_slot = -1;
 		type = -1;
 		frame_len = framelen;
-		//next_fi = NULL;
+		capacity = framelen;
 		slot_describe = new slot_tag[frame_len];
 		NS_ASSERT(slot_describe != NULL);
 	}
@@ -99,9 +105,146 @@ public:
 			delete[] slot_describe;
 			slot_describe = NULL;
 		}
-		next_fi = NULL;
 	}
 
+	/*
+	 * Reinitialize the fi for a frame of framelen slots. The slot_tag
+	 * array is only reallocated when it is too small; returns true if so.
+	 */
+	bool reset(int framelen){
+		NS_ASSERT( framelen >= 0 );
+		bool allocated = false;
+		if (framelen > capacity) {
+			delete[] slot_describe;
+			slot_describe = new slot_tag[framelen];
+			capacity = framelen;
+			allocated = true;
+		} else {
+			std::fill(slot_describe, slot_describe + framelen, slot_tag());
+		}
+		sti = 0;
+		index = 0;
+		expire_time = 0;
+		valid_time = 0;
+		recv_slot = -1;
+		type = -1;
+		frame_len = framelen;
+		return allocated;
+	}
+
+private:
+	Frame_info(const Frame_info &);
+	Frame_info &operator = (const Frame_info &);
+};
+
+/*
+ * The FIs received during the last frame, in reception order.
+ *
+ * Records live in a ring whose Frame_info objects and slot_tag arrays are
+ * recycled, so once the ring has grown to the number of FIs alive in a
+ * frame, append and fade allocate nothing. fade advances a clock instead
+ * of decrementing every record; a record is alive until the clock reaches
+ * its expire_time. Expired records are dropped from the head, and the few
+ * that expire behind a longer-lived head (after the frame length shrank)
+ * are skipped by is_alive until they reach the head.
+ */
+class Frame_info_list{
+public:
+	Frame_info_list(){
+		head_ = 0;
+		count_ = 0;
+		clock_ = 0;
+		alloc_count_ = 0;
+	}
+	~Frame_info_list(){
+		for (size_t i = 0; i < records_.size(); i++)
+			delete records_[i];
+	}
+
+	/* make room for records fis of framelen slots without further allocation */
+	void reserve(int records, int framelen){
+		grow(records);
+		for (size_t i = 0; i < records_.size(); i++) {
+			if (records_[i]->capacity < framelen) {
+				records_[i]->reset(framelen);
+				alloc_count_++;
+			}
+		}
+	}
+
+	/* append a fi of framelen slots, alive for the next valid_time fades */
+	Frame_info *append(int framelen, int valid_time){
+		if (count_ == (int)records_.size())
+			grow(count_ == 0 ? 4 : 2 * count_);
+		Frame_info *fi = records_[(head_ + count_) % records_.size()];
+		if (fi->reset(framelen))
+			alloc_count_++;
+		fi->valid_time = valid_time;
+		fi->expire_time = clock_ + valid_time;
+		count_++;
+		return fi;
+	}
+
+	/* age every fi by time; time == 0 drops every fi */
+	void fade(int time){
+		if (time == 0) {
+			clear();
+			return;
+		}
+		clock_ += time;
+		while (count_ > 0 && records_[head_]->expire_time <= clock_) {
+			head_ = (head_ + 1) % records_.size();
+			count_--;
+		}
+	}
+
+	void clear(){
+		head_ = 0;
+		count_ = 0;
+	}
+
+	/* number of records held, including expired ones behind the head */
+	int size() const {
+		return count_;
+	}
+
+	Frame_info *at(int i) const {
+		return records_[(head_ + i) % records_.size()];
+	}
+
+	bool is_alive(const Frame_info *fi) const {
+		return fi->expire_time > clock_;
+	}
+
+	/* number of heap allocations made so far for records and slot arrays */
+	long long get_alloc_count() const {
+		return alloc_count_;
+	}
+
+private:
+	void grow(int records){
+		if (records <= (int)records_.size())
+			return;
+		std::vector<Frame_info *> grown;
+		grown.reserve(records);
+		for (int i = 0; i < (int)records_.size(); i++)
+			grown.push_back(records_[(head_ + i) % records_.size()]);
+		while ((int)grown.size() < records) {
+			grown.push_back(new Frame_info());
+			alloc_count_++;
+		}
+		records_.swap(grown);
+		head_ = 0;
+	}
+
+	std::vector<Frame_info *> records_;
+	int head_;
+	int count_;
+	long long clock_;
+	long long alloc_count_;
+
+	Frame_info_list(const Frame_info_list &);
+	Frame_info_list &operator = (const Frame_info_list &);
 };
 
 struct slot_group_info{
@@ -92,68 +92,50 @@ operator<< (std::ostream & os, TypeHeader const & h)
 // FI
 //-----------------------------------------------------------------------------
 FiHeader::FiHeader ()
+	:m_framelength(0), m_global_sti(0), m_fi_size(0), m_received(false),
+	 m_read_bytes(0), m_acc(0), m_acc_bits(0), m_acc_pos(0)
 {
 }
 
 NS_OBJECT_ENSURE_REGISTERED (FiHeader);
 
 FiHeader::FiHeader (uint32_t framelength, int global_sti, slot_tag *fi_local)
-	:m_framelength(framelength), m_global_sti(global_sti)
+	:m_framelength(framelength), m_global_sti(global_sti), m_received(false),
+	 m_read_bytes(0), m_acc(0), m_acc_bits(0), m_acc_pos(0)
 {
-	uint32_t  field_length;
-	uint8_t buffer;
-	int bit_pos=7, byte_pos=0;
+	const uint32_t count_max = (1u << BIT_LENGTH_COUNT) - 1;
+	uint64_t acc = 0;
+	int acc_bits = 0;
+	uint8_t *out;
+	int frame_exp = 0;
+
 	m_fi_size = (BIT_LENGTH_SLOT_TAG * m_framelength + BIT_LENGTH_STI + BIT_LENGTH_FRAMELEN)/8;
 	if(((BIT_LENGTH_SLOT_TAG * m_framelength + BIT_LENGTH_STI + BIT_LENGTH_FRAMELEN) %8) != 0 ){
 	  m_fi_size++;
 	}
+	m_buffer.assign(m_fi_size, 0);
+	out = &m_buffer[0];
+
+	//frame len 4 bits, floor(log2(framelength))
+	while ((2 << frame_exp) <= m_framelength)
+		frame_exp++;
+	put_bits(acc, acc_bits, out, (uint32_t)m_global_sti, BIT_LENGTH_STI);
+	put_bits(acc, acc_bits, out, frame_exp, BIT_LENGTH_FRAMELEN);
 
-	m_buffer = new unsigned char[m_fi_size];
-	memset(m_buffer, 0, m_fi_size);
-	
-	field_length = BIT_LENGTH_STI/8 ;
-	
-	if ( BIT_LENGTH_STI%8 != 0 ){
-		buffer = (unsigned char)(m_global_sti>>( 8* field_length ));
-		setvalue(buffer, BIT_LENGTH_STI%8, m_buffer, byte_pos, bit_pos);
-	}
-	
-	for(int j = field_length-1 ; j >= 0 ; j-- ){
-		buffer = (unsigned char)(m_global_sti>>(8*j));
-		setvalue(buffer, 8, m_buffer, byte_pos, bit_pos);
-	}
-	
-	//frame len 4 bits
-	buffer = log(m_framelength)/log(2);
-	setvalue(buffer, BIT_LENGTH_FRAMELEN, m_buffer, byte_pos, bit_pos);
-	
 	for(int i=0; i< m_framelength; i++){
-		buffer = fi_local[i].busy;
-		setvalue(buffer, BIT_LENGTH_BUSY, m_buffer, byte_pos, bit_pos);
-		//sti
-		field_length = BIT_LENGTH_STI/8 ;
-		if ( BIT_LENGTH_STI%8 != 0 ){
-			buffer= (unsigned char)(fi_local[i].sti>>( 8* field_length ));
-			setvalue(buffer, BIT_LENGTH_STI%8, m_buffer, byte_pos, bit_pos);
-		}
-		for(int j = field_length-1 ; j >= 0 ; j-- ){
-			buffer =(unsigned char)(fi_local[i].sti>>(8*j));
-			setvalue(buffer, 8, m_buffer, byte_pos, bit_pos);
-		}
-		//count
-		unsigned char tmpbitmask = 0xff;
-		tmpbitmask = ~((tmpbitmask >> BIT_LENGTH_COUNT)<<BIT_LENGTH_COUNT);
-		if (fi_local[i].count_2hop > tmpbitmask)
-			buffer = tmpbitmask;
+		uint32_t count;
+		if (fi_local[i].count_2hop > (int)count_max)
+			count = count_max;
 		else
-			buffer = (unsigned char)fi_local[i].count_2hop;
-		setvalue(buffer, BIT_LENGTH_COUNT, m_buffer, byte_pos, bit_pos);
-	
-		//PSF
-		buffer = fi_local[i].psf;
-		if (BIT_LENGTH_PSF > 0)
-			setvalue(buffer, BIT_LENGTH_PSF, m_buffer, byte_pos, bit_pos);
-	
+			count = (uint8_t)fi_local[i].count_2hop;
+
+		//busy, sti, count and psf packed into one tag
+		uint32_t tag = (uint8_t)fi_local[i].busy & ((1u << BIT_LENGTH_BUSY) - 1);
+		tag = (tag << BIT_LENGTH_STI) | ((uint32_t)fi_local[i].sti & ((1u << BIT_LENGTH_STI) - 1));
+		tag = (tag << BIT_LENGTH_COUNT) | (count & count_max);
+		tag = (tag << BIT_LENGTH_PSF) | ((uint8_t)fi_local[i].psf & ((1u << BIT_LENGTH_PSF) - 1));
+		put_bits(acc, acc_bits, out, tag, BIT_LENGTH_SLOT_TAG);
+
 		//clear Count_2hop/3hop
 		if (fi_local[i].sti == m_global_sti) {
 			fi_local[i].count_2hop = 1;
@@ -164,7 +146,26 @@ FiHeader::FiHeader (uint32_t framelength, int global_sti, slot_tag *fi_local)
 			fi_local[i].count_3hop = 0;
 		}
 	}
+	//zero padding of the last byte
+	if (acc_bits > 0)
+		put_bits(acc, acc_bits, out, 0, 8 - acc_bits);
+	NS_ASSERT(out == &m_buffer[0] + m_fi_size);
+}
 
+/*
+ * append the low bit_len bits of value, msb first, flushing whole bytes to out.
+ */
+void FiHeader::put_bits(uint64_t &acc, int &acc_bits, uint8_t *&out, uint32_t value, int bit_len){
+	NS_ASSERT(bit_len >= 0 && bit_len <= 32);
+	if (bit_len == 0)
+		return;
+	acc = (acc << bit_len) | (value & (0xffffffffu >> (32 - bit_len)));
+	acc_bits += bit_len;
+	while (acc_bits >= 8) {
+		acc_bits -= 8;
+		*out++ = (uint8_t)(acc >> acc_bits);
+	}
+	acc &= (((uint64_t)1) << acc_bits) - 1;
 }
 
 TypeId
@@ -190,156 +191,98 @@ FiHeader::GetSerializedSize () const
 }
 
 uint8_t * FiHeader::GetBuffer() const {
-  return m_buffer;
+  return m_buffer.empty() ? NULL : const_cast<uint8_t *>(&m_buffer[0]);
 };
 
+/*
+ * or the low bit_len (at most 8) bits of value into buffer, msb first,
+ * starting at bit bit_pos (7 is the msb) of byte byte_pos.
+ */
 void FiHeader::setvalue(unsigned char value,
 		int bit_len, unsigned char* buffer, int &byte_pos, int &bit_pos){
-
-	int shift=0,field_length=0,mode=0,i=0,bit_remain;
-	int index;
-
-	index = byte_pos;
-	field_length = bit_len;
-	bit_remain = bit_pos+1;
-
-	NS_ASSERT(bit_pos >= 0);
-	NS_ASSERT(bit_len >= 1);
-
-	while(true){
-
-		mode = 0;
-
-		if(bit_remain==0){
-			bit_remain=8;
-			index++;
-		}
-
-		if(field_length<=0)	break;
-
-		if (bit_remain >= field_length){
-			shift = bit_remain-field_length;
-			for(i=0; i<field_length; i++){
-				mode += pow(2,i);
-			}
-			bit_remain = shift;
-			field_length=0;
-		}
-		else{
-			shift = 0;
-			for(i=0; i<bit_remain; i++){
-				mode += pow(2,i);
-			}
-			field_length -= bit_remain;
-			bit_remain = 0;
-		}
-		buffer[index] |= (( value >> field_length ) & mode ) << shift;
+	NS_ASSERT(bit_pos >= 0 && bit_pos <= 7);
+	NS_ASSERT(bit_len >= 1 && bit_len <= 8);
+
+	int bit_remain = bit_pos + 1;
+	unsigned int bits = value & (0xffu >> (8 - bit_len));
+	if (bit_remain >= bit_len) {
+		buffer[byte_pos] |= bits << (bit_remain - bit_len);
+		bit_remain -= bit_len;
+	} else {
+		buffer[byte_pos] |= bits >> (bit_len - bit_remain);
+		byte_pos++;
+		bit_remain = 8 - (bit_len - bit_remain);
+		buffer[byte_pos] |= (uint8_t)(bits << bit_remain);
 	}
+	if (bit_remain == 0) {
+		bit_remain = 8;
+		byte_pos++;
+	}
+	bit_pos = bit_remain - 1;
+}
 
-	byte_pos=index;
-	bit_pos = bit_remain-1;
+uint8_t FiHeader::next_byte(){
+	m_read_bytes++;
+	if (m_received) {
+		NS_ASSERT(m_read_bytes <= (uint32_t)m_fi_size);
+		return m_cursor.ReadU8();
+	}
+	NS_ASSERT(m_read_bytes <= m_buffer.size());
+	return m_buffer[m_read_bytes - 1];
 }
 
+/*
+ * read length (at most 32) bits, msb first, starting at bit bit_pos (7 is the
+ * msb) of byte byte_pos, and advance the position past them. Sequential reads
+ * are served from a 64 bit accumulator refilled a byte at a time.
+ */
 unsigned long FiHeader::decode_value(unsigned int &byte_pos,unsigned int &bit_pos, unsigned int length){
-	unsigned long mode = 0;
-	unsigned long value=0;
-	unsigned int i=0,j=0,field_length;
-	unsigned int bit_remain,index,shift;
-
+	NS_ASSERT(bit_pos <= 7);
+	NS_ASSERT(length <= 32);
 	if (length == 0) return 0;
 
-	index = byte_pos;
-	bit_remain = bit_pos+1;
-	//field_length = length;
-
-	field_length = length % 8;
-	if(field_length !=0){//  should first read the remaining field_length bits
-		while(field_length>0){
-			if (bit_remain >= field_length){
-				mode = 0;
-				shift = bit_remain-field_length;
-				for(j=0; j< field_length ; j++){
-					mode += pow(2,j);
-				}
-				value =  value | ((m_buffer[index] >> shift ) & mode);
-				bit_remain -= field_length;
-				if(bit_remain == 0){
-					bit_remain =8;
-					index++;
-				}
-				field_length = 0;
-			}
-			else{
-				mode=0;
-				shift = 0;
-				for(j=0; j< bit_remain ; j++){
-					mode += pow(2,j);
-				}
-				value = value | (( m_buffer[index] >> shift ) & mode ) << (8-bit_remain);
-				field_length = field_length-bit_remain;
-				bit_remain=8;
-				index++;
-			}
+	uint32_t pos = byte_pos * 8 + (7 - bit_pos);
+	if (pos != m_acc_pos) {
+		//random access: reload the accumulator from the byte holding pos
+		if (m_received) {
+			m_cursor = m_start;
+			m_cursor.Next(byte_pos);
 		}
+		m_read_bytes = byte_pos;
+		m_acc = next_byte();
+		m_acc_bits = bit_pos + 1;
+		m_acc &= (((uint64_t)1) << m_acc_bits) - 1;
+		m_acc_pos = pos;
 	}
-	for(i=0 ; i< length/8 ; i++){
-		field_length=8;
-		value = value << 8;
-		while(field_length>0){
-			if (bit_remain >= field_length){
-				mode = 0;
-				shift = bit_remain-field_length;
-				for(j=0; j< field_length ; j++){
-					mode += pow(2,j);
-				}
-				value = value | ((m_buffer[index] >> shift ) & mode);
-				bit_remain -= field_length;
-				if(bit_remain == 0){
-					bit_remain =8;
-					index++;
-				}
-				field_length = 0;
-			}
-			else{
-				mode=0;
-				shift = 0;
-				for(j=0; j< bit_remain ; j++){
-					mode += pow(2,j);
-				}
-				value = value | (( m_buffer[index] >> shift ) & mode ) << (8-bit_remain);
-				field_length = field_length-bit_remain;
-				bit_remain=8;
-				index++;
-			}
-		}
+	while (m_acc_bits < (int)length) {
+		m_acc = (m_acc << 8) | next_byte();
+		m_acc_bits += 8;
 	}
+	m_acc_bits -= length;
+	unsigned long value = (unsigned long)((m_acc >> m_acc_bits) & (0xffffffffu >> (32 - length)));
+	m_acc &= (((uint64_t)1) << m_acc_bits) - 1;
+	m_acc_pos += length;
 
-	byte_pos = index;
-	bit_pos = bit_remain-1;
-
+	byte_pos = m_acc_pos / 8;
+	bit_pos = 7 - m_acc_pos % 8;
 	return value;
 }
 
 void FiHeader::decode_slot_tag(unsigned int &byte_pos,unsigned int &bit_pos, int slot_pos, Frame_info *fi){
-	unsigned long value=0;
-
 	slot_tag* fi_local=fi->slot_describe;
-	NS_ASSERT(bit_pos >= 0);
-	//busy
-	value=this->decode_value(byte_pos,bit_pos,BIT_LENGTH_BUSY);
-	fi_local[slot_pos].busy = (unsigned char)value;
-
-	//sti
-	value=this->decode_value(byte_pos,bit_pos,BIT_LENGTH_STI);
-	fi_local[slot_pos].sti = (unsigned int)value;
-
-	//count
-	value=this->decode_value(byte_pos,bit_pos,BIT_LENGTH_COUNT);
-	fi_local[slot_pos].count_2hop = (unsigned int)value;
+	unsigned long tag = this->decode_value(byte_pos,bit_pos,BIT_LENGTH_SLOT_TAG);
 
 	//psf
-	value=this->decode_value(byte_pos,bit_pos,BIT_LENGTH_PSF);
-	fi_local[slot_pos].psf = (unsigned int)value;
+	fi_local[slot_pos].psf = (unsigned int)(tag & ((1u << BIT_LENGTH_PSF) - 1));
+	tag >>= BIT_LENGTH_PSF;
+	//count
+	fi_local[slot_pos].count_2hop = (unsigned int)(tag & ((1u << BIT_LENGTH_COUNT) - 1));
+	tag >>= BIT_LENGTH_COUNT;
+	//sti
+	fi_local[slot_pos].sti = (unsigned int)(tag & ((1u << BIT_LENGTH_STI) - 1));
+	tag >>= BIT_LENGTH_STI;
+	//busy
+	fi_local[slot_pos].busy = (unsigned char)(tag & ((1u << BIT_LENGTH_BUSY) - 1));
 
 	return;
 }
@@ -348,19 +291,25 @@ void FiHeader::decode_slot_tag(unsigned int &byte_pos,unsigned int &bit_pos, int
 void
 FiHeader::Serialize (Buffer::Iterator i) const
 {
-  i.Write(m_buffer, m_fi_size);
+  NS_ASSERT(!m_received);
+  i.Write(GetBuffer(), m_fi_size);
 }
 
 uint32_t
 FiHeader::Deserialize (Buffer::Iterator start)
 {
-  Buffer::Iterator i = start;
-  int buf_size = i.GetSize();
-  m_buffer = new unsigned char [buf_size];
-  i.Read(m_buffer, buf_size);
-  
-  uint32_t dist = i.GetDistanceFrom (start);
-  return dist;
+  //the FI spans the rest of the packet; it is decoded in place on demand
+  m_start = start;
+  m_received = true;
+  m_buffer.clear();
+  m_fi_size = start.GetSize();
+  m_read_bytes = 0;
+  m_acc = 0;
+  m_acc_bits = 0;
+  m_acc_pos = 0;
+  m_cursor = start;
+
+  return m_fi_size;
 }
 
 void
@@ -6,6 +6,7 @@
 #include "ns3/enum.h"
 #include "ns3/ipv4-address.h"
 #include <map>
+#include <vector>
 #include "ns3/nstime.h"
 #include "ns3/vector.h"
 #include "satmac-common.h"
@@ -55,16 +56,22 @@ private:
 
 std::ostream & operator<< (std::ostream & os, TypeHeader const & h);
 
+/*
+ * The FI of a node: its 12 bit sti, the log2 of its frame length in 4 bits,
+ * then one BIT_LENGTH_SLOT_TAG bit tag (busy, sti, count, psf) per slot,
+ * all fields msb first and the last byte zero padded.
+ *
+ * A header built from a slot table encodes it once into its own buffer. A
+ * header filled by Deserialize keeps no copy: decode_value and
+ * decode_slot_tag read straight from the buffer of the packet it was removed
+ * from, so that packet must stay alive and unmodified while decoding.
+ */
 class FiHeader : public Header
 {
 public:
   /// c-tor
   FiHeader ();
   FiHeader (uint32_t framelength, int global_sti, slot_tag *fi_local);
-  ~FiHeader() {
-  	delete m_buffer;
-  	m_buffer = NULL;
-  }
   ///\name Header serialization/deserialization
   //\{
   static TypeId GetTypeId ();
@@ -87,11 +94,21 @@ public:
 
   bool operator== (FiHeader const & o) const;
 private:
+  static void put_bits(uint64_t &acc, int &acc_bits, uint8_t *&out, uint32_t value, int bit_len);
+  uint8_t next_byte();
+
   int m_framelength;
   int m_global_sti;
-  uint8_t *m_buffer;
+  std::vector<uint8_t> m_buffer;
   int m_fi_size;
 
+  Buffer::Iterator m_start;	// start of the FI in the received packet
+  bool m_received;
+  Buffer::Iterator m_cursor;	// next byte to load into m_acc
+  uint32_t m_read_bytes;	// bytes loaded into m_acc so far
+  uint64_t m_acc;	// the low m_acc_bits bits are the next bits to decode
+  int m_acc_bits;
+  uint32_t m_acc_pos;	// absolute bit position of the next bit to decode
 };
 
 std::ostream & operator<< (std::ostream & os, FiHeader const &);
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "satmac-slot-clock.h"
+#include "tdma-satmac.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("SatmacSlotClock");
+
+namespace ns3 {
+
+SatmacSlotClock::ClockMap SatmacSlotClock::m_clocks;
+
+Ptr<SatmacSlotClock>
+SatmacSlotClock::Get (Time slotTime, Time firstBoundary)
+{
+  NS_ASSERT (slotTime.IsStrictlyPositive ());
+  Time phase = TimeStep (firstBoundary.GetTimeStep () % slotTime.GetTimeStep ());
+  std::pair<int64_t, int64_t> key (slotTime.GetTimeStep (), phase.GetTimeStep ());
+  ClockMap::iterator it = m_clocks.find (key);
+  if (it != m_clocks.end ())
+    {
+      return it->second;
+    }
+  if (m_clocks.empty ())
+    {
+      Simulator::ScheduleDestroy (&SatmacSlotClock::DestroyAll);
+    }
+  Ptr<SatmacSlotClock> clock = Ptr<SatmacSlotClock> (new SatmacSlotClock (slotTime, phase), false);
+  m_clocks[key] = clock;
+  return clock;
+}
+
+void
+SatmacSlotClock::DestroyAll (void)
+{
+  for (ClockMap::iterator it = m_clocks.begin (); it != m_clocks.end (); ++it)
+    {
+      it->second->m_event.Cancel ();
+    }
+  m_clocks.clear ();
+}
+
+SatmacSlotClock::SatmacSlotClock (Time slotTime, Time phase)
+  : m_slotTime (slotTime),
+    m_phase (phase),
+    m_boundary (0),
+    m_live (0)
+{
+}
+
+uint32_t
+SatmacSlotClock::Register (TdmaSatmac *mac, Time firstBoundary)
+{
+  NS_LOG_FUNCTION (this << mac << firstBoundary);
+  NS_ASSERT (firstBoundary > Simulator::Now ());
+  uint64_t first = GetBoundaryAtOrAfter (firstBoundary);
+  uint32_t id = m_macs.size ();
+  m_macs.push_back (mac);
+  m_live++;
+  if (!m_event.IsRunning ())
+    {
+      m_boundary = first - 1;
+      m_event = Simulator::Schedule (firstBoundary - Simulator::Now (), &SatmacSlotClock::Tick, this);
+    }
+  WakeAt (id, first);
+  return id;
+}
+
+void
+SatmacSlotClock::Unregister (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  NS_ASSERT (id < m_macs.size () && m_macs[id] != 0);
+  m_macs[id] = 0;
+  m_live--;
+}
+
+void
+SatmacSlotClock::WakeAt (uint32_t id, uint64_t boundary)
+{
+  NS_ASSERT (boundary > m_boundary);
+  m_wakeups[boundary].push_back (id);
+}
+
+uint64_t
+SatmacSlotClock::GetBoundary (void) const
+{
+  return m_boundary;
+}
+
+uint64_t
+SatmacSlotClock::GetBoundaryAtOrAfter (Time time) const
+{
+  int64_t offset = (time - m_phase).GetTimeStep ();
+  int64_t slot = m_slotTime.GetTimeStep ();
+  if (offset <= 0)
+    {
+      return 0;
+    }
+  return (offset + slot - 1) / slot;
+}
+
+void
+SatmacSlotClock::Tick (void)
+{
+  m_boundary++;
+  // reschedule first, as each slotHandler did, to keep the event order
+  m_event = Simulator::Schedule (m_slotTime, &SatmacSlotClock::Tick, this);
+
+  std::map<uint64_t, std::vector<uint32_t> >::iterator it = m_wakeups.begin ();
+  if (it != m_wakeups.end () && it->first == m_boundary)
+    {
+      std::vector<uint32_t> due;
+      due.swap (it->second);
+      m_wakeups.erase (it);
+      std::sort (due.begin (), due.end ());
+      for (std::vector<uint32_t>::const_iterator i = due.begin (); i != due.end (); ++i)
+        {
+          if (m_macs[*i] == 0)
+            {
+              continue;
+            }
+          uint64_t next = m_macs[*i]->DispatchSlot (m_boundary);
+          if (next > m_boundary)
+            {
+              WakeAt (*i, next);
+            }
+        }
+    }
+
+  if (m_live == 0)
+    {
+      m_event.Cancel ();
+      m_wakeups.clear ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SATMAC_SLOT_CLOCK_H
+#define SATMAC_SLOT_CLOCK_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class TdmaSatmac;
+
+/**
+ * \brief one slot boundary event shared by every TdmaSatmac on the same slot grid
+ *
+ * Instead of each TdmaSatmac rescheduling its slotHandler every slot, the
+ * macs of a grid (same slot time, same boundary phase) register with one
+ * clock. The clock ticks once per slot boundary and only calls the macs
+ * that asked to be woken at that boundary; each mac catches up on the
+ * boundaries it slept through when it is next woken or touched.
+ *
+ * Boundaries are numbered from the start of the simulation; macs due on
+ * the same boundary are called in registration order, which is the order
+ * their own slotHandler events would have run in.
+ */
+class SatmacSlotClock : public SimpleRefCount<SatmacSlotClock>
+{
+public:
+  /**
+   * \param slotTime the slot duration
+   * \param firstBoundary the time of a boundary of the grid
+   * \return the clock of the grid, created on first use
+   */
+  static Ptr<SatmacSlotClock> Get (Time slotTime, Time firstBoundary);
+
+  /**
+   * \param mac the mac to drive
+   * \param firstBoundary the time of the first boundary the mac handles
+   * \return the id of the mac on this clock
+   */
+  uint32_t Register (TdmaSatmac *mac, Time firstBoundary);
+  /**
+   * Stop driving a mac.
+   * \param id the id returned by Register
+   */
+  void Unregister (uint32_t id);
+  /**
+   * \param id the id returned by Register
+   * \param boundary the boundary to call the mac on
+   */
+  void WakeAt (uint32_t id, uint64_t boundary);
+
+  /**
+   * \return the last boundary ticked
+   */
+  uint64_t GetBoundary (void) const;
+  /**
+   * \param time a time on or after the start of the simulation
+   * \return the first boundary at or after time
+   */
+  uint64_t GetBoundaryAtOrAfter (Time time) const;
+
+private:
+  /**
+   * \param slotTime the slot duration
+   * \param phase the time of boundary 0
+   */
+  SatmacSlotClock (Time slotTime, Time phase);
+  /// Tick the next boundary and call the macs due on it
+  void Tick (void);
+  /// Drop every clock when the simulator is destroyed
+  static void DestroyAll (void);
+
+  /// the clocks, by slot time and phase
+  typedef std::map<std::pair<int64_t, int64_t>, Ptr<SatmacSlotClock> > ClockMap;
+  static ClockMap m_clocks;
+
+  Time m_slotTime;                                        //!< slot duration
+  Time m_phase;                                           //!< time of boundary 0
+  uint64_t m_boundary;                                    //!< last boundary ticked
+  EventId m_event;                                        //!< the next tick
+  std::vector<TdmaSatmac *> m_macs;                       //!< macs by id, 0 once unregistered
+  uint32_t m_live;                                        //!< number of registered macs
+  std::map<uint64_t, std::vector<uint32_t> > m_wakeups;   //!< macs due, by boundary
+};
+
+} // namespace ns3
+
+#endif /* SATMAC_SLOT_CLOCK_H */
@@ -104,6 +104,12 @@ TdmaMacQueue::SetTdmaMacTxDropCallback (Callback<void,Ptr<const Packet> > callba
   m_txDropCallback = callback;
 }
 
+void
+TdmaMacQueue::SetExpiredCallback (TdmaMacExpiredCallback callback)
+{
+  m_expiredCallback = callback;
+}
+
 uint32_t
 TdmaMacQueue::GetMaxSize (void) const
 {
@@ -142,27 +148,22 @@ TdmaMacQueue::Cleanup (void)
     {
       return;
     }
+  // the queue is sorted by timestamp: stop at the first packet in time
   Time now = Simulator::Now ();
-  uint32_t n = 0;
-  for (PacketQueueI i = m_queue.begin (); i != m_queue.end (); )
+  while (!m_queue.empty ()
+         && (m_queue.front ().tstamp + m_maxDelay <= now
+             || (!m_expiredCallback.IsNull () && m_expiredCallback (m_queue.front ().packet, m_queue.front ().tstamp))))
     {
-      if (i->tstamp + m_maxDelay > now)
-        {
-          i++;
-        }
-      else
-        {
-          m_count++;
-          NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << "s Dropping this packet as its exceeded queue time, pid: " << i->packet->GetUid ()
-                                                        << " macPtr: " << m_macPtr
-                                                        << " queueSize: " << m_queue.size ()
-                                                        << " count:" << m_count);
-          m_txDropCallback (i->packet);
-          i = m_queue.erase (i);
-          n++;
-        }
+      Ptr<const Packet> packet = m_queue.front ().packet;
+      m_count++;
+      NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << "s Dropping this packet as its exceeded queue time, pid: " << packet->GetUid ()
+                                                    << " macPtr: " << m_macPtr
+                                                    << " queueSize: " << m_queue.size ()
+                                                    << " count:" << m_count);
+      m_queue.pop_front ();
+      m_size--;
+      m_txDropCallback (packet);
     }
-  m_size -= n;
 }
 
 Ptr<const Packet>
@@ -172,25 +173,40 @@ TdmaMacQueue::Dequeue (WifiMacHeader *hdr)
   Cleanup ();
   if (!m_queue.empty ())
     {
-      Item i = m_queue.front ();
+      Ptr<const Packet> packet = m_queue.front ().packet;
+      *hdr = m_queue.front ().hdr;
       m_queue.pop_front ();
       m_size--;
+      NS_LOG_DEBUG ("Dequeued packet of size: " << packet->GetSize ());
+      return packet;
+    }
+  return 0;
+}
+
+Ptr<const Packet>
+TdmaMacQueue::Peek (WifiMacHeader *hdr)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Cleanup ();
+  if (!m_queue.empty ())
+    {
+      const Item &i = m_queue.front ();
       *hdr = i.hdr;
-      NS_LOG_DEBUG ("Dequeued packet of size: " << i.packet->GetSize ());
       return i.packet;
     }
   return 0;
 }
 
 Ptr<const Packet>
-TdmaMacQueue::Peek (WifiMacHeader *hdr)
+TdmaMacQueue::Peek (WifiMacHeader *hdr, Time *tstamp)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Cleanup ();
   if (!m_queue.empty ())
     {
-      Item i = m_queue.front ();
+      const Item &i = m_queue.front ();
       *hdr = i.hdr;
+      *tstamp = i.tstamp;
       return i.packet;
     }
   return 0;
@@ -249,4 +265,22 @@ TdmaMacQueue::Remove (Ptr<const Packet> packet)
     }
   return false;
 }
+
+uint32_t
+TdmaMacQueue::RemoveIf (Callback<bool, Ptr<const Packet> > predicate)
+{
+  NS_LOG_FUNCTION (this);
+  PacketQueueI kept = m_queue.begin ();
+  for (PacketQueueI it = m_queue.begin (); it != m_queue.end (); it++)
+    {
+      if (!predicate (it->packet))
+        {
+          *kept++ = *it;
+        }
+    }
+  uint32_t removed = m_queue.end () - kept;
+  m_queue.erase (kept, m_queue.end ());
+  m_size -= removed;
+  return removed;
+}
 } // namespace ns3
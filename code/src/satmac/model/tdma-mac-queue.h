@@ -31,7 +31,7 @@
 #ifndef TDMA_MAC_QUEUE_H
 #define TDMA_MAC_QUEUE_H
 
-#include <list>
+#include <deque>
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
@@ -53,11 +53,19 @@ namespace ns3 {
  * When a packet is dequeued, the queue checks its timestamp
  * to verify whether or not it should be dropped. If m_maxDelay has
  * elapsed, it is dropped. Otherwise, it is returned to the caller.
+ *
+ * Packets are only appended, with the current time, so the timestamps
+ * never decrease from head to tail and the expired packets are always
+ * at the head: dropping them costs constant amortised time.
  */
 class TdmaMacQueue : public Object
 {
 public:
   typedef Callback<void, Ptr<const Packet> > TdmaMacTxDropCallback;
+  /**
+   * Tells whether a packet queued at the given time has expired
+   */
+  typedef Callback<bool, Ptr<const Packet>, Time> TdmaMacExpiredCallback;
 
   static TypeId GetTypeId (void);
   TdmaMacQueue ();
@@ -90,13 +98,37 @@ public:
    */
   Ptr<const Packet> Dequeue (WifiMacHeader *hdr);
   Ptr<const Packet> Peek (WifiMacHeader *hdr);
+  /**
+   * \brief Peeks the packet at the head of the TdmaMacQueue
+   *
+   * \param hdr the header of the packet
+   * \param tstamp the time the packet was enqueued
+   */
+  Ptr<const Packet> Peek (WifiMacHeader *hdr, Time *tstamp);
   /**
    * If exists, removes <i>packet</i> from queue and returns true. Otherwise it
    * takes no effects and return false. Deletion of the packet is
    * performed in linear time (O(n)).
    */
   bool Remove (Ptr<const Packet> packet);
+  /**
+   * Removes the packets for which <i>predicate</i> returns true. The other
+   * packets keep their order and their timestamps. Deletion is performed
+   * in linear time (O(n)).
+   *
+   * \param predicate the packets to remove
+   * \return the number of packets removed
+   */
+  uint32_t RemoveIf (Callback<bool, Ptr<const Packet> > predicate);
   void SetTdmaMacTxDropCallback (Callback<void,Ptr<const Packet> > callback);
+  /**
+   * The packets for which <i>callback</i> returns true are dropped like the
+   * ones which stayed longer than the max delay, once they reach the head
+   * of the queue.
+   *
+   * \param callback tells whether a packet queued at the given time has expired
+   */
+  void SetExpiredCallback (TdmaMacExpiredCallback callback);
   void Flush (void);
   /**
    * \brief returns true is TdmaMacQueue is empty
@@ -109,10 +141,14 @@ public:
 private:
   struct Item;
 
-  typedef std::list<struct Item> PacketQueue;
-  typedef std::list<struct Item>::reverse_iterator PacketQueueRI;
-  typedef std::list<struct Item>::iterator PacketQueueI;
+  typedef std::deque<struct Item> PacketQueue;
+  typedef std::deque<struct Item>::reverse_iterator PacketQueueRI;
+  typedef std::deque<struct Item>::iterator PacketQueueI;
 
+  /**
+   * Drop the packets at the head of the queue which stayed longer than
+   * m_maxDelay, or for which m_expiredCallback returns true.
+   */
   void Cleanup (void);
   Mac48Address GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQueueI);
 
@@ -133,6 +169,7 @@ private:
   uint32_t m_count;
   Ptr<TdmaMac> m_macPtr;
   TdmaMacTxDropCallback m_txDropCallback;
+  TdmaMacExpiredCallback m_expiredCallback;
 };
 
 } // namespace ns3
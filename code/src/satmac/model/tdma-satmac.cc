@@ -239,6 +239,12 @@ TdmaSatmac::GetTypeId (void)
 					 MakeDoubleAccessor (&TdmaSatmac::setFrameadjCutRatioEhs,
 									   &TdmaSatmac::getFrameadjCutRatioEhs),
 					 MakeDoubleChecker<double> (0,1))
+	  .AddAttribute ("SharedSlotClock",
+					 "Drive the slots of all nodes on the same slot grid from one shared "
+					 "clock event, waking a node only on the slots it has work in.",
+					 IntegerValue (0),
+					 MakeIntegerAccessor (&TdmaSatmac::m_shared_slot_clock_),
+					 MakeIntegerChecker<int> (0,1))
 	  .AddAttribute ("LPFTraceFile", "",
 					 StringValue ("lpf-output.txt"),
 					 MakeStringAccessor (&TdmaSatmac::setTraceOutFile),
@@ -249,6 +255,10 @@ TdmaSatmac::GetTypeId (void)
 					 "trace to track the announcement of bch messages",
 					 MakeTraceSourceAccessor (&TdmaSatmac::m_BCHTrace),
 					 "ns3::TdmaSatmac::BCHTracedCallback")
+	.AddTraceSource ("ChannelUtilization",
+					 "The channel utilization seen by this node, sampled once per second",
+					 MakeTraceSourceAccessor (&TdmaSatmac::m_channelUtilizationTrace),
+					 "ns3::TdmaSatmac::ChannelUtilizationTracedCallback")
   ;
   return tid;
 }
@@ -264,6 +274,11 @@ TdmaSatmac::TdmaSatmac ()
   m_queue->SetTdmaMacTxDropCallback (MakeCallback (&TdmaSatmac::NotifyTxDrop, this));
   m_uniformRandomVariable = CreateObject<UniformRandomVariable> ();
   m_transmissionListener = new TransmissionListenerUseless ();
+  collected_fi_ = NULL;
+  m_shared_slot_clock_ = 0;
+  m_slot_clock_id = 0;
+  m_slot_synced = 0;
+  m_owns_aperiodic_queue = false;
 
   adj_single_slot_ena_ = 0;
   bch_slot_lock_ = 5;
@@ -311,9 +326,11 @@ TdmaSatmac::Start (void)
   slot_num_ = (slot_count_+1)% m_frame_len; //slot_num_初始化为当前的下一个时隙。
 
   global_psf = 0;
+  delete collected_fi_;
   collected_fi_ = new Frame_info(512);
   collected_fi_->sti = this->global_sti;
-  received_fi_list_= NULL;
+  received_fi_list_.clear();
+  received_fi_list_.reserve(16, m_frame_len);
 
   node_state_ = NODE_INIT;
   slot_state_ = BEGINING;
@@ -338,7 +355,13 @@ TdmaSatmac::Start (void)
   location_initialed_ = false;
   direction_initialed_ = false;
   //std::cout<<"Start time:" << m_start_delay_frames << " ID: " << this->GetGlobalSti() << std::endl;
-  Simulator::Schedule (MilliSeconds (starttime),&TdmaSatmac::slotHandler, this);
+  if (m_shared_slot_clock_ && this->getNodePtr()->GetId() != 0) {
+	  Time first = Simulator::Now () + MilliSeconds (starttime);
+	  m_slot_clock = SatmacSlotClock::Get (GetSlotTime (), first);
+	  m_slot_clock_id = m_slot_clock->Register (this, first);
+	  m_slot_synced = m_slot_clock->GetBoundaryAtOrAfter (first) - 1;
+  } else
+	  Simulator::Schedule (MilliSeconds (starttime),&TdmaSatmac::slotHandler, this);
   //slotHandler();
 
   m_slot_group = -1;
@@ -371,6 +394,14 @@ TdmaSatmac::DoDispose (void)
   m_low = 0;
   m_device = 0;
   m_queue = 0;
+  m_aperiodic_txop = 0;
+  m_aperiodic_queue = 0;
+  if (m_slot_clock) {
+	  m_slot_clock->Unregister (m_slot_clock_id);
+	  m_slot_clock = 0;
+  }
+  delete collected_fi_;
+  collected_fi_ = NULL;
   TdmaMac::DoDispose ();
 }
 
@@ -524,7 +555,20 @@ void
 TdmaSatmac::Queue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
 {
   NS_LOG_FUNCTION (this << packet << &hdr);
-  if (!m_queue->Enqueue (packet, hdr))
+  AperiodicTag tag;
+  if (m_aperiodic_queue != 0 && packet->PeekPacketTag (tag))
+    {
+      if (!m_owns_aperiodic_queue)
+        {
+          // the csma txop serves the queue: let it request channel access
+          m_aperiodic_txop->Queue (packet, hdr);
+        }
+      else if (!m_aperiodic_queue->Enqueue (Create<WifiMacQueueItem> (packet, hdr)))
+        {
+          NotifyTxDrop (packet);
+        }
+    }
+  else if (!m_queue->Enqueue (packet, hdr))
     {
       NotifyTxDrop (packet);
     }
@@ -731,11 +775,6 @@ int TdmaSatmac::GetSlotMemory(void) const
   return slot_memory_;
 }
 
-void TransmissionListenerUseless::EndTxNoAck()
-{
-	  txok = true;
-}
-
 void
 TdmaSatmac::Enqueue (Ptr<const Packet> packet, Mac48Address to, Mac48Address from)
 {
@@ -835,31 +874,20 @@ void TdmaSatmac::clear_FI(Frame_info *fi){
 	//fi->index;
 	//fi->sti;
 	fi->valid_time = 0;
-	fi->remain_time = 0;
 	fi->recv_slot = -1;
-	if(fi->slot_describe != NULL){
+	if(fi->slot_describe == NULL || fi->capacity < 512){
 		delete[] fi->slot_describe;
-	}
-	fi->slot_describe = new slot_tag[512];
+		fi->slot_describe = new slot_tag[512];
+		fi->capacity = 512;
+	} else
+		std::fill(fi->slot_describe, fi->slot_describe + fi->capacity, slot_tag());
 }
 
 /*
- * allocate a new fi and add insert in the head of received_fi_list;
+ * take a recycled fi from the tail of received_fi_list_, valid for one frame;
  */
 Frame_info * TdmaSatmac::get_new_FI(int slot_count){
-	Frame_info *newFI= new Frame_info(slot_count);
-//	newFI->next_fi = this->received_fi_list_;
-	Frame_info *tmp;
-
-	if (received_fi_list_ == NULL)
-		received_fi_list_ = newFI;
-	else {
-		for (tmp = received_fi_list_; tmp->next_fi != NULL; tmp = tmp->next_fi) {}
-		tmp->next_fi = newFI;
-	}
-	newFI->next_fi = NULL;
-
-	return newFI;
+	return received_fi_list_.append(slot_count, this->m_frame_len);
 }
 
 void TdmaSatmac::print_slot_status(void) {
@@ -897,13 +925,18 @@ void TdmaSatmac::print_slot_status(void) {
 }
 
 bool TdmaSatmac::isNewNeighbor(int sid) {
+	return count_sti_slots(sid) == 0;
+}
+
+/* the number of slots of the local FI held by sid */
+int TdmaSatmac::count_sti_slots(int sid) {
 	slot_tag *fi_local = this->collected_fi_->slot_describe;
-	int count;
+	int count, n = 0;
 	for (count=0; count < m_frame_len; count++){
 		if (fi_local[count].sti == sid)
-			return false;
+			n++;
 	}
-	return true;
+	return n;
 }
 
 /* This function is used to pick up a random slot of from those which is free. */
@@ -1076,6 +1109,7 @@ TdmaSatmac::ForwardUp (Ptr<Packet> packet, const WifiMacHeader *hdr)
  * 把收到的FI包解序列化后存到received_fi_list_中。
  */
 void TdmaSatmac::recvFI(Ptr<Packet> p){
+	SyncSlotClock ();
 	unsigned int bit_pos=7, byte_pos=0;
  	unsigned long value=0;
 	unsigned int recv_fi_frame_fi = 0;
@@ -1104,7 +1138,6 @@ void TdmaSatmac::recvFI(Ptr<Packet> p){
 	//fi_recv->type = TYPE_FI;
 
 	fi_recv->valid_time = this->m_frame_len;
-	fi_recv->remain_time = fi_recv->valid_time;
 
 //
 //	for (int j = 0; j < tlen; j++)
@@ -1151,6 +1184,9 @@ void TdmaSatmac::merge_fi(Frame_info* base, Frame_info* append, Frame_info* deci
 	slot_tag *fi_append = append->slot_describe;
 	slot_tag recv_tag;
 	int recv_fi_frame_len = append->frame_len;
+	// slots of the local FI held by the FI sender: counted on first use and
+	// kept up to date below, rather than rescanning the frame for every slot.
+	int sender_slots = -1;
 
 //	printf("I'm n%d, start merge fi from n %d\n", global_sti,append->sti);
 	// status of our BCH should be updated first.
@@ -1169,6 +1205,8 @@ void TdmaSatmac::merge_fi(Frame_info* base, Frame_info* append, Frame_info* deci
 				{
 					case SLOT_1HOP:
 						if (recv_tag.psf > fi_local_[count].psf) {
+							if (sender_slots >= 0)
+								sender_slots += (recv_tag.sti == append->sti) - (fi_local_[count].sti == append->sti);
 							fi_local_[count].life_time = slot_lifetime_frame_;
 							fi_local_[count].sti = recv_tag.sti;
 							fi_local_[count].count_2hop ++;
@@ -1190,6 +1228,8 @@ void TdmaSatmac::merge_fi(Frame_info* base, Frame_info* append, Frame_info* deci
 						fi_local_[count].busy = SLOT_COLLISION;
 						break;
 					case SLOT_COLLISION:
+						if (sender_slots >= 0)
+							sender_slots += (recv_tag.sti == append->sti) - (fi_local_[count].sti == append->sti);
 						fi_local_[count].life_time = slot_lifetime_frame_;
 						fi_local_[count].sti = recv_tag.sti;
 						fi_local_[count].count_2hop = 1;
@@ -1217,7 +1257,9 @@ void TdmaSatmac::merge_fi(Frame_info* base, Frame_info* append, Frame_info* deci
 				}
 			} else { //STI-slot == 0
 				if (recv_tag.busy == SLOT_FREE && count != slot_adj_candidate_) {
-					if (!isNewNeighbor(append->sti)) {
+					if (sender_slots < 0)
+						sender_slots = count_sti_slots(append->sti);
+					if (sender_slots > 0) {
 						//出现了隐藏站
 						fi_local_[count].busy = SLOT_COLLISION;
 					}
@@ -1417,38 +1459,14 @@ bool TdmaSatmac::isSingle(void) {
 }
 
 /*
- * reduce the remain_time of each of received_fi_list_
+ * reduce the remaining valid time of each of received_fi_list_
  * if the argument time ==0 then clear the received_fi_list_;
  */
 void TdmaSatmac::fade_received_fi_list(int time){
-	Frame_info *current, *previous;
-	current=this->received_fi_list_;
-	previous=NULL;
-
-	while(current != NULL){
-		current->remain_time -= time;
-		if(current->remain_time <= 0 || time == 0){
-			if(previous == NULL){
-				this->received_fi_list_ = current->next_fi;
-				delete current;
-				current = this->received_fi_list_;
-				continue;
-			}
-			else{
-				previous->next_fi= current->next_fi;
-				delete current;
-				current = previous->next_fi;
-				continue;
-			}
-		}
-		else{
-			previous = current;
-			current = current->next_fi;
-		}
-	}
+	this->received_fi_list_.fade(time);
 }
 void TdmaSatmac::synthesize_fi_list(){
-	Frame_info * processing_fi = received_fi_list_;
+	Frame_info * processing_fi;
 	int count;
 	slot_tag *fi_local = this->collected_fi_->slot_describe;
 	bool unlock_flag = 0;
@@ -1502,9 +1520,10 @@ void TdmaSatmac::synthesize_fi_list(){
 		}
 	}
 
-	while(processing_fi != NULL){
-		merge_fi(this->collected_fi_, processing_fi, this->decision_fi_);
-		processing_fi = processing_fi->next_fi;
+	for (int i = 0; i < received_fi_list_.size(); i++){
+		processing_fi = received_fi_list_.at(i);
+		if (received_fi_list_.is_alive(processing_fi))
+			merge_fi(this->collected_fi_, processing_fi, this->decision_fi_);
 	}
 
 	if (unlock_flag) {
@@ -1701,26 +1720,6 @@ void TdmaSatmac::generate_send_FI_packet(){
 	send_fi_count_++;
 }
 
-void TdmaSatmac::WaitWifiState()
-{
-	if (m_transmissionListener->isTxok())
-//	if (!(this->getWifiPhy()->IsStateTx ()) && !(this->getWifiPhy()->IsStateSwitching ()))
-	{
-		m_transmissionListener->setTxok(false);
-		switch (this->node_state_)
-		{
-		case NODE_WORK_FI:
-		case NODE_WORK_ADJ:
-			StartTransmission(m_slotRemainTime);
-			break;
-		default: break;
-		}
-	} else {
-		m_slotRemainTime -= 50;
-		Simulator::Schedule (MicroSeconds(50), &TdmaSatmac::WaitWifiState, this);
-	}
-}
-
   void 
   TdmaSatmac::SendSgiDown(Ptr<Packet> packet, WifiMacHeader header)
   {
@@ -1741,6 +1740,7 @@ void TdmaSatmac::WaitWifiState()
 void
 TdmaSatmac::SendFiDown (Ptr<Packet> packet, WifiMacHeader header)
 {
+  SyncSlotClock ();
   if (m_wifimaclow_flag)
   {
 	  MacLowTransmissionParameters params;
@@ -1760,6 +1760,8 @@ TdmaSatmac::SendFiDown (Ptr<Packet> packet, WifiMacHeader header)
 	                                 params,
 	                                 m_transmissionListener);
 
+	  // the FI duration is known up front, so data follows it on a timer
+	  // rather than by watching the PHY state
 	  switch (this->node_state_)
 	  {
 	  case NODE_WORK_FI:
@@ -1768,7 +1770,6 @@ TdmaSatmac::SendFiDown (Ptr<Packet> packet, WifiMacHeader header)
 	  	break;
 	  default: break;
 	  }
-//	  WaitWifiState();
   } else {
 	  m_low->StartTransmission (packet, &header);
 	  NotifyTx (packet);
@@ -1786,10 +1787,11 @@ TdmaSatmac::SendFiDown (Ptr<Packet> packet, WifiMacHeader header)
 void
 TdmaSatmac::StartTransmission (uint64_t transmissionTimeUs)
 {
+  SyncSlotClock ();
   NS_LOG_DEBUG (transmissionTimeUs << " usec");
 
   Time totalTransmissionSlot = MicroSeconds (transmissionTimeUs);
-  if (m_queue->IsEmpty ())
+  if (IsQueueEmpty ())
     {
       NS_LOG_DEBUG ("queue empty");
       return;
@@ -1799,7 +1801,7 @@ TdmaSatmac::StartTransmission (uint64_t transmissionTimeUs)
   //printf("I'm node %d, I start send data pkt\n",global_sti);
 
   WifiMacHeader header;
-  Ptr<const Packet> peekPacket = m_queue->Peek (&header);
+  Ptr<const Packet> peekPacket = PeekNext (&header);
 
   if (m_wifimaclow_flag)
   {
@@ -1821,7 +1823,7 @@ TdmaSatmac::StartTransmission (uint64_t transmissionTimeUs)
 				if(delta > 100000)
 				{
 					//std::cout<<delta<<std::endl;
-					m_queue->Dequeue(&header);
+					DequeueNext(&header);
 				}
 
 		  }
@@ -1851,7 +1853,7 @@ void
 TdmaSatmac::SendPacketDown (Time remainingTime)
 {
   WifiMacHeader header;
-  Ptr<const Packet> packet = m_queue->Dequeue (&header);
+  Ptr<const Packet> packet = DequeueNext (&header);
   //std::cout<<this->getNodePtr()->GetId()<<" Time:  "<<Simulator::Now().GetMicroSeconds()<<std::endl;
   	if (m_wifimaclow_flag)
   {
@@ -1956,7 +1958,8 @@ TdmaSatmac::slotHandler ()
   // Restart timer for next slot.
   total_slot_count_ = total_slot_count_+1;
   slot_count_ = total_slot_count_ %  m_frame_len;
-  Simulator::Schedule (GetSlotTime(), &TdmaSatmac::slotHandler, this);
+  if (!m_slot_clock)
+	  Simulator::Schedule (GetSlotTime(), &TdmaSatmac::slotHandler, this);
 
   //std::cout<<"slot_count_"<<slot_count_<<std::endl;
 
@@ -2026,8 +2029,6 @@ TdmaSatmac::slotHandler ()
 	  /**
 	   * LPF
 	   */
-	  double x = (this->getNodePtr())->GetObject<MobilityModel> ()->GetPosition ().x;
-	  double y = (this->getNodePtr())->GetObject<MobilityModel> ()->GetPosition ().y;
       //std::ofstream out (m_traceOutFile, std::ios::app);
       //*m_log_lpf_stream->GetStream()
 //	  out << "m "<<(Simulator::Now ()).GetMilliSeconds ()<<" t["<<slot_num_<<"] _"<<global_sti<<
@@ -2037,17 +2038,9 @@ TdmaSatmac::slotHandler ()
 //	  	no_avalible_count_<<" "<<slot_num_<<" "<<m_frame_len<<" "<<localmerge_collision_count_
 //		<<" "<<"x:" << x <<" "<<"y"<< y <<" "<<get_channel_utilization()<<std::endl;
 
-	uint32_t numNodes = NodeList::GetNNodes();
-	// 获取 run_num
-      int run_num = RunNumber::GetInstance().GetRunNum();
-	  std::__cxx11::string channel_file =  "channel_utilization_run" + std::to_string(run_num) + ".txt";
-
-      //std::ofstream out (m_channel_utilization_OutFile, std::ios::app);
-	  std::ofstream out (channel_file, std::ios::app);
-	  
-      out << get_channel_utilization() <<std::endl;
-
-	  out.close ();
+	  // the utilization scan is only worth its cost when someone listens
+	  if (!m_channelUtilizationTrace.IsEmpty ())
+		  m_channelUtilizationTrace (m_nodePtr->GetId (), get_channel_utilization ());
   }
 
   NS_ASSERT_MSG (slot_num_ <= m_frame_len, "FATAL! slot_num_ > m_frame_len" << this->GetGlobalSti());
@@ -2418,6 +2411,63 @@ TdmaSatmac::slotHandler ()
 
 }
 
+uint64_t
+TdmaSatmac::DispatchSlot (uint64_t boundary)
+{
+  sync_slot_clock (boundary - 1);
+  // mark the boundary applied first, so syncs from within the handler are no-ops
+  m_slot_synced = boundary;
+  slotHandler ();
+  return next_wake_boundary (boundary);
+}
+
+void
+TdmaSatmac::SyncSlotClock (void)
+{
+  if (m_slot_clock)
+	  sync_slot_clock (m_slot_clock->GetBoundary ());
+}
+
+/*
+ * do what slotHandler does on the slots that are not ours: count the slot,
+ * reset the slot state and fade the received fis.
+ */
+void TdmaSatmac::sync_slot_clock(uint64_t boundary){
+	if (!m_slot_clock || boundary <= m_slot_synced)
+		return;
+	int n = boundary - m_slot_synced;
+	total_slot_count_ += n;
+	slot_count_ = total_slot_count_ % m_frame_len;
+	m_slotRemainTime = m_slotTime;
+	slot_state_ = BEGINING;
+	this->fade_received_fi_list(n);
+	m_slot_synced = boundary;
+}
+
+/*
+ * the next boundary slotHandler has work on: our BCH (or the end of the
+ * listen frame), the next channel utilization sample if it is traced, or
+ * every slot until the vemac location and direction are known.
+ */
+uint64_t TdmaSatmac::next_wake_boundary(uint64_t boundary){
+	if (vemac_mode_ == 1 && (location_initialed_ == false || direction_initialed_ == false))
+		return boundary + 1;
+
+	// never sleep past a frame, so a node without a BCH still checks in
+	uint64_t next = boundary + std::max (m_frame_len, 1);
+	if (!m_channelUtilizationTrace.IsEmpty ()) {
+		Time log_time = MilliSeconds (last_log_time_.GetMilliSeconds() + 1000);
+		next = std::min (next, std::max (m_slot_clock->GetBoundaryAtOrAfter (log_time), boundary + 1));
+	}
+	if (slot_num_ >= 0 && slot_num_ < m_frame_len) {
+		uint64_t frame_len = m_frame_len;
+		uint64_t slot = (total_slot_count_ + 1) % frame_len;
+		uint64_t bch = boundary + 1 + (slot_num_ + frame_len - slot) % frame_len;
+		next = std::min (next, bch);
+	}
+	return next;
+}
+
 void TdmaSatmac::NotifyConflictDetected(Time conflictTime, Ptr<Node> conflictNode)
 {
 	int slotNumberInFrame = (conflictTime.GetMilliSeconds()) % (m_frame_len);
@@ -2437,6 +2487,7 @@ void TdmaSatmac::NotifyConflictDetected(Time conflictTime, Ptr<Node> conflictNod
 
 void TdmaSatmac::slotgroupHandler()
 {
+	SyncSlotClock ();
 	total_slot_group_count = total_slot_group_count + 1;
 	slot_group_count = total_slot_group_count % (m_frame_len / slot_group_length);
 
@@ -2530,6 +2581,7 @@ void TdmaSatmac::ExecuteSlotGroupOperations(int maxFreeSlots, int startSlot, int
 
 void TdmaSatmac::SlotGroupStart()
 {
+    SyncSlotClock ();
     NS_LOG_FUNCTION(this << "Slot group start: " << slot_group_count);
 
     // TODO: 切至CSMA之前，再次检查本地信息
@@ -2570,16 +2622,18 @@ void TdmaSatmac::SlotGroupStart()
         return;
     }
 
-    // 执行设备切换操作
+    // 执行设备切换操作：配置了切换策略时，由策略决定是否在该时隙组内使用 CSMA
     Ptr<MacLayerController> macCtrler = this->getNodePtr()->GetObject<MacLayerController>();
-    Ptr<WifiNetDevice> csma = DynamicCast<WifiNetDevice>(this->getNodePtr()->GetDevice(1));
-	macCtrler->SwitchToDevice(csma);
+	macCtrler->SlotGroupStarted();
 
 	Simulator::Schedule(GetSlotTime() * (maxFreeSlots - 1) - NanoSeconds(1), &TdmaSatmac::SlotGroupEnd, this);
 }
 
 void TdmaSatmac::StartMidSlotListening()
 {
+    // the listening event does no work; skip it when slots are driven by the shared clock
+    if (m_slot_clock)
+        return;
     // 启动持续监听操作
     midSlotListeningEvent = Simulator::ScheduleNow(&TdmaSatmac::MidSlotListening, this);
 }
@@ -2607,11 +2661,9 @@ void TdmaSatmac::SlotGroupEnd()
     }
     // 时隙组结束时的操作
 
-    // 其他清理操作
+    // 其他清理操作：负载仍未回落时，配置的切换策略让节点留在 CSMA
     Ptr<MacLayerController> macCtrler = this->getNodePtr()->GetObject<MacLayerController>();
-    Ptr<WifiNetDevice> tdma = DynamicCast<WifiNetDevice>(this->getNodePtr()->GetDevice(0));
-    Ptr<WifiNetDevice> csma = DynamicCast<WifiNetDevice>(this->getNodePtr()->GetDevice(1));
-    macCtrler->SwitchToDevice(tdma);
+    macCtrler->SlotGroupEnded();
 }
 
 int TdmaSatmac::GetGeohash()
@@ -2812,6 +2864,13 @@ void TdmaSatmac::merge_sgi(SlotGroupHeader recv_sgi_hdr)
 
 void TdmaSatmac::CheckIsNeedSG()
 {
+    if (m_aperiodic_queue != 0)
+    {
+        // the aperiodic packets are all in the shared queue
+        if (!m_aperiodic_queue->IsEmpty())
+            isNeedSg = true;
+        return;
+    }
     WifiMacHeader header;
     AperiodicTag aperiodicTag;
     std::vector<std::pair<Ptr<const Packet>, WifiMacHeader>> tempQueue;
@@ -2834,6 +2893,72 @@ void TdmaSatmac::CheckIsNeedSG()
     }
 }
 
+void TdmaSatmac::SetAperiodicTxop(Ptr<Txop> txop)
+{
+	m_aperiodic_txop = txop;
+	m_aperiodic_queue = txop->GetWifiMacQueue();
+}
+
+void TdmaSatmac::SetAperiodicQueueOwned(bool owned)
+{
+	m_owns_aperiodic_queue = owned;
+}
+
+double TdmaSatmac::GetChannelUtilization()
+{
+	if (collected_fi_ == NULL)
+		return 0;
+	return get_channel_utilization();
+}
+
+double TdmaSatmac::GetAvailableSlotGroupRatio()
+{
+	// nothing has been heard yet: every slot group is available
+	if (collected_fi_ == NULL)
+		return 1;
+	return get_available_slot_group_ratio();
+}
+
+bool TdmaSatmac::NextFromAperiodicQueue()
+{
+	if (m_aperiodic_queue == 0 || !m_owns_aperiodic_queue)
+		return false;
+	Ptr<const WifiMacQueueItem> item = m_aperiodic_queue->Peek();
+	if (item == 0)
+		return false;
+	WifiMacHeader header;
+	Time tstamp;
+	if (m_queue->Peek(&header, &tstamp) == 0)
+		return true;
+	return item->GetTimeStamp() < tstamp;
+}
+
+bool TdmaSatmac::IsQueueEmpty()
+{
+	return m_queue->IsEmpty() && !NextFromAperiodicQueue();
+}
+
+Ptr<const Packet> TdmaSatmac::PeekNext(WifiMacHeader *hdr)
+{
+	if (!NextFromAperiodicQueue())
+		return m_queue->Peek(hdr);
+	Ptr<const WifiMacQueueItem> item = m_aperiodic_queue->Peek();
+	*hdr = item->GetHeader();
+	// the packet may have been queued by the csma mac
+	hdr->SetAddr2(GetAddress());
+	return item->GetPacket();
+}
+
+Ptr<const Packet> TdmaSatmac::DequeueNext(WifiMacHeader *hdr)
+{
+	if (!NextFromAperiodicQueue())
+		return m_queue->Dequeue(hdr);
+	Ptr<WifiMacQueueItem> item = m_aperiodic_queue->Dequeue();
+	*hdr = item->GetHeader();
+	hdr->SetAddr2(GetAddress());
+	return item->GetPacket();
+}
+
 double TdmaSatmac::get_available_slot_group_ratio()
  {
     // 获取时隙描述数组
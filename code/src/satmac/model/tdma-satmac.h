@@ -7,11 +7,14 @@
 #include "tdma-mac-low.h"
 #include "ns3/tdma-mac-queue.h"
 #include "satmac-common.h"
+#include "satmac-slot-clock.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/mac-low.h"
 #include "ns3/txop.h"
+#include "ns3/wifi-mac-queue.h"
 #include "ns3/wifi-phy.h"
 #include <string>
+#include <array>
 #include "ns3/vector.h"
 
 #include "ns3/output-stream-wrapper.h"
@@ -21,6 +24,11 @@
 
 
 
+class MergeFiTestCase;
+class SatmacSlotClockTestCase;
+class ChannelUtilizationSinkTestCase;
+class MacLayerControllerTestCase;
+class MacLayerControllerSlotGroupTestCase;
 
 namespace ns3 {
 
@@ -41,7 +49,7 @@ public:
    *
    * \param txop
    */
-	TransmissionListenerUseless ():txok(false)
+	TransmissionListenerUseless ()
   {
   }
 
@@ -74,19 +82,9 @@ public:
   virtual void Cancel (void)
   {
   }
-  virtual void EndTxNoAck (void);
-
-	bool isTxok() const {
-		return txok;
-	}
-
-	void setTxok(bool txok) {
-		this->txok = txok;
-	}
-
-private:
-  bool txok;
-
+  virtual void EndTxNoAck (void)
+  {
+  }
 };
 
 class TdmaSatmac : public TdmaMac
@@ -97,6 +95,14 @@ public:
   TdmaSatmac ();
   ~TdmaSatmac ();
 
+  /**
+   * TracedCallback signature for channel utilization samples.
+   *
+   * \param [in] nodeId the id of the node the mac is installed on.
+   * \param [in] utilization the share of the frame the node sees busy.
+   */
+  typedef void (* ChannelUtilizationTracedCallback)(uint32_t nodeId, double utilization);
+
 
   // inherited from TdmaMac.
   virtual void Enqueue (Ptr<const Packet> packet, Mac48Address to, Mac48Address from);
@@ -173,6 +179,18 @@ public:
   void SetGlobalSti(int sti);
   int GetGlobalSti(void) const;
 
+  /**
+   * Run the slotHandler of a slot boundary on behalf of the shared slot clock.
+   * \param boundary the boundary being ticked
+   * \return the next boundary the mac has work on
+   */
+  uint64_t DispatchSlot (uint64_t boundary);
+  /**
+   * Apply the slot boundaries slept through since the mac last ran, when
+   * driven by the shared slot clock; a no-op otherwise.
+   */
+  void SyncSlotClock (void);
+
   void SetFrameLen(int framelen);
   int GetFrameLen(void) const;
 
@@ -292,6 +310,19 @@ public:
 
 	std::map<int, int> m_neighborCountMap;
 private:
+  /// times merge_fi and determine_BCH (examples/satmac-benchmark.cc)
+  friend class SatmacMicroBenchmark;
+  /// Allow test cases to access private members
+  friend class ::MergeFiTestCase;
+  /// Allow test cases to access private members
+  friend class ::SatmacSlotClockTestCase;
+  /// Allow test cases to access private members
+  friend class ::ChannelUtilizationSinkTestCase;
+  /// Allow test cases to access private members
+  friend class ::MacLayerControllerTestCase;
+  /// Allow test cases to access private members
+  friend class ::MacLayerControllerSlotGroupTestCase;
+
   static Time GetDefaultSlotTime (void);
   static Time GetDefaultGuardTime (void);
   static DataRate GetDefaultDataRate (void);
@@ -322,13 +353,13 @@ private:
   void SendPacketDown (Time remainingTime);
   void SendFiDown (Ptr<Packet> packet, WifiMacHeader hdr);
 
-  void WaitWifiState(void);
-
   double get_channel_utilization();
   /*
    * slot_tag and fi handle functions
    */
   void slotHandler ();
+  void sync_slot_clock (uint64_t boundary);
+  uint64_t next_wake_boundary (uint64_t boundary);
   /* Determining which slot will be selected as BCH. */
   int determine_BCH(bool strict);
   void show_slot_occupation(void);
@@ -345,6 +376,7 @@ private:
   Frame_info * get_new_FI(int slot_count);
   void fade_received_fi_list(int time);
   bool isNewNeighbor(int sid);
+  int count_sti_slots(int sid);
   bool isSingle(void);
   void synthesize_fi_list();
   void merge_fi(Frame_info* base, Frame_info* append, Frame_info* decision);
@@ -406,6 +438,12 @@ private:
    */
   TracedCallback<> m_BCHTrace;
 
+  /**
+   * The `ChannelUtilization` trace source, fired once per second of
+   * simulated time with the utilization seen by this node.
+   */
+  TracedCallback<uint32_t, double> m_channelUtilizationTrace;
+
 
   Callback<void, Ptr<Packet>, const WifiMacHeader*> m_upCallback;
   Callback<bool,uint32_t> m_queueStart;
@@ -479,7 +517,7 @@ int global_psf;
 //slot_tag **fi_list_;
 Frame_info *decision_fi_;
 Frame_info *collected_fi_;
-Frame_info *received_fi_list_;
+Frame_info_list received_fi_list_;
 
 NodeState node_state_;
 SlotState slot_state_;
@@ -540,6 +578,18 @@ public:
 	Ptr<TdmaMacQueue> GetTdmaQueue(){
 		return m_queue;
 	}
+	/*
+	 * Keep the aperiodic packets in the queue of the CSMA txop of the node
+	 * instead of m_queue. The two macs take turns to serve it, and this mac
+	 * only sends from it while it owns it; otherwise the packets are queued
+	 * through the txop, which requests channel access for them.
+	 */
+	void SetAperiodicTxop(Ptr<Txop> txop);
+	void SetAperiodicQueueOwned(bool owned);
+	/* the load of the frame: no slot is used and every slot group is
+	 * available before the first frame */
+	double GetChannelUtilization();
+	double GetAvailableSlotGroupRatio();
 
 void NotifyConflictDetected(Time conflictTime, Ptr<Node> conflictNode);
 
@@ -573,6 +623,14 @@ private:
 	int determine_SG();
 	void merge_sgi(SlotGroupHeader recv_sgi_hdr);
 	void CheckIsNeedSG();
+	Ptr<Txop> m_aperiodic_txop;	// the csma txop serving the shared queue
+	Ptr<WifiMacQueue> m_aperiodic_queue;	// shared with the csma txop, 0 if aperiodic packets go to m_queue
+	bool m_owns_aperiodic_queue;
+	/* the next packet to send is the older of the heads of m_queue and of the owned aperiodic queue */
+	bool NextFromAperiodicQueue();
+	bool IsQueueEmpty();
+	Ptr<const Packet> PeekNext(WifiMacHeader *hdr);
+	Ptr<const Packet> DequeueNext(WifiMacHeader *hdr);
 	double get_available_slot_group_ratio();
 	int adj_BCH_Sg();
 	void sg_opration(Ptr<Packet> p);
@@ -580,6 +638,12 @@ private:
 
 	std::string m_channel_utilization_OutFile;
 
+	/* shared slot clock, used instead of per node slotHandler events when enabled */
+	int m_shared_slot_clock_;
+	Ptr<SatmacSlotClock> m_slot_clock;
+	uint32_t m_slot_clock_id;
+	uint64_t m_slot_synced;	// the last boundary applied to this mac
+
 };
 
 } // namespace ns3
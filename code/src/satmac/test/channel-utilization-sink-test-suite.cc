@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/tdma-satmac.h"
+#include "ns3/ChannelUtilizationSink.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the utilization records written from known busy slots
+ *
+ * Each mac holds a frame with a known run of busy slots and reports it
+ * through the ChannelUtilization trace; the sink must write the busy
+ * fraction of every node, one line per interval.
+ */
+class ChannelUtilizationSinkTestCase : public TestCase
+{
+public:
+  ChannelUtilizationSinkTestCase ();
+  virtual ~ChannelUtilizationSinkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Mark slots [\p start, \p start + \p busy) of the frame busy, the rest free.
+   * \param mac the mac
+   * \param start the first busy slot
+   * \param busy the number of busy slots
+   */
+  static void SetBusySlots (Ptr<TdmaSatmac> mac, int start, int busy);
+  /**
+   * Fire the ChannelUtilization trace of a mac, as its slotHandler does.
+   * \param mac the mac
+   * \param nodeId the node of the mac
+   */
+  static void Report (Ptr<TdmaSatmac> mac, uint32_t nodeId);
+
+  static const int FRAME_LEN = 64;  ///< the frame length
+};
+
+ChannelUtilizationSinkTestCase::ChannelUtilizationSinkTestCase ()
+  : TestCase ("Check the channel utilization records of known busy slots")
+{
+}
+
+ChannelUtilizationSinkTestCase::~ChannelUtilizationSinkTestCase ()
+{
+}
+
+void
+ChannelUtilizationSinkTestCase::SetBusySlots (Ptr<TdmaSatmac> mac, int start, int busy)
+{
+  slot_tag *fi = mac->collected_fi_->slot_describe;
+  for (int i = 0; i < FRAME_LEN; i++)
+    {
+      fi[i] = slot_tag ();
+      if (i >= start && i < start + busy)
+        {
+          fi[i].busy = (i % 2) ? SLOT_1HOP : SLOT_2HOP;
+          fi[i].sti = i + 2;
+        }
+    }
+}
+
+void
+ChannelUtilizationSinkTestCase::Report (Ptr<TdmaSatmac> mac, uint32_t nodeId)
+{
+  mac->m_channelUtilizationTrace (nodeId, mac->get_channel_utilization ());
+}
+
+void
+ChannelUtilizationSinkTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("channel-utilization.txt");
+  Ptr<ChannelUtilizationSink> sink = CreateObject<ChannelUtilizationSink> ();
+  sink->SetAttribute ("FileName", StringValue (fileName));
+  sink->SetAttribute ("Interval", TimeValue (Seconds (1)));
+
+  std::vector<Ptr<TdmaSatmac> > macs;
+  for (int n = 0; n < 3; n++)
+    {
+      Ptr<TdmaSatmac> mac = CreateObject<TdmaSatmac> ();
+      mac->SetFrameLen (FRAME_LEN);
+      // as Start sets them
+      mac->collected_fi_ = new Frame_info (FRAME_LEN);
+      mac->slot_group_length = 4;
+      NS_TEST_ASSERT_MSG_EQ (mac->m_channelUtilizationTrace.IsEmpty (), true, "trace connected before Install");
+      sink->Install (mac);
+      NS_TEST_ASSERT_MSG_EQ (mac->m_channelUtilizationTrace.IsEmpty (), false, "trace not connected by Install");
+      macs.push_back (mac);
+    }
+
+  SetBusySlots (macs[0], 0, 16);
+  SetBusySlots (macs[1], 8, 32);
+  SetBusySlots (macs[2], 0, 0);
+  // interval 0: every node reports
+  Simulator::Schedule (MilliSeconds (500), &ChannelUtilizationSinkTestCase::Report, macs[0], 0);
+  Simulator::Schedule (MilliSeconds (500), &ChannelUtilizationSinkTestCase::Report, macs[1], 1);
+  Simulator::Schedule (MilliSeconds (999), &ChannelUtilizationSinkTestCase::Report, macs[2], 2);
+  // interval 1: node 1 is silent, node 0 reports twice and the last sample wins
+  Simulator::Schedule (MilliSeconds (1000), &ChannelUtilizationSinkTestCase::Report, macs[2], 2);
+  Simulator::Schedule (MilliSeconds (1100), &ChannelUtilizationSinkTestCase::Report, macs[0], 0);
+  Simulator::Schedule (MilliSeconds (1150), &ChannelUtilizationSinkTestCase::SetBusySlots, macs[0], 4, 8);
+  Simulator::Schedule (MilliSeconds (1200), &ChannelUtilizationSinkTestCase::Report, macs[0], 0);
+  // interval 2 is empty; interval 3: only node 1, written at destroy
+  Simulator::Schedule (MilliSeconds (3400), &ChannelUtilizationSinkTestCase::SetBusySlots, macs[1], 0, 48);
+  Simulator::Schedule (MilliSeconds (3500), &ChannelUtilizationSinkTestCase::Report, macs[1], 1);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream in (fileName.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (in.is_open (), true, "no utilization file written");
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline (in, line))
+    {
+      lines.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 3, "wrong number of records");
+  NS_TEST_ASSERT_MSG_EQ (lines[0], "0 0.25 0.5 0", "wrong record of interval 0");
+  NS_TEST_ASSERT_MSG_EQ (lines[1], "1 0.125 - 0", "wrong record of interval 1");
+  NS_TEST_ASSERT_MSG_EQ (lines[2], "3 - 0.75 -", "wrong record of interval 3");
+
+  for (uint32_t n = 0; n < macs.size (); n++)
+    {
+      macs[n]->Dispose ();
+    }
+  sink->Dispose ();
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief ChannelUtilizationSink Test Suite
+ */
+static class ChannelUtilizationSinkTestSuite : public TestSuite
+{
+public:
+  ChannelUtilizationSinkTestSuite () : TestSuite ("channel-utilization-sink", UNIT)
+  {
+    AddTestCase (new ChannelUtilizationSinkTestCase (), TestCase::QUICK);
+  }
+} g_channelUtilizationSinkTestSuite; ///< the test suite
@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/GlobalPacketDropController.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the conflicts GlobalPacketDropController detects
+ *
+ * A CSMA send conflicts with the TDMA sends of the same 1 ms slot within
+ * 158 m. The packets carry no BsmTimeTag, so conflicts are only counted
+ * and nothing is dropped.
+ */
+class GlobalPacketDropControllerTestCase : public TestCase
+{
+public:
+  GlobalPacketDropControllerTestCase ();
+  virtual ~GlobalPacketDropControllerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Create a PHY standing at \p x on the x axis.
+   * \param x the position of the PHY, in m
+   * \return the PHY
+   */
+  static Ptr<YansWifiPhy> CreatePhy (double x);
+  /**
+   * Send a packet through the controller.
+   * \param txTime the time of the send
+   * \param phy the sender
+   * \param deviceType "tdma" or "csma"
+   * \return the number of conflicts the send added
+   */
+  static uint32_t Send (Time txTime, Ptr<YansWifiPhy> phy, std::string deviceType);
+};
+
+GlobalPacketDropControllerTestCase::GlobalPacketDropControllerTestCase ()
+  : TestCase ("Check the conflicts of TDMA and CSMA sends of a slot")
+{
+}
+
+GlobalPacketDropControllerTestCase::~GlobalPacketDropControllerTestCase ()
+{
+}
+
+Ptr<YansWifiPhy>
+GlobalPacketDropControllerTestCase::CreatePhy (double x)
+{
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (Vector (x, 0.0, 0.0));
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetMobility (mobility);
+  return phy;
+}
+
+uint32_t
+GlobalPacketDropControllerTestCase::Send (Time txTime, Ptr<YansWifiPhy> phy, std::string deviceType)
+{
+  uint32_t conflicts = GlobalPacketDropController::GetConflictCount ();
+  bool drop = GlobalPacketDropController::GetInstance ().CheckIsNeedDrop (txTime, phy, deviceType, Create<Packet> (100));
+  NS_ASSERT_MSG (!drop, "untagged packet dropped");
+  return GlobalPacketDropController::GetConflictCount () - conflicts;
+}
+
+void
+GlobalPacketDropControllerTestCase::DoRun (void)
+{
+  uint32_t drops = GlobalPacketDropController::GetDropCount ();
+  uint32_t conflicts = GlobalPacketDropController::GetConflictCount ();
+
+  // two simultaneous sends 50 m apart
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (5), CreatePhy (0), "tdma"), 0, "TDMA send conflicted");
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (5), CreatePhy (50), "csma"), 1, "nearby sends did not conflict");
+
+  // the same pair 500 m apart
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (6), CreatePhy (0), "tdma"), 0, "TDMA send conflicted");
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (6), CreatePhy (500), "csma"), 0, "far sends conflicted");
+
+  // simultaneous TDMA sends are all kept: the CSMA send near the first one conflicts
+  Ptr<YansWifiPhy> near = CreatePhy (1000);
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (7), near, "tdma"), 0, "TDMA send conflicted");
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (7), CreatePhy (3000), "tdma"), 0, "TDMA send conflicted");
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (7), CreatePhy (1100), "csma"), 1, "earlier send of the slot lost");
+  // CSMA sends do not make other CSMA sends conflict
+  NS_TEST_ASSERT_MSG_EQ (Send (MilliSeconds (7), CreatePhy (1110), "csma"), 1, "second CSMA send did not conflict");
+
+  // sends 0.2 ms apart on both sides of a slot boundary do not conflict
+  NS_TEST_ASSERT_MSG_EQ (Send (MicroSeconds (10900), CreatePhy (0), "tdma"), 0, "TDMA send conflicted");
+  NS_TEST_ASSERT_MSG_EQ (Send (MicroSeconds (11100), CreatePhy (50), "csma"), 0, "send of the previous slot kept");
+  // sends 0.8 ms apart within a slot do, even after a later send started it
+  Ptr<YansWifiPhy> tdma = CreatePhy (0);
+  NS_TEST_ASSERT_MSG_EQ (Send (MicroSeconds (20100), tdma, "tdma"), 0, "TDMA send conflicted");
+  NS_TEST_ASSERT_MSG_EQ (Send (MicroSeconds (20500), CreatePhy (500), "csma"), 0, "far sends conflicted");
+  NS_TEST_ASSERT_MSG_EQ (Send (MicroSeconds (20900), CreatePhy (50), "csma"), 1, "send of the running slot lost");
+
+  NS_TEST_ASSERT_MSG_EQ (GlobalPacketDropController::GetConflictCount () - conflicts, 4, "wrong conflict count");
+  NS_TEST_ASSERT_MSG_EQ (GlobalPacketDropController::GetDropCount () - drops, 0, "untagged packets counted as dropped");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief GlobalPacketDropController Test Suite
+ */
+static class GlobalPacketDropControllerTestSuite : public TestSuite
+{
+public:
+  GlobalPacketDropControllerTestSuite () : TestSuite ("global-packet-drop-controller", UNIT)
+  {
+    AddTestCase (new GlobalPacketDropControllerTestCase (), TestCase::QUICK);
+  }
+} g_globalPacketDropControllerTestSuite; ///< the test suite
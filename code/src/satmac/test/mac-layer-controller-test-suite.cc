@@ -0,0 +1,497 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/pointer.h"
+#include "ns3/node.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/bsm-timetag.h"
+#include "ns3/AperiodicTag.h"
+#include "ns3/tdma-satmac.h"
+#include "ns3/MacLayerController.h"
+#include "ns3/MacSwitchPolicy.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Create a node with a TDMA and a CSMA device, each on its channel.
+ * \param tdma the channel of the TDMA device
+ * \param csma the channel of the CSMA device
+ * \param x the position of the node on the x axis
+ * \return the node
+ */
+static Ptr<Node>
+CreateNode (Ptr<YansWifiChannel> tdma, Ptr<YansWifiChannel> csma, double x)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (Vector (x, 0.0, 0.0));
+  node->AggregateObject (mobility);
+  ObjectFactory mac;
+  mac.SetTypeId ("ns3::AdhocWifiMac");
+  ObjectFactory manager;
+  manager.SetTypeId ("ns3::ConstantRateWifiManager");
+  Ptr<YansWifiChannel> channels[2] = { tdma, csma };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+      Ptr<WifiMac> wifiMac = mac.Create<WifiMac> ();
+      wifiMac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      wifiMac->SetAddress (Mac48Address::Allocate ());
+      dev->SetMac (wifiMac);
+      dev->SetRemoteStationManager (manager.Create<WifiRemoteStationManager> ());
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+      phy->SetChannel (channels[i]);
+      phy->SetDevice (dev);
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      dev->SetPhy (phy);
+      node->AddDevice (dev);
+    }
+  return node;
+}
+
+/**
+ * Create the TDMA and the CSMA channels.
+ * \param channels the channels created
+ */
+static void
+CreateChannels (Ptr<YansWifiChannel> channels[2])
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      channels[i] = CreateObject<YansWifiChannel> ();
+      channels[i]->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+      channels[i]->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+    }
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the handoff of the aperiodic queue between the TDMA and CSMA macs
+ *
+ * The TDMA mac keeps its periodic packets and shares the queue of the
+ * CSMA txop for the aperiodic ones. Switching to CSMA drops the packets
+ * without a BSM time tag or older than 100 ms wherever they are queued,
+ * and resumes the txop; switching back suspends it. The packets left
+ * keep their order and their queueing time through the handoffs.
+ */
+class MacLayerControllerTestCase : public TestCase
+{
+public:
+  MacLayerControllerTestCase ();
+  virtual ~MacLayerControllerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Queue a packet on the TDMA mac, as OcbWifiMac::Enqueue does.
+   * \param aperiodic whether the packet carries an AperiodicTag
+   * \param sent the BSM sending time of the packet, negative for none
+   * \return the uid of the packet
+   */
+  uint64_t Queue (bool aperiodic, Time sent);
+  /**
+   * Check the next packet the TDMA mac sends, and take it out.
+   * \param uid the expected packet, 0 if none
+   */
+  void CheckTdmaNext (uint64_t uid);
+  /**
+   * Check the heads of the queues.
+   * \param tdmaSize the size of the TDMA queue
+   * \param tdmaHead the time the head of the TDMA queue was queued
+   * \param sharedSize the number of packets in the shared queue, including
+   *        the expired ones it has not dropped yet
+   * \param sharedHead the time the head of the shared queue was queued
+   */
+  void CheckQueues (uint32_t tdmaSize, Time tdmaHead, uint32_t sharedSize, Time sharedHead);
+  /**
+   * Record a transmission of the CSMA device.
+   * \param packet the packet
+   */
+  void CsmaTxBegin (Ptr<const Packet> packet);
+
+  Ptr<TdmaSatmac> m_satmac;              ///< the TDMA mac
+  Ptr<Txop> m_txop;                      ///< the CSMA txop
+  Ptr<MacLayerController> m_controller;  ///< the controller
+  std::vector<uint64_t> m_csmaTx;        ///< uids of the packets the CSMA device sent
+  std::vector<Time> m_csmaTxTime;        ///< times the CSMA device sent them
+};
+
+MacLayerControllerTestCase::MacLayerControllerTestCase ()
+  : TestCase ("Check the handoff of the aperiodic queue between the TDMA and CSMA macs")
+{
+}
+
+MacLayerControllerTestCase::~MacLayerControllerTestCase ()
+{
+}
+
+uint64_t
+MacLayerControllerTestCase::Queue (bool aperiodic, Time sent)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  if (aperiodic)
+    {
+      AperiodicTag tag;
+      packet->AddPacketTag (tag);
+    }
+  if (!sent.IsNegative ())
+    {
+      BsmTimeTag bsmtag;
+      bsmtag.setSendingTimeUs (sent.GetMicroSeconds ());
+      packet->AddPacketTag (bsmtag);
+    }
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_DATA);
+  hdr.SetAddr1 (Mac48Address::GetBroadcast ());
+  hdr.SetAddr2 (Mac48Address::Allocate ());
+  hdr.SetAddr3 (Mac48Address::GetBroadcast ());
+  hdr.SetDsNotFrom ();
+  hdr.SetDsNotTo ();
+  m_satmac->Queue (packet, hdr);
+  return packet->GetUid ();
+}
+
+void
+MacLayerControllerTestCase::CheckTdmaNext (uint64_t uid)
+{
+  WifiMacHeader hdr;
+  Ptr<const Packet> packet = m_satmac->PeekNext (&hdr);
+  NS_TEST_EXPECT_MSG_EQ ((packet == 0 ? 0 : packet->GetUid ()), uid, "wrong next TDMA packet at " << Simulator::Now ());
+  if (packet != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_satmac->DequeueNext (&hdr), packet, "dequeued another packet than the one peeked");
+    }
+}
+
+void
+MacLayerControllerTestCase::CheckQueues (uint32_t tdmaSize, Time tdmaHead, uint32_t sharedSize, Time sharedHead)
+{
+  // peeking drops the expired packets at the head of the TDMA queue
+  Ptr<TdmaMacQueue> tdma_q = m_satmac->GetTdmaQueue ();
+  WifiMacHeader hdr;
+  Time tstamp;
+  if (tdma_q->Peek (&hdr, &tstamp) != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (tstamp, tdmaHead, "wrong TDMA queue head at " << Simulator::Now ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (tdma_q->GetSize (), tdmaSize, "wrong TDMA queue size at " << Simulator::Now ());
+  Ptr<WifiMacQueue> shared = m_txop->GetWifiMacQueue ();
+  // WifiMacQueue::GetNPackets would drop the expired packets anywhere in the queue
+  NS_TEST_EXPECT_MSG_EQ (shared->QueueBase::GetNPackets (), sharedSize, "wrong shared queue size at " << Simulator::Now ());
+  Ptr<const WifiMacQueueItem> item = shared->Peek ();
+  if (item != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (item->GetTimeStamp (), sharedHead, "wrong shared queue head at " << Simulator::Now ());
+    }
+}
+
+void
+MacLayerControllerTestCase::CsmaTxBegin (Ptr<const Packet> packet)
+{
+  m_csmaTx.push_back (packet->GetUid ());
+  m_csmaTxTime.push_back (Simulator::Now ());
+}
+
+void
+MacLayerControllerTestCase::DoRun (void)
+{
+  Ptr<YansWifiChannel> channels[2];
+  CreateChannels (channels);
+  Ptr<Node> node = CreateNode (channels[0], channels[1], 0.0);
+  CreateNode (channels[0], channels[1], 50.0);
+  Ptr<WifiNetDevice> tdma = DynamicCast<WifiNetDevice> (node->GetDevice (0));
+  Ptr<WifiNetDevice> csma = DynamicCast<WifiNetDevice> (node->GetDevice (1));
+  csma->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&MacLayerControllerTestCase::CsmaTxBegin, this));
+  PointerValue ptr;
+  csma->GetMac ()->GetAttribute ("Txop", ptr);
+  m_txop = ptr.Get<Txop> ();
+
+  // a TDMA mac which never sends by itself
+  m_satmac = CreateObject<TdmaSatmac> ();
+  m_controller = CreateObject<MacLayerController> ();
+  m_controller->m_tdmaDevice = tdma;
+  m_controller->m_csmaDevice = csma;
+  m_controller->m_currentDevice = tdma;
+  m_controller->m_node = node;
+  m_controller->ShareAperiodicQueue (m_satmac, m_txop);
+
+  Time start = MilliSeconds (200);
+  Time none = Seconds (-1);
+  // aperiodic packets go to the shared queue, periodic ones to the TDMA
+  // queue; some of each have no BSM time tag or one older than 100 ms
+  Simulator::Stop (start);
+  Simulator::Run ();
+  uint64_t a1 = Queue (true, start - MilliSeconds (10));
+  Queue (true, none);
+  Queue (true, start - MilliSeconds (100));
+  Simulator::Stop (MicroSeconds (500));
+  Simulator::Run ();
+  uint64_t p1 = Queue (false, start);
+  Queue (false, none);
+  Simulator::Stop (MicroSeconds (500));
+  Simulator::Run ();
+  uint64_t a2 = Queue (true, start);
+  Queue (false, start - MilliSeconds (150));
+  uint64_t p2 = Queue (false, start + MilliSeconds (1));
+  CheckQueues (4, start + MicroSeconds (500), 4, start);
+
+  // nothing leaves on CSMA while the TDMA mac owns the shared queue
+  Simulator::Stop (MilliSeconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_csmaTx.size (), 0, "CSMA sent while the TDMA device was current");
+
+  // TDMA -> CSMA -> TDMA before the txop resumes
+  // nothing is dropped by the handoff itself: the packets queued before it
+  // which have no BSM time tag or one older than 100 ms are dropped once
+  // they reach the head of their queue
+  m_controller->SwitchToDevice (csma);
+  CheckQueues (4, start + MicroSeconds (500), 4, start);
+  m_controller->SwitchToDevice (tdma);
+  Simulator::Stop (MilliSeconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_csmaTx.size (), 0, "CSMA sent after switching back to TDMA");
+  CheckQueues (4, start + MicroSeconds (500), 4, start);
+  // the older head of both queues goes first
+  CheckTdmaNext (a1);
+  CheckTdmaNext (p1);
+  CheckQueues (1, start + MilliSeconds (1), 3, start + MilliSeconds (1));
+
+  // TDMA -> CSMA: the txop sends the shared queue, the TDMA mac keeps its own
+  Time handoff = Simulator::Now ();
+  m_controller->SwitchToDevice (csma);
+  Simulator::Stop (MilliSeconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_csmaTx.size (), 1, "CSMA did not send after the handoff");
+  NS_TEST_EXPECT_MSG_EQ (m_csmaTx[0], a2, "CSMA sent another packet");
+  NS_TEST_EXPECT_MSG_LT (m_csmaTxTime[0], handoff + MicroSeconds (500), "CSMA resumed late");
+  CheckTdmaNext (p2);
+  CheckTdmaNext (0);
+
+  // packets queued while the txop serves the shared queue make it request access
+  Time queued = Simulator::Now ();
+  uint64_t a3 = Queue (true, queued);
+  Simulator::Stop (MilliSeconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_csmaTx.size (), 2, "CSMA did not send a packet queued while it was current");
+  NS_TEST_EXPECT_MSG_EQ (m_csmaTx[1], a3, "CSMA sent another packet");
+  NS_TEST_EXPECT_MSG_LT (m_csmaTxTime[1], queued + MicroSeconds (500), "CSMA requested access late");
+
+  m_satmac->Dispose ();
+  m_controller->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the device switches at the start and at the end of a slot group
+ *
+ * Without a switching policy, the node uses CSMA during every slot group
+ * and TDMA after it, whatever the load. With one, the TDMA mac checks the
+ * device at the start and at the end of its slot group. An idle node, or
+ * one which has not heard a frame yet, stays on TDMA. A congested frame
+ * moves it to CSMA at the start of the slot group, and it stays there at
+ * the end while the frame is congested.
+ */
+class MacLayerControllerSlotGroupTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param policy whether the controller has a switching policy
+   */
+  MacLayerControllerSlotGroupTestCase (bool policy);
+  virtual ~MacLayerControllerSlotGroupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Mark slots [\p start, \p frameLen) of the frame busy, the rest free.
+   * \param start the first busy slot
+   */
+  void SetBusyFrom (int start);
+  /**
+   * Run the slot group starting on the current slot, and check the device
+   * after its start and after its end.
+   * \param atStart whether CSMA is expected after the start
+   * \param atEnd whether CSMA is expected after the end
+   */
+  void RunSlotGroup (bool atStart, bool atEnd);
+  /**
+   * Record a decision of the controller.
+   * \param load the load of the node
+   * \param useCsma whether CSMA was chosen
+   */
+  void SwitchDecision (const MacSwitchPolicy::Load &load, bool useCsma);
+
+  static const int FRAME_LEN = 64;       ///< the frame length
+  bool m_policy;                         ///< whether the controller has a switching policy
+  Ptr<TdmaSatmac> m_satmac;              ///< the TDMA mac
+  Ptr<MacLayerController> m_controller;  ///< the controller
+  std::vector<bool> m_decisions;         ///< the decisions of the controller
+};
+
+MacLayerControllerSlotGroupTestCase::MacLayerControllerSlotGroupTestCase (bool policy)
+  : TestCase (policy ? "Check that the slot group switches follow the switching policy"
+                     : "Check the slot group switches without a switching policy"),
+    m_policy (policy)
+{
+}
+
+MacLayerControllerSlotGroupTestCase::~MacLayerControllerSlotGroupTestCase ()
+{
+}
+
+void
+MacLayerControllerSlotGroupTestCase::SetBusyFrom (int start)
+{
+  slot_tag *fi = m_satmac->collected_fi_->slot_describe;
+  for (int i = 0; i < FRAME_LEN; i++)
+    {
+      fi[i] = slot_tag ();
+      if (i >= start)
+        {
+          fi[i].busy = SLOT_1HOP;
+          fi[i].sti = i + 2;
+        }
+    }
+}
+
+void
+MacLayerControllerSlotGroupTestCase::RunSlotGroup (bool atStart, bool atEnd)
+{
+  // the first 4 slots are free, as slotgroupHandler finds them
+  m_satmac->SlotGroupStart ();
+  Simulator::Stop (MilliSeconds (1));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ ((m_controller->GetCurrentDevice () == m_controller->GetCsmaDevice ()), atStart,
+                         "wrong device in the slot group at " << Simulator::Now ());
+  // SlotGroupEnd is due 1 ns before the last free slot
+  Simulator::Stop (MilliSeconds (2));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ ((m_controller->GetCurrentDevice () == m_controller->GetCsmaDevice ()), atEnd,
+                         "wrong device after the slot group at " << Simulator::Now ());
+}
+
+void
+MacLayerControllerSlotGroupTestCase::SwitchDecision (const MacSwitchPolicy::Load &load, bool useCsma)
+{
+  m_decisions.push_back (useCsma);
+}
+
+void
+MacLayerControllerSlotGroupTestCase::DoRun (void)
+{
+  Ptr<YansWifiChannel> channels[2];
+  CreateChannels (channels);
+  Ptr<Node> node = CreateNode (channels[0], channels[1], 0.0);
+  CreateNode (channels[0], channels[1], 50.0);
+  Ptr<WifiNetDevice> tdma = DynamicCast<WifiNetDevice> (node->GetDevice (0));
+  Ptr<WifiNetDevice> csma = DynamicCast<WifiNetDevice> (node->GetDevice (1));
+  PointerValue ptr;
+  csma->GetMac ()->GetAttribute ("Txop", ptr);
+
+  // a TDMA mac which never sends by itself, before its first frame
+  m_satmac = CreateObject<TdmaSatmac> ();
+  m_satmac->setNodePtr (node);
+  m_satmac->SetFrameLen (FRAME_LEN);
+  m_satmac->slot_group_length = 4;
+  m_satmac->slot_count_ = 0;
+  m_controller = CreateObject<MacLayerController> ();
+  if (m_policy)
+    {
+      m_controller->SetAttribute ("SwitchPolicy", PointerValue (CreateObject<LoadSwitchPolicy> ()));
+    }
+  m_controller->TraceConnectWithoutContext ("SwitchDecision",
+                                            MakeCallback (&MacLayerControllerSlotGroupTestCase::SwitchDecision, this));
+  m_controller->m_tdmaDevice = tdma;
+  m_controller->m_csmaDevice = csma;
+  m_controller->m_currentDevice = tdma;
+  m_controller->m_node = node;
+  m_controller->ShareAperiodicQueue (m_satmac, ptr.Get<Txop> ());
+  node->AggregateObject (m_controller);
+
+  if (!m_policy)
+    {
+      // CSMA during every slot group, idle or congested, and TDMA after it
+      m_satmac->collected_fi_ = new Frame_info (FRAME_LEN);
+      RunSlotGroup (true, false);
+      SetBusyFrom (4);
+      RunSlotGroup (true, false);
+      NS_TEST_EXPECT_MSG_EQ (m_decisions.size (), 0, "the controller consulted a policy");
+      m_satmac->Dispose ();
+      m_controller->Dispose ();
+      Simulator::Destroy ();
+      return;
+    }
+
+  // no frame heard: nothing is known to be congested
+  m_controller->CheckAndSwitch ();
+  NS_TEST_EXPECT_MSG_EQ ((m_controller->GetCurrentDevice () == tdma), true, "left TDMA before the first frame");
+
+  // as Start sets it; an idle frame
+  m_satmac->collected_fi_ = new Frame_info (FRAME_LEN);
+  RunSlotGroup (false, false);
+
+  // 60 busy slots and a single available slot group: CSMA, kept at the end
+  SetBusyFrom (4);
+  RunSlotGroup (true, true);
+  // the frame clears during the next slot group: back to TDMA at its end
+  Simulator::Schedule (MilliSeconds (2), &MacLayerControllerSlotGroupTestCase::SetBusyFrom, this, FRAME_LEN);
+  RunSlotGroup (true, false);
+
+  const bool expected[] = { false, false, false, true, true, true, false };
+  const uint32_t nbExpected = sizeof (expected) / sizeof (expected[0]);
+  NS_TEST_ASSERT_MSG_EQ (m_decisions.size (), nbExpected, "wrong number of device checks");
+  for (uint32_t i = 0; i < nbExpected; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_decisions[i], expected[i], "wrong decision " << i);
+    }
+
+  m_satmac->Dispose ();
+  m_controller->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief MacLayerController Test Suite
+ */
+static class MacLayerControllerTestSuite : public TestSuite
+{
+public:
+  MacLayerControllerTestSuite () : TestSuite ("mac-layer-controller", UNIT)
+  {
+    AddTestCase (new MacLayerControllerTestCase (), TestCase::QUICK);
+    AddTestCase (new MacLayerControllerSlotGroupTestCase (false), TestCase::QUICK);
+    AddTestCase (new MacLayerControllerSlotGroupTestCase (true), TestCase::QUICK);
+  }
+} g_macLayerControllerTestSuite; ///< the test suite
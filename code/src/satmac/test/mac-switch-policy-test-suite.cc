@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/MacSwitchPolicy.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the thresholds and the hysteresis of LoadSwitchPolicy
+ */
+class LoadSwitchPolicyTestCase : public TestCase
+{
+public:
+  LoadSwitchPolicyTestCase ();
+  virtual ~LoadSwitchPolicyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LoadSwitchPolicyTestCase::LoadSwitchPolicyTestCase ()
+  : TestCase ("Check the thresholds and the hysteresis of LoadSwitchPolicy")
+{
+}
+
+LoadSwitchPolicyTestCase::~LoadSwitchPolicyTestCase ()
+{
+}
+
+void
+LoadSwitchPolicyTestCase::DoRun (void)
+{
+  Ptr<LoadSwitchPolicy> policy = CreateObject<LoadSwitchPolicy> ();
+  policy->SetAttribute ("UtilizationThreshold", DoubleValue (0.8));
+  policy->SetAttribute ("QueueThreshold", UintegerValue (10));
+  policy->SetAttribute ("AgeThreshold", TimeValue (MilliSeconds (50)));
+  policy->SetAttribute ("SlotGroupThreshold", DoubleValue (0.25));
+  policy->SetAttribute ("Hysteresis", DoubleValue (0.2));
+
+  MacSwitchPolicy::Load idle;
+  idle.queueSize = 0;
+  idle.headAge = Seconds (0);
+  idle.channelUtilization = 0.3;
+  idle.slotGroupRatio = 0.8;
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (idle, false), false, "idle node left TDMA");
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (idle, true), false, "idle node stayed on CSMA");
+
+  // each signal alone moves the node to CSMA
+  MacSwitchPolicy::Load load = idle;
+  load.channelUtilization = 0.8;
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (load, false), true, "utilization threshold ignored");
+  load = idle;
+  load.queueSize = 10;
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (load, false), true, "queue threshold ignored");
+  load = idle;
+  load.headAge = MilliSeconds (50);
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (load, false), true, "age threshold ignored");
+  load = idle;
+  load.slotGroupRatio = 0.25;
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (load, false), true, "slot group threshold ignored");
+
+  // just below the thresholds: TDMA stays, CSMA is kept by the hysteresis
+  load = idle;
+  load.channelUtilization = 0.7;
+  load.queueSize = 9;
+  load.headAge = MilliSeconds (45);
+  load.slotGroupRatio = 0.28;
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (load, false), false, "left TDMA below the thresholds");
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (load, true), true, "left CSMA within the hysteresis");
+
+  // clear of the hysteresis margin on every signal
+  load.channelUtilization = 0.6;
+  load.queueSize = 7;
+  load.headAge = MilliSeconds (35);
+  load.slotGroupRatio = 0.35;
+  NS_TEST_EXPECT_MSG_EQ (policy->UseCsma (load, true), false, "stayed on CSMA past the hysteresis");
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief MacSwitchPolicy Test Suite
+ */
+static class MacSwitchPolicyTestSuite : public TestSuite
+{
+public:
+  MacSwitchPolicyTestSuite () : TestSuite ("satmac-mac-switch-policy", UNIT)
+  {
+    AddTestCase (new LoadSwitchPolicyTestCase (), TestCase::QUICK);
+  }
+} g_macSwitchPolicyTestSuite; ///< the test suite
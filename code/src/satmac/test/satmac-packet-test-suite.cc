@@ -0,0 +1,554 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/satmac-packet.h"
+#include "ns3/tdma-satmac.h"
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::satmac;
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the FI wire format against a bit at a time reference encoder
+ */
+class FiHeaderFormatTestCase : public TestCase
+{
+public:
+  FiHeaderFormatTestCase ();
+  virtual ~FiHeaderFormatTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Append the low \p length bits of \p value, msb first, one bit at a time.
+   * \param bits the bit string to append to
+   * \param value the field value
+   * \param length the field width in bits
+   */
+  static void AppendBits (std::vector<bool> &bits, uint32_t value, int length);
+};
+
+FiHeaderFormatTestCase::FiHeaderFormatTestCase ()
+  : TestCase ("Check the FI wire format against a reference encoder")
+{
+}
+
+FiHeaderFormatTestCase::~FiHeaderFormatTestCase ()
+{
+}
+
+void
+FiHeaderFormatTestCase::AppendBits (std::vector<bool> &bits, uint32_t value, int length)
+{
+  for (int i = length - 1; i >= 0; i--)
+    {
+      bits.push_back ((value >> i) & 1);
+    }
+}
+
+void
+FiHeaderFormatTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  int frameLengths[] = { 1, 3, 16, 32, 100, 128, 512 };
+  for (uint32_t f = 0; f < sizeof (frameLengths) / sizeof (frameLengths[0]); f++)
+    {
+      int frameLen = frameLengths[f];
+      int globalSti = rng->GetInteger (1, 4095);
+      std::vector<slot_tag> table (frameLen);
+      std::vector<bool> bits;
+      int exponent = 0;
+      while ((2 << exponent) <= frameLen)
+        {
+          exponent++;
+        }
+      AppendBits (bits, globalSti, BIT_LENGTH_STI);
+      AppendBits (bits, exponent, BIT_LENGTH_FRAMELEN);
+      for (int i = 0; i < frameLen; i++)
+        {
+          table[i].busy = rng->GetInteger (0, 3);
+          // stis wider than the field are truncated, counts saturate
+          table[i].sti = rng->GetInteger (0, 5000);
+          table[i].count_2hop = rng->GetInteger (0, 6);
+          AppendBits (bits, table[i].busy, BIT_LENGTH_BUSY);
+          AppendBits (bits, table[i].sti, BIT_LENGTH_STI);
+          AppendBits (bits, std::min (table[i].count_2hop, (1 << BIT_LENGTH_COUNT) - 1), BIT_LENGTH_COUNT);
+          AppendBits (bits, table[i].psf, BIT_LENGTH_PSF);
+        }
+      while (bits.size () % 8 != 0)
+        {
+          bits.push_back (false);
+        }
+
+      FiHeader header (frameLen, globalSti, &table[0]);
+      NS_TEST_ASSERT_MSG_EQ (header.GetSerializedSize (), bits.size () / 8, "wrong FI size for frame length " << frameLen);
+      uint8_t *buffer = header.GetBuffer ();
+      for (uint32_t i = 0; i < bits.size () / 8; i++)
+        {
+          uint8_t expected = 0;
+          for (uint32_t j = 0; j < 8; j++)
+            {
+              expected = (expected << 1) | bits[i * 8 + j];
+            }
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t) buffer[i], (uint32_t) expected, "wrong FI byte " << i << " for frame length " << frameLen);
+        }
+    }
+
+  // setvalue writes the same bits at every alignment
+  for (int length = 1; length <= 8; length++)
+    {
+      for (int start = 0; start < 8; start++)
+        {
+          unsigned char buffer[3] = { 0, 0, 0 };
+          int bytePos = 0;
+          int bitPos = 7 - start;
+          FiHeader::setvalue (0xa5, length, buffer, bytePos, bitPos);
+          uint32_t word = (buffer[0] << 16) | (buffer[1] << 8) | buffer[2];
+          uint32_t expected = (0xa5 & ((1 << length) - 1)) << (24 - start - length);
+          NS_TEST_ASSERT_MSG_EQ (word, expected, "setvalue of " << length << " bits at bit " << start);
+          NS_TEST_ASSERT_MSG_EQ (bytePos * 8 + 7 - bitPos, start + length, "setvalue left the wrong position");
+        }
+    }
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Round trip FIs through a packet
+ */
+class FiHeaderRoundTripTestCase : public TestCase
+{
+public:
+  FiHeaderRoundTripTestCase ();
+  virtual ~FiHeaderRoundTripTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FiHeaderRoundTripTestCase::FiHeaderRoundTripTestCase ()
+  : TestCase ("Round trip FIs through a packet")
+{
+}
+
+FiHeaderRoundTripTestCase::~FiHeaderRoundTripTestCase ()
+{
+}
+
+void
+FiHeaderRoundTripTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  int frameLengths[] = { 16, 32, 64, 128, 256, 512 };
+  for (uint32_t f = 0; f < sizeof (frameLengths) / sizeof (frameLengths[0]); f++)
+    {
+      int frameLen = frameLengths[f];
+      int globalSti = rng->GetInteger (1, 4095);
+      std::vector<slot_tag> table (frameLen);
+      std::vector<slot_tag> sent (frameLen);
+      for (int i = 0; i < frameLen; i++)
+        {
+          table[i].busy = rng->GetInteger (0, 3);
+          table[i].sti = rng->GetInteger (0, 4095);
+          table[i].count_2hop = rng->GetInteger (0, 3);
+          sent[i] = table[i];
+        }
+
+      Ptr<Packet> p = Create<Packet> ();
+      FiHeader sentHeader (frameLen, globalSti, &table[0]);
+      p->AddHeader (sentHeader);
+      // receivers decode their own copy of the sent packet
+      Ptr<Packet> received = p->Copy ();
+
+      FiHeader header;
+      received->RemoveHeader (header);
+      NS_TEST_ASSERT_MSG_EQ (received->GetSize (), 0, "the FI did not consume the packet");
+      unsigned int bytePos = 0;
+      unsigned int bitPos = 7;
+      NS_TEST_ASSERT_MSG_EQ (header.decode_value (bytePos, bitPos, BIT_LENGTH_STI), (unsigned long) globalSti, "wrong sti");
+      NS_TEST_ASSERT_MSG_EQ (1 << header.decode_value (bytePos, bitPos, BIT_LENGTH_FRAMELEN), frameLen, "wrong frame length");
+
+      Frame_info fi (frameLen);
+      for (int i = 0; i < frameLen; i++)
+        {
+          header.decode_slot_tag (bytePos, bitPos, i, &fi);
+          NS_TEST_ASSERT_MSG_EQ ((int) fi.slot_describe[i].busy, (int) sent[i].busy, "wrong busy in slot " << i);
+          NS_TEST_ASSERT_MSG_EQ (fi.slot_describe[i].sti, sent[i].sti, "wrong sti in slot " << i);
+          NS_TEST_ASSERT_MSG_EQ (fi.slot_describe[i].count_2hop, sent[i].count_2hop, "wrong count in slot " << i);
+        }
+
+      // out of order reads restart from the requested position
+      for (int k = 0; k < 20; k++)
+        {
+          int slot = rng->GetInteger (0, frameLen - 1);
+          unsigned int bit = BIT_LENGTH_STI + BIT_LENGTH_FRAMELEN + slot * BIT_LENGTH_SLOT_TAG + BIT_LENGTH_BUSY;
+          bytePos = bit / 8;
+          bitPos = 7 - bit % 8;
+          NS_TEST_ASSERT_MSG_EQ (header.decode_value (bytePos, bitPos, BIT_LENGTH_STI), (unsigned long) sent[slot].sti, "wrong sti read back from slot " << slot);
+        }
+    }
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check that the received FI store stops allocating once warmed up
+ *
+ * Drives a Frame_info_list the way TdmaSatmac does: a varying number of FIs
+ * of mixed frame lengths per frame, each alive for one frame, and one fade
+ * per slot.
+ */
+class FiListAllocationTestCase : public TestCase
+{
+public:
+  FiListAllocationTestCase ();
+  virtual ~FiListAllocationTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Receive a frame worth of FIs into \p list.
+   * \param list the store under test
+   * \param rng draws the number and frame length of the FIs
+   * \param frameLen the slots in a frame, also the FI lifetime
+   * \param maxFis the most FIs received in one frame
+   */
+  void RunFrame (Frame_info_list &list, Ptr<UniformRandomVariable> rng, int frameLen, int maxFis);
+};
+
+FiListAllocationTestCase::FiListAllocationTestCase ()
+  : TestCase ("Check the received FI store does not allocate after warm-up")
+{
+}
+
+FiListAllocationTestCase::~FiListAllocationTestCase ()
+{
+}
+
+void
+FiListAllocationTestCase::RunFrame (Frame_info_list &list, Ptr<UniformRandomVariable> rng, int frameLen, int maxFis)
+{
+  int fis = rng->GetInteger (0, maxFis);
+  std::vector<int> slots;
+  for (int i = 0; i < fis; i++)
+    {
+      slots.push_back (rng->GetInteger (0, frameLen - 1));
+    }
+  std::sort (slots.begin (), slots.end ());
+  int received = 0;
+  for (int slot = 0; slot < frameLen; slot++)
+    {
+      while (received < fis && slots[received] == slot)
+        {
+          int len = rng->GetInteger (0, 1) ? frameLen : frameLen / 2;
+          Frame_info *fi = list.append (len, frameLen);
+          fi->sti = received + 1;
+          received++;
+        }
+      if (slot == frameLen - 1)
+        {
+          // every FI of this frame is still alive, none of the previous one is
+          NS_TEST_ASSERT_MSG_EQ (list.size (), fis, "wrong number of FIs held at the end of a frame");
+          for (int i = 0; i < list.size (); i++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (list.is_alive (list.at (i)), true, "expired FI still held");
+              NS_TEST_ASSERT_MSG_EQ (list.at (i)->sti, i + 1, "FIs held out of order");
+            }
+        }
+      list.fade (1);
+    }
+}
+
+void
+FiListAllocationTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  const int frameLen = 128;
+  const int maxFis = 40;
+
+  Frame_info_list list;
+  list.reserve (16, frameLen);
+  NS_TEST_ASSERT_MSG_GT (list.get_alloc_count (), 0, "reserve did not allocate");
+
+  // warm up with busy frames until every record of the ring has held a full FI
+  for (int frame = 0; frame < 4; frame++)
+    {
+      for (int i = 0; i < maxFis; i++)
+        {
+          list.append (frameLen, frameLen);
+        }
+      list.fade (frameLen);
+    }
+  NS_TEST_ASSERT_MSG_EQ (list.size (), 0, "fade did not expire the warm-up FIs");
+  long long warm = list.get_alloc_count ();
+
+  for (int frame = 0; frame < 200; frame++)
+    {
+      RunFrame (list, rng, frameLen, maxFis);
+    }
+  NS_TEST_ASSERT_MSG_EQ (list.get_alloc_count (), warm, "the FI store allocated after warm-up");
+
+  // a longer frame grows the records once, then stays flat again
+  list.fade (0);
+  list.reserve (16, 2 * frameLen);
+  long long grown = list.get_alloc_count ();
+  NS_TEST_ASSERT_MSG_GT (grown, warm, "reserve did not grow the slot arrays");
+  for (int frame = 0; frame < 100; frame++)
+    {
+      RunFrame (list, rng, 2 * frameLen, maxFis);
+    }
+  NS_TEST_ASSERT_MSG_EQ (list.get_alloc_count (), grown, "the FI store allocated after a frame length change");
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the slot states merge_fi derives from known FIs
+ */
+class MergeFiTestCase : public TestCase
+{
+public:
+  MergeFiTestCase ();
+  virtual ~MergeFiTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Set a slot of a FI.
+   * \param tag the slot
+   * \param sti the slot holder
+   * \param busy the slot state
+   * \param count2hop the 2 hop count
+   * \param count3hop the 3 hop count
+   */
+  static void SetTag (slot_tag &tag, int sti, int busy, int count2hop, int count3hop);
+  /**
+   * Check a merged slot.
+   * \param tag the slot
+   * \param slot the slot index, for the messages
+   * \param sti the expected slot holder
+   * \param busy the expected slot state
+   * \param count2hop the expected 2 hop count
+   * \param count3hop the expected 3 hop count
+   * \param lifeTime the expected life time
+   */
+  void CheckTag (const slot_tag &tag, int slot, int sti, int busy, int count2hop, int count3hop, int lifeTime);
+  /**
+   * Create a mac holding a local FI of \p frameLen slots.
+   * \param frameLen the frame length
+   * \return the mac
+   */
+  static Ptr<TdmaSatmac> CreateMac (int frameLen);
+  /// Merge a FI covering every slot state into the local one
+  void MergeSlotStates (void);
+  /// Merge a FI in which the sender takes a slot before a hidden station check
+  void MergeSenderSlots (void);
+  /// Merge a FI of a longer frame
+  void MergeLongerFrame (void);
+
+  static const int OWN_STI = 1;    ///< the sti of the merging node
+  static const int SLOT_LIFE = 3;  ///< the slot life time in frames
+};
+
+MergeFiTestCase::MergeFiTestCase ()
+  : TestCase ("Check the slot states merged from known FIs")
+{
+}
+
+MergeFiTestCase::~MergeFiTestCase ()
+{
+}
+
+void
+MergeFiTestCase::SetTag (slot_tag &tag, int sti, int busy, int count2hop, int count3hop)
+{
+  tag = slot_tag ();
+  tag.sti = sti;
+  tag.busy = busy;
+  tag.count_2hop = count2hop;
+  tag.count_3hop = count3hop;
+}
+
+void
+MergeFiTestCase::CheckTag (const slot_tag &tag, int slot, int sti, int busy, int count2hop, int count3hop, int lifeTime)
+{
+  NS_TEST_ASSERT_MSG_EQ (tag.sti, sti, "wrong sti in slot " << slot);
+  NS_TEST_ASSERT_MSG_EQ ((int) tag.busy, busy, "wrong busy in slot " << slot);
+  NS_TEST_ASSERT_MSG_EQ (tag.count_2hop, count2hop, "wrong 2 hop count in slot " << slot);
+  NS_TEST_ASSERT_MSG_EQ (tag.count_3hop, count3hop, "wrong 3 hop count in slot " << slot);
+  NS_TEST_ASSERT_MSG_EQ (tag.life_time, lifeTime, "wrong life time in slot " << slot);
+}
+
+Ptr<TdmaSatmac>
+MergeFiTestCase::CreateMac (int frameLen)
+{
+  Ptr<TdmaSatmac> mac = CreateObject<TdmaSatmac> ();
+  mac->SetGlobalSti (OWN_STI);
+  mac->SetFrameLen (frameLen);
+  mac->SetSlotLife (SLOT_LIFE);
+  delete mac->collected_fi_;
+  mac->collected_fi_ = new Frame_info (16);
+  mac->collected_fi_->sti = OWN_STI;
+  return mac;
+}
+
+void
+MergeFiTestCase::MergeSlotStates (void)
+{
+  const int frameLen = 12;
+  const int sender = 5;
+  Ptr<TdmaSatmac> mac = CreateMac (frameLen);
+  slot_tag *local = mac->collected_fi_->slot_describe;
+  Frame_info fi (frameLen);
+  fi.sti = sender;
+  slot_tag *recv = fi.slot_describe;
+
+  // our slot, taken by a neighbour of the sender with a higher psf
+  SetTag (local[0], OWN_STI, SLOT_1HOP, 1, 1);
+  SetTag (recv[0], 7, SLOT_1HOP, 2, 0);
+  recv[0].psf = 1;
+  // our slot, seen free by the sender
+  SetTag (local[1], OWN_STI, SLOT_1HOP, 1, 1);
+  SetTag (recv[1], OWN_STI, SLOT_FREE, 0, 0);
+  // our slot, unknown to a sender we already hear
+  SetTag (local[2], OWN_STI, SLOT_1HOP, 1, 1);
+  SetTag (recv[2], 0, SLOT_FREE, 0, 0);
+  // a slot the sender released
+  SetTag (local[3], sender, SLOT_1HOP, 1, 1);
+  local[3].life_time = 2;
+  SetTag (recv[3], 0, SLOT_FREE, 0, 0);
+  // a 2 hop slot the sender hears directly
+  SetTag (local[4], 9, SLOT_2HOP, 1, 1);
+  SetTag (recv[4], 9, SLOT_1HOP, 2, 0);
+  // a free slot the sender took
+  SetTag (recv[5], sender, SLOT_1HOP, 1, 0);
+  // the slot of the sender, confirmed
+  SetTag (local[6], sender, SLOT_1HOP, 1, 1);
+  SetTag (recv[6], sender, SLOT_1HOP, 1, 0);
+  // a free slot held 2 hops from the sender
+  SetTag (recv[7], 8, SLOT_2HOP, 2, 0);
+  // a free slot in collision at the sender
+  SetTag (recv[8], 11, SLOT_COLLISION, 1, 0);
+  // a 2 hop slot held by another neighbour of the sender
+  SetTag (local[9], 12, SLOT_2HOP, 1, 1);
+  SetTag (recv[9], 13, SLOT_1HOP, 2, 0);
+  // a 1 hop slot held by another neighbour of the sender
+  SetTag (local[10], 14, SLOT_1HOP, 1, 1);
+  SetTag (recv[10], 15, SLOT_1HOP, 1, 0);
+  // free on both sides: slot 11
+
+  mac->merge_fi (mac->collected_fi_, &fi, 0);
+
+  CheckTag (local[0], 0, 7, SLOT_2HOP, 3, 5, SLOT_LIFE);
+  CheckTag (local[1], 1, OWN_STI, SLOT_COLLISION, 1, 1, 0);
+  CheckTag (local[2], 2, OWN_STI, SLOT_COLLISION, 1, 1, 0);
+  CheckTag (local[3], 3, 0, SLOT_FREE, 0, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ (local[3].locker, true, "released slot not locked");
+  CheckTag (local[4], 4, 9, SLOT_2HOP, 2, 3, SLOT_LIFE);
+  CheckTag (local[5], 5, sender, SLOT_1HOP, 1, 1, SLOT_LIFE);
+  CheckTag (local[6], 6, sender, SLOT_1HOP, 2, 2, SLOT_LIFE);
+  CheckTag (local[7], 7, 0, SLOT_FREE, 0, 2, 0);
+  CheckTag (local[8], 8, 11, SLOT_2HOP, 1, 1, SLOT_LIFE);
+  CheckTag (local[9], 9, 12, SLOT_2HOP, 2, 3, 0);
+  CheckTag (local[10], 10, 14, SLOT_1HOP, 2, 2, 0);
+  CheckTag (local[11], 11, 0, SLOT_FREE, 0, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ (mac->GetFrameLen (), frameLen, "frame length changed");
+  mac->Dispose ();
+}
+
+void
+MergeFiTestCase::MergeSenderSlots (void)
+{
+  const int frameLen = 4;
+  const int sender = 6;
+  Ptr<TdmaSatmac> mac = CreateMac (frameLen);
+  slot_tag *local = mac->collected_fi_->slot_describe;
+  Frame_info fi (frameLen);
+  fi.sti = sender;
+  slot_tag *recv = fi.slot_describe;
+
+  SetTag (local[0], OWN_STI, SLOT_1HOP, 1, 1);
+  SetTag (local[1], OWN_STI, SLOT_1HOP, 1, 1);
+  SetTag (local[2], OWN_STI, SLOT_1HOP, 1, 1);
+  // the sender holds no slot yet, so it may just not have heard us
+  SetTag (recv[0], 0, SLOT_FREE, 0, 0);
+  // the sender saw a collision in our slot and reports itself as the holder
+  SetTag (recv[1], sender, SLOT_COLLISION, 1, 0);
+  // the sender now holds a slot, so missing our slot means a hidden station
+  SetTag (recv[2], 0, SLOT_FREE, 0, 0);
+
+  mac->merge_fi (mac->collected_fi_, &fi, 0);
+
+  CheckTag (local[0], 0, OWN_STI, SLOT_1HOP, 1, 1, 0);
+  CheckTag (local[1], 1, sender, SLOT_2HOP, 1, 1, SLOT_LIFE);
+  CheckTag (local[2], 2, OWN_STI, SLOT_COLLISION, 1, 1, 0);
+  CheckTag (local[3], 3, 0, SLOT_FREE, 0, 0, 0);
+  mac->Dispose ();
+}
+
+void
+MergeFiTestCase::MergeLongerFrame (void)
+{
+  const int sender = 6;
+  Ptr<TdmaSatmac> mac = CreateMac (4);
+  slot_tag *local = mac->collected_fi_->slot_describe;
+  Frame_info fi (8);
+  fi.sti = sender;
+  SetTag (fi.slot_describe[6], sender, SLOT_1HOP, 1, 0);
+
+  mac->merge_fi (mac->collected_fi_, &fi, 0);
+
+  CheckTag (local[6], 6, sender, SLOT_1HOP, 1, 1, SLOT_LIFE);
+  NS_TEST_ASSERT_MSG_EQ (mac->GetFrameLen (), 8, "frame length not restored to the sender's");
+  mac->Dispose ();
+}
+
+void
+MergeFiTestCase::DoRun (void)
+{
+  MergeSlotStates ();
+  MergeSenderSlots ();
+  MergeLongerFrame ();
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief SATMAC packet Test Suite
+ */
+static class SatmacPacketTestSuite : public TestSuite
+{
+public:
+  SatmacPacketTestSuite () : TestSuite ("satmac-packet", UNIT)
+  {
+    AddTestCase (new FiHeaderFormatTestCase (), TestCase::QUICK);
+    AddTestCase (new FiHeaderRoundTripTestCase (), TestCase::QUICK);
+    AddTestCase (new FiListAllocationTestCase (), TestCase::QUICK);
+    AddTestCase (new MergeFiTestCase (), TestCase::QUICK);
+  }
+} g_satmacPacketTestSuite; ///< the test suite
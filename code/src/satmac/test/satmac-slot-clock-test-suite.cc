@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/satmac-slot-clock.h"
+#include "ns3/tdma-satmac.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the shared slot clock against the per node slotHandler events
+ *
+ * Without the shared clock, a mac started at \c first runs slotHandler at
+ * first + k * slotTime and counts one slot and fades its received FIs by
+ * one on each call. The shared clock must tick on the same times, and a
+ * mac catching up on the boundaries it slept through must end up with the
+ * same slot indices and received FIs.
+ */
+class SatmacSlotClockTestCase : public TestCase
+{
+public:
+  SatmacSlotClockTestCase ();
+  virtual ~SatmacSlotClockTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the boundary times of the grids of \p slotTime.
+   * \param slotTime the slot duration
+   */
+  void CheckBoundaries (Time slotTime);
+  /// Check the slot indices and FIs of a mac catching up on skipped slots
+  void CheckCatchUp (void);
+};
+
+SatmacSlotClockTestCase::SatmacSlotClockTestCase ()
+  : TestCase ("Check the shared slot clock against per node slot events")
+{
+}
+
+SatmacSlotClockTestCase::~SatmacSlotClockTestCase ()
+{
+}
+
+void
+SatmacSlotClockTestCase::CheckBoundaries (Time slotTime)
+{
+  // start times as TdmaSatmac::Start draws them, whole milliseconds
+  int startMs[] = { 3, 10, 17, 250, 1001 };
+  int starts = sizeof (startMs) / sizeof (startMs[0]);
+  for (int i = 0; i < starts; i++)
+    {
+      Time first = MilliSeconds (startMs[i]);
+      Ptr<SatmacSlotClock> clock = SatmacSlotClock::Get (slotTime, first);
+      uint64_t firstBoundary = clock->GetBoundaryAtOrAfter (first);
+      for (int k = 0; k < 300; k++)
+        {
+          // the k-th slotHandler call of the mac
+          Time old = first + k * slotTime;
+          NS_TEST_ASSERT_MSG_EQ (clock->GetBoundaryAtOrAfter (old), firstBoundary + k,
+                                 "slot " << k << " of a mac started at " << first << " is not on a boundary");
+          NS_TEST_ASSERT_MSG_EQ (clock->GetBoundaryAtOrAfter (old + NanoSeconds (1)), firstBoundary + k + 1,
+                                 "boundary " << firstBoundary + k << " is later than " << old);
+        }
+
+      // macs share a clock exactly when their slots start on the same times
+      for (int j = 0; j < starts; j++)
+        {
+          Time other = MilliSeconds (startMs[j]);
+          bool sameGrid = (other - first).GetTimeStep () % slotTime.GetTimeStep () == 0;
+          bool shared = SatmacSlotClock::Get (slotTime, other) == clock;
+          NS_TEST_ASSERT_MSG_EQ (shared, sameGrid,
+                                 "macs started at " << first << " and " << other << " on the wrong clocks");
+        }
+    }
+}
+
+void
+SatmacSlotClockTestCase::CheckCatchUp (void)
+{
+  const int frameLen = 64;
+  Time slotTime = MicroSeconds (1000);
+  Time first = MilliSeconds (42);
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  Ptr<TdmaSatmac> mac = CreateObject<TdmaSatmac> ();
+  mac->SetFrameLen (frameLen);
+  // as Start does with the shared clock
+  mac->total_slot_count_ = 0;
+  mac->slot_count_ = 0;
+  mac->m_slot_clock = SatmacSlotClock::Get (slotTime, first);
+  uint64_t boundary = mac->m_slot_clock->GetBoundaryAtOrAfter (first);
+  mac->m_slot_synced = boundary - 1;
+
+  // the state slotHandler would keep without the shared clock
+  long long oldTotal = 0;
+  Frame_info_list oldFis;
+  for (int step = 0; step < 500; step++)
+    {
+      int fis = rng->GetInteger (0, 3);
+      for (int i = 0; i < fis; i++)
+        {
+          int validTime = rng->GetInteger (1, 2 * frameLen);
+          mac->received_fi_list_.append (frameLen, validTime)->sti = step;
+          oldFis.append (frameLen, validTime)->sti = step;
+        }
+
+      int skipped = rng->GetInteger (0, 2 * frameLen);
+      for (int i = 0; i <= skipped; i++)
+        {
+          oldTotal++;
+          oldFis.fade (1);
+        }
+      boundary += skipped + 1;
+      mac->sync_slot_clock (boundary - 1);
+      // touching the mac twice on a boundary must not count it twice
+      mac->sync_slot_clock (boundary - 1);
+
+      NS_TEST_ASSERT_MSG_EQ (mac->total_slot_count_, oldTotal, "wrong slot count at boundary " << boundary - 1);
+      NS_TEST_ASSERT_MSG_EQ (mac->slot_count_, oldTotal % frameLen, "wrong slot index at boundary " << boundary - 1);
+      NS_TEST_ASSERT_MSG_EQ (mac->received_fi_list_.size (), oldFis.size (), "wrong number of FIs at boundary " << boundary - 1);
+      for (int i = 0; i < oldFis.size (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (mac->received_fi_list_.at (i)->sti, oldFis.at (i)->sti, "wrong FI kept");
+        }
+    }
+
+  // not registered with the clock, so do not let DoDispose unregister it
+  mac->m_slot_clock = 0;
+  mac->Dispose ();
+}
+
+void
+SatmacSlotClockTestCase::DoRun (void)
+{
+  CheckBoundaries (MicroSeconds (1000));
+  CheckBoundaries (MicroSeconds (700));
+  CheckBoundaries (MicroSeconds (125));
+  CheckCatchUp ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief SATMAC slot clock Test Suite
+ */
+static class SatmacSlotClockTestSuite : public TestSuite
+{
+public:
+  SatmacSlotClockTestSuite () : TestSuite ("satmac-slot-clock", UNIT)
+  {
+    AddTestCase (new SatmacSlotClockTestCase (), TestCase::QUICK);
+  }
+} g_satmacSlotClockTestSuite; ///< the test suite
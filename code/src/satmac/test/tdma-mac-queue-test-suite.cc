@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/tdma-mac-queue.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief Check the size limit and the expiry of TdmaMacQueue
+ */
+class TdmaMacQueueTestCase : public TestCase
+{
+public:
+  TdmaMacQueueTestCase ();
+  virtual ~TdmaMacQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a packet.
+   * \param size the packet size, used to tell packets apart
+   */
+  void Enqueue (uint32_t size);
+  /**
+   * Check the queue content.
+   * \param size the expected size of the queue
+   * \param head the expected size of the packet at the head, or 0 if empty
+   * \param enqueued the time the packet at the head was enqueued (ms)
+   */
+  void Check (uint32_t size, uint32_t head, uint32_t enqueued);
+  /**
+   * Record a dropped packet.
+   * \param packet the packet
+   */
+  void Dropped (Ptr<const Packet> packet);
+
+  Ptr<TdmaMacQueue> m_queue;       ///< the queue under test
+  std::vector<uint32_t> m_dropped; ///< sizes of the dropped packets
+};
+
+TdmaMacQueueTestCase::TdmaMacQueueTestCase ()
+  : TestCase ("Check the size limit and the expiry of TdmaMacQueue")
+{
+}
+
+TdmaMacQueueTestCase::~TdmaMacQueueTestCase ()
+{
+}
+
+void
+TdmaMacQueueTestCase::Enqueue (uint32_t size)
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_DATA);
+  m_queue->Enqueue (Create<Packet> (size), hdr);
+}
+
+void
+TdmaMacQueueTestCase::Check (uint32_t size, uint32_t head, uint32_t enqueued)
+{
+  WifiMacHeader hdr;
+  Ptr<const Packet> packet = m_queue->Peek (&hdr);
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), size, "wrong queue size at " << Simulator::Now ().GetMilliSeconds () << "ms");
+  NS_TEST_EXPECT_MSG_EQ ((packet == 0 ? 0 : packet->GetSize ()), head, "wrong head at " << Simulator::Now ().GetMilliSeconds () << "ms");
+  Time tstamp;
+  if (m_queue->Peek (&hdr, &tstamp) != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (tstamp, MilliSeconds (enqueued), "wrong timestamp at " << Simulator::Now ().GetMilliSeconds () << "ms");
+    }
+}
+
+void
+TdmaMacQueueTestCase::Dropped (Ptr<const Packet> packet)
+{
+  m_dropped.push_back (packet->GetSize ());
+}
+
+void
+TdmaMacQueueTestCase::DoRun (void)
+{
+  m_queue = CreateObject<TdmaMacQueue> ();
+  m_queue->SetMaxSize (3);
+  m_queue->SetMaxDelay (MilliSeconds (10));
+  m_queue->SetTdmaMacTxDropCallback (MakeCallback (&TdmaMacQueueTestCase::Dropped, this));
+
+  WifiMacHeader hdr;
+  NS_TEST_ASSERT_MSG_EQ (m_queue->Enqueue (Create<Packet> (1), hdr), true, "enqueue failed");
+  NS_TEST_ASSERT_MSG_EQ (m_queue->Enqueue (Create<Packet> (2), hdr), true, "enqueue failed");
+  NS_TEST_ASSERT_MSG_EQ (m_queue->Enqueue (Create<Packet> (3), hdr), true, "enqueue failed");
+  NS_TEST_ASSERT_MSG_EQ (m_queue->Enqueue (Create<Packet> (4), hdr), false, "enqueue beyond MaxSize");
+  NS_TEST_ASSERT_MSG_EQ (m_queue->Dequeue (&hdr)->GetSize (), 1, "not first in first out");
+
+  // 2 and 3 expire at 10ms, 5 at 14ms and 6 at 20ms
+  Simulator::Schedule (MilliSeconds (4), &TdmaMacQueueTestCase::Enqueue, this, 5);
+  Simulator::Schedule (MilliSeconds (9), &TdmaMacQueueTestCase::Check, this, 3, 2, 0);
+  Simulator::Schedule (MilliSeconds (10), &TdmaMacQueueTestCase::Check, this, 1, 5, 4);
+  Simulator::Schedule (MilliSeconds (10), &TdmaMacQueueTestCase::Enqueue, this, 6);
+  Simulator::Schedule (MilliSeconds (14), &TdmaMacQueueTestCase::Check, this, 1, 6, 10);
+  Simulator::Schedule (MilliSeconds (20), &TdmaMacQueueTestCase::Check, this, 0, 0, 0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_dropped.size (), 4, "wrong number of expired packets");
+  for (uint32_t i = 0; i < m_dropped.size (); i++)
+    {
+      uint32_t expected[] = { 2, 3, 5, 6 };
+      NS_TEST_EXPECT_MSG_EQ (m_dropped[i], expected[i], "expired packets dropped out of order");
+    }
+  m_queue = 0;
+}
+
+/**
+ * \ingroup satmac
+ * \ingroup tests
+ *
+ * \brief TdmaMacQueue Test Suite
+ */
+static class TdmaMacQueueTestSuite : public TestSuite
+{
+public:
+  TdmaMacQueueTestSuite () : TestSuite ("satmac-tdma-mac-queue", UNIT)
+  {
+    AddTestCase (new TdmaMacQueueTestCase (), TestCase::QUICK);
+  }
+} g_tdmaMacQueueTestSuite; ///< the test suite
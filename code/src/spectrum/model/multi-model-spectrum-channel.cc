@@ -307,6 +307,25 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
           convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
         }
 
+      // when the whole loss model chain allows, compute the propagation
+      // gain of all the receivers with a mobility model at once
+      bool batch = txMobility && m_propagationLoss && m_propagationLoss->IsBatchSupported ();
+      uint32_t batchIndex = 0;
+      if (batch)
+        {
+          m_batchPositions.clear ();
+          for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
+               rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
+               ++rxPhyIterator)
+            {
+              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+              if ((*rxPhyIterator) != txParams->txPhy && receiverMobility)
+                {
+                  m_batchPositions.push_back (receiverMobility->GetPosition ());
+                }
+            }
+          m_propagationLoss->CalcRxPowerBatch (0, txMobility, m_batchPositions, m_batchGainDb);
+        }
 
       for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
@@ -344,7 +363,8 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                     }
                   if (m_propagationLoss)
                     {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+                      double propagationGainDb = batch ? m_batchGainDb[batchIndex++]
+                        : m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
                       NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
                       pathLossDb -= propagationGainDb;
                     }                    
@@ -29,6 +29,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ns3 {
 
@@ -207,6 +208,16 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Scratch list of receiver positions, for batched propagation gains.
+   */
+  std::vector<Vector> m_batchPositions;
+
+  /**
+   * Scratch list of batched propagation gains [dB].
+   */
+  std::vector<double> m_batchGainDb;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "bsm-delay-histogram.h"
+#include "ns3/assert.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+BsmDelayHistogram::BsmDelayHistogram ()
+  : m_count (0),
+    m_sum (0),
+    m_min (0),
+    m_max (0)
+{
+}
+
+uint32_t
+BsmDelayHistogram::GetBucket (uint64_t value)
+{
+  if (value < (1ULL << SUB_BITS))
+    {
+      return value;
+    }
+  uint32_t exponent = 63;
+  while (!(value >> exponent))
+    {
+      exponent--;
+    }
+  uint64_t sub = (value >> (exponent - SUB_BITS)) & ((1ULL << SUB_BITS) - 1);
+  return ((exponent - SUB_BITS + 1) << SUB_BITS) + sub;
+}
+
+uint64_t
+BsmDelayHistogram::GetBucketMax (uint32_t bucket)
+{
+  if (bucket < (1U << SUB_BITS))
+    {
+      return bucket;
+    }
+  uint32_t shift = (bucket >> SUB_BITS) - 1;
+  uint64_t sub = bucket & ((1U << SUB_BITS) - 1);
+  return (((1ULL << SUB_BITS) + sub + 1) << shift) - 1;
+}
+
+void
+BsmDelayHistogram::Add (uint64_t value)
+{
+  uint32_t bucket = GetBucket (value);
+  if (bucket >= m_buckets.size ())
+    {
+      m_buckets.resize (bucket + 1, 0);
+    }
+  m_buckets[bucket]++;
+  m_min = m_count == 0 ? value : std::min (m_min, value);
+  m_max = m_count == 0 ? value : std::max (m_max, value);
+  m_count++;
+  m_sum += value;
+}
+
+void
+BsmDelayHistogram::Merge (const BsmDelayHistogram &other)
+{
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  if (other.m_buckets.size () > m_buckets.size ())
+    {
+      m_buckets.resize (other.m_buckets.size (), 0);
+    }
+  for (uint32_t i = 0; i < other.m_buckets.size (); i++)
+    {
+      m_buckets[i] += other.m_buckets[i];
+    }
+  m_min = m_count == 0 ? other.m_min : std::min (m_min, other.m_min);
+  m_max = m_count == 0 ? other.m_max : std::max (m_max, other.m_max);
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+}
+
+void
+BsmDelayHistogram::Reset (void)
+{
+  // keep the buckets allocated, the next period will need them again
+  std::fill (m_buckets.begin (), m_buckets.end (), 0);
+  m_count = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+uint64_t
+BsmDelayHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+double
+BsmDelayHistogram::GetMean (void) const
+{
+  return m_count == 0 ? 0 : double (m_sum) / m_count;
+}
+
+uint64_t
+BsmDelayHistogram::GetMin (void) const
+{
+  return m_min;
+}
+
+uint64_t
+BsmDelayHistogram::GetMax (void) const
+{
+  return m_max;
+}
+
+uint64_t
+BsmDelayHistogram::GetQuantile (double q) const
+{
+  NS_ASSERT (q >= 0 && q <= 1);
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  // the rank of the quantile, from 1
+  uint64_t rank = std::max<uint64_t> (1, std::ceil (q * m_count));
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_buckets.size (); i++)
+    {
+      seen += m_buckets[i];
+      if (seen >= rank)
+        {
+          return std::max (m_min, std::min (m_max, GetBucketMax (i)));
+        }
+    }
+  return m_max;
+}
+
+} // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BSM_DELAY_HISTOGRAM_H
+#define BSM_DELAY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup wave
+ * \brief a bounded-memory histogram of BSM delays, which answers
+ * quantile queries
+ *
+ * Values below 2^SUB_BITS fall in buckets of their own; above, every
+ * power of two is split in 2^SUB_BITS buckets of equal width, so that
+ * a quantile is reported within 1/2^SUB_BITS of the exact value.
+ * Buckets are allocated up to the largest value seen: delays of up to
+ * a second take fewer than 1000 of them, whatever the number of values.
+ * Two histograms merge by adding their buckets.
+ */
+class BsmDelayHistogram
+{
+public:
+  /// Number of bits of the value kept after its leading one
+  static const uint32_t SUB_BITS = 6;
+
+  BsmDelayHistogram ();
+
+  /**
+   * \param value the value to add
+   */
+  void Add (uint64_t value);
+  /**
+   * \param other the histogram whose values to add to this one
+   */
+  void Merge (const BsmDelayHistogram &other);
+  /// Forget every value
+  void Reset (void);
+
+  /**
+   * \return the number of values
+   */
+  uint64_t GetCount (void) const;
+  /**
+   * \return the mean of the values, or 0 if there is none
+   */
+  double GetMean (void) const;
+  /**
+   * \return the smallest value, or 0 if there is none
+   */
+  uint64_t GetMin (void) const;
+  /**
+   * \return the largest value, or 0 if there is none
+   */
+  uint64_t GetMax (void) const;
+  /**
+   * \param q the quantile, in [0, 1]
+   * \return the largest value of the bucket holding the q quantile,
+   *         bounded by the smallest and largest values, or 0 if there
+   *         is no value
+   */
+  uint64_t GetQuantile (double q) const;
+
+private:
+  /**
+   * \param value a value
+   * \return the index of its bucket
+   */
+  static uint32_t GetBucket (uint64_t value);
+  /**
+   * \param bucket the index of a bucket
+   * \return the largest value of the bucket
+   */
+  static uint64_t GetBucketMax (uint32_t bucket);
+
+  std::vector<uint64_t> m_buckets;  //!< number of values, by bucket
+  uint64_t m_count;                 //!< number of values
+  uint64_t m_sum;                   //!< sum of the values
+  uint64_t m_min;                   //!< smallest value
+  uint64_t m_max;                   //!< largest value
+};
+
+} // namespace ns3
+
+#endif /* BSM_DELAY_HISTOGRAM_H */
@@ -108,6 +108,10 @@ WaveBsmHelper::Install (Ipv4InterfaceContainer & i,
   bsmApps.Start (Seconds (0));
   bsmApps.Stop (totalTime);
 
+  // one receiver index serves the expected receiver counts of all apps
+  Ptr<BsmReceiverIndex> receiverIndex = CreateObject<BsmReceiverIndex> ();
+  receiverIndex->Install (i);
+
   // for each app, setup the app parameters
   ApplicationContainer::Iterator aci;
   int nodeId = 0;
@@ -126,6 +130,7 @@ WaveBsmHelper::Install (Ipv4InterfaceContainer & i,
                      &nodesMoving,
                      chAccessMode,
                      txMaxDelay);
+      bsmApp->SetReceiverIndex (receiverIndex);
       nodeId++;
     }
 }
@@ -22,6 +22,7 @@
 
 #include "ns3/wave-bsm-stats.h"
 #include "ns3/integer.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include <numeric>
@@ -35,7 +36,9 @@ WaveBsmStats::WaveBsmStats ()
   : m_wavePktSendCount (0),
     m_waveByteSendCount (0),
     m_wavePktReceiveCount (0),
-    m_log (0)
+    m_log (0),
+    m_pirBucketWidth (MilliSeconds (50)),
+    m_keepDelaySamples (false)
 {
   m_wavePktExpectedReceiveCounts.resize (10, 0);
   m_wavePktInCoverageReceiveCounts.resize (10, 0);
@@ -51,6 +54,17 @@ WaveBsmStats::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName ("Stats")
     .AddConstructor<WaveBsmStats> ()
+    .AddAttribute ("PirBucketWidth",
+                   "The width of a bucket of the packet inter-reception histograms.",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&WaveBsmStats::m_pirBucketWidth),
+                   MakeTimeChecker (MicroSeconds (1)))
+    .AddAttribute ("KeepDelaySamples",
+                   "Whether to keep every BSM delay of the current period, "
+                   "besides the delay histograms.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&WaveBsmStats::m_keepDelaySamples),
+                   MakeBooleanChecker ())
     ;
   return tid;
 }
@@ -202,129 +216,114 @@ WaveBsmStats::ResetTotalRxPktCounts (int index)
   m_waveTotalPktExpectedReceiveCounts[index - 1] = 0;
 }
 
-void WaveBsmStats::LogPktRecvTime2Map(int txNodei, int rxNodei)
-{// std::vector< std::map<int, std::vector<int>>>
-
-	std::map<int, std::map<int, std::vector<int>>>::iterator ptxi;
-	for(ptxi = pkt_revtime_per.begin(); ptxi != pkt_revtime_per.end(); ptxi++) {
-		if (ptxi->first == txNodei) { //if txNodei existed
-
-			std::map<int, std::vector<int>>::iterator prxi;
-			for(prxi = ptxi->second.begin(); prxi != ptxi->second.end(); prxi++) {
-				if (prxi->first == rxNodei) {// if rxNodei existed
-					prxi->second.push_back(Simulator::Now().GetMicroSeconds());
-					break;
-				}
-			}
-
-			if (prxi == ptxi->second.end()) {
-				std::vector<int> tv;
-				tv.push_back(Simulator::Now().GetMicroSeconds());
-				ptxi->second[rxNodei] = tv;
-			}
-
-			break;
-		}
-	}
-
-	if (ptxi == pkt_revtime_per.end()) {
-		std::vector<int> tv;
-		tv.push_back(Simulator::Now().GetMicroSeconds());
-		std::map<int, std::vector<int>> tm1;
-		tm1[rxNodei] = tv;
-		pkt_revtime_per[txNodei] = tm1;
-	}
+WaveBsmStats::PirStats::PirStats ()
+  : lastUs (-1),
+    count (0),
+    sumUs (0),
+    minUs (0),
+    maxUs (0)
+{
+  std::fill (buckets, buckets + PIR_BUCKETS, 0);
+}
 
+void WaveBsmStats::AddPirGap (PirStats &stats, int64_t gapUs)
+{
+	if (stats.count == 0 || gapUs < stats.minUs)
+		stats.minUs = gapUs;
+	if (stats.count == 0 || gapUs > stats.maxUs)
+		stats.maxUs = gapUs;
+	stats.count++;
+	stats.sumUs += gapUs;
+	uint64_t bucket = gapUs / m_pirBucketWidth.GetMicroSeconds();
+	stats.buckets[std::min<uint64_t>(bucket, PIR_BUCKETS - 1)]++;
 }
 
-double WaveBsmStats::GetPIR(int *max, int *min)
+void WaveBsmStats::LogPktRecvTime2Map(int txNodei, int rxNodei)
 {
-	std::map<int, std::map<int, std::vector<int>>>::iterator ptxi;
-	std::map<int, std::vector<int>>::iterator prxi;
-	std::vector<int>::iterator pv;
-
-	double tsum=0, tmean=0, tmax=0, tmin=99999;
-	int totalgapcount=0;
-
-	for(ptxi = pkt_revtime_per.begin(); ptxi != pkt_revtime_per.end(); ptxi++)
-	{
-		for(prxi= ptxi->second.begin(); prxi != ptxi->second.end(); prxi++)
-		{
-			if (prxi->second.size() > 1) {
-				int lastpkttime = 0;
-				for(pv = prxi->second.begin(); pv != prxi->second.end(); pv++)
-				{//calculate gaps
-					if (lastpkttime == 0) {
-						lastpkttime = *pv;
-					} else {
-						int tmpgap = (*pv - lastpkttime);
-						lastpkttime = *pv;
-						tsum += tmpgap;
-						tmin = tmin < tmpgap ? tmin : tmpgap;
-						tmax = tmax > tmpgap ? tmax : tmpgap;
-					}
-				}
-				totalgapcount += prxi->second.size() - 1;
-			}
-		}
+	uint64_t key = (uint64_t (uint32_t (txNodei)) << 32) | uint32_t (rxNodei);
+	PirStats &stats = m_pir[key];
+	int64_t now = Simulator::Now().GetMicroSeconds();
+	if (stats.lastUs >= 0) {
+		AddPirGap(stats, now - stats.lastUs);
+		AddPirGap(m_pirTotal, now - stats.lastUs);
 	}
+	stats.lastUs = now;
+}
 
-
-	if (tmax == 0) {
+double WaveBsmStats::GetPIR(int *max, int *min)
+{
+	if (m_pirTotal.maxUs == 0) {
 		*max = -1;
 		*min = -1;
-		tmean = -1;
-	} else {
-		*max = tmax;
-		*min = tmin;
-		tmean = round(tsum / (totalgapcount));
+		return -1;
 	}
-	return tmean;
+	*max = m_pirTotal.maxUs;
+	// capped as when the gaps were scanned from a minimum of 99999
+	*min = std::min<int64_t>(m_pirTotal.minUs, 99999);
+	return round(double (m_pirTotal.sumUs) / m_pirTotal.count);
+}
+
+WaveBsmStats::PirStats WaveBsmStats::GetPirStats (int txNodei, int rxNodei) const
+{
+	uint64_t key = (uint64_t (uint32_t (txNodei)) << 32) | uint32_t (rxNodei);
+	std::unordered_map<uint64_t, PirStats>::const_iterator it = m_pir.find(key);
+	return it == m_pir.end() ? PirStats() : it->second;
+}
+
+std::vector<uint32_t> WaveBsmStats::GetPirHistogram () const
+{
+	return std::vector<uint32_t> (m_pirTotal.buckets, m_pirTotal.buckets + PIR_BUCKETS);
 }
 
 void WaveBsmStats::ResetRecvTimeMap ()
 {
-	std::map<int, std::map<int, std::vector<int>>>::iterator ptxi;
-	std::map<int, std::vector<int>>::iterator prxi;
-	std::vector<int>::iterator pv;
-
-	for(ptxi = pkt_revtime_per.begin(); ptxi != pkt_revtime_per.end(); ptxi++)
-	{
-		for(prxi= ptxi->second.begin(); prxi != ptxi->second.end(); prxi++)
-		{
-			prxi->second.clear();
-		}
-		ptxi->second.clear();
-	}
-	pkt_revtime_per.clear();
+	m_pir.clear();
+	m_pirTotal = PirStats();
 }
 
-void WaveBsmStats::LogPktRecvDeltaTimeUs(int delta)
+void WaveBsmStats::LogPktRecvDeltaTimeUs(int delta, int index)
 {
-	m_pktRecvDeltaTimeUs.push_back(delta);
-	//m_pktRecvDeltaTimeUs_cumulative.push_back(delta);
+	if (m_keepDelaySamples)
+		m_pktRecvDeltaTimeUs.push_back(delta);
+	m_delay.Add(delta);
+	m_totalDelay.Add(delta);
+	if (index >= int (m_totalDelayByRange.size()))
+		m_totalDelayByRange.resize(index + 1);
+	m_totalDelayByRange[index].Add(delta);
 }
 void WaveBsmStats::ResetPktRecvDeltaTimeUs()
 {
 	m_pktRecvDeltaTimeUs.clear();
+	m_delay.Reset();
 }
 uint64_t WaveBsmStats::GetPktRecvDeltaTimeUs(int *max, int *min)
 {
-    uint64_t sum = 0;
-    int size = m_pktRecvDeltaTimeUs.size();
-    if (size > 0) {
-		//sum = std::accumulate(m_pktRecvDeltaTimeUs.begin(), m_pktRecvDeltaTimeUs.end(), 0);
-		for (int i=0; i<size; i++)
-			sum += m_pktRecvDeltaTimeUs[i];
-		uint64_t mean =  sum / m_pktRecvDeltaTimeUs.size();
-		*max = *max_element(m_pktRecvDeltaTimeUs.begin(), m_pktRecvDeltaTimeUs.end());
-		*min = *min_element(m_pktRecvDeltaTimeUs.begin(), m_pktRecvDeltaTimeUs.end());
-		return mean;
-    } else {
-    	*max = -1;
-    	*min = -1;
-    	return -1;
-    }
+	if (m_delay.GetCount() > 0) {
+		*max = m_delay.GetMax();
+		*min = m_delay.GetMin();
+		return m_delay.GetMean();
+	} else {
+		*max = -1;
+		*min = -1;
+		return -1;
+	}
+}
+
+const BsmDelayHistogram &WaveBsmStats::GetDelayHistogram () const
+{
+	return m_delay;
+}
+
+const BsmDelayHistogram &WaveBsmStats::GetTotalDelayHistogram () const
+{
+	return m_totalDelay;
+}
+
+BsmDelayHistogram WaveBsmStats::GetTotalDelayHistogram (int index) const
+{
+	if (index < 0 || index >= int (m_totalDelayByRange.size()))
+		return BsmDelayHistogram();
+	return m_totalDelayByRange[index];
 }
 
 std::vector<int>* WaveBsmStats::GetPktRecvDeltaTimeUs_vec()
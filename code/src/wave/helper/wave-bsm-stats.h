@@ -23,9 +23,12 @@
 #define WAVE_BSM_STATS_H
 
 #include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/bsm-delay-histogram.h"
 
 #include <map>
 #include <vector>
+#include <unordered_map>
 
 namespace ns3 {
 /**
@@ -235,14 +238,93 @@ public:
    */
   int GetLogging ();
 
+  /// Number of buckets of the packet inter-reception histograms
+  static const uint32_t PIR_BUCKETS = 20;
+
+  /**
+   * \brief Packet inter-reception (PIR) statistics of a sender and
+   * receiver pair, or of all of them, since the last reset
+   */
+  struct PirStats
+  {
+    PirStats ();
+    int64_t lastUs;   ///< time of the last reception (us), -1 before the first one
+    uint32_t count;   ///< number of gaps between receptions
+    int64_t sumUs;    ///< sum of the gaps (us)
+    int64_t minUs;    ///< smallest gap (us)
+    int64_t maxUs;    ///< largest gap (us)
+    uint32_t buckets[PIR_BUCKETS]; ///< gaps per PirBucketWidth; the last bucket holds every longer gap
+  };
+
+  /**
+   * \brief Records the reception of a BSM, which ends a gap if the
+   * receiver already heard the sender since the last reset
+   * \param txNodei the sending node
+   * \param rxNodei the receiving node
+   */
   void LogPktRecvTime2Map(int txNodei, int rxNodei);
+  /**
+   * \brief Returns the mean packet inter-reception time over all pairs
+   * \param max set to the largest gap (us), or -1 if there is none
+   * \param min set to the smallest gap (us), or -1 if there is none
+   * \return the rounded mean gap (us), or -1 if there is none
+   */
   double GetPIR(int *max, int *min);
+  /**
+   * \param txNodei the sending node
+   * \param rxNodei the receiving node
+   * \return the PIR statistics of the pair
+   */
+  PirStats GetPirStats (int txNodei, int rxNodei) const;
+  /**
+   * \return the histogram of the gaps of all pairs, PIR_BUCKETS buckets
+   * of PirBucketWidth each
+   */
+  std::vector<uint32_t> GetPirHistogram () const;
+  /**
+   * \brief Forgets the receptions so far, and starts new PIR statistics
+   */
   void ResetRecvTimeMap();
 
-  void LogPktRecvDeltaTimeUs(int delta);
+  /**
+   * \brief Records the delay of a received BSM, in the histogram of the
+   * current period, the one of the run and the one of its range
+   * \param delta the delay (us)
+   * \param index the first tx safety range the receiver is within,
+   * from 1, or 0 if unknown or beyond all of them
+   */
+  void LogPktRecvDeltaTimeUs(int delta, int index = 0);
+  /**
+   * \brief Returns the mean delay of the current period
+   * \param max set to the largest delay (us), or -1 if there is none
+   * \param min set to the smallest delay (us), or -1 if there is none
+   * \return the mean delay (us)
+   */
   uint64_t GetPktRecvDeltaTimeUs(int *max, int *min);
+  /**
+   * \brief Starts a new period of delays
+   */
   void ResetPktRecvDeltaTimeUs();
+  /**
+   * \return the delays of the current period
+   */
+  const BsmDelayHistogram &GetDelayHistogram () const;
+  /**
+   * \return the delays of the whole run
+   */
+  const BsmDelayHistogram &GetTotalDelayHistogram () const;
+  /**
+   * \param index the tx safety range index, or 0 for the receivers
+   * beyond all of them
+   * \return the delays of the whole run of the receivers of the range
+   * which are not within a smaller one
+   */
+  BsmDelayHistogram GetTotalDelayHistogram (int index) const;
 
+  /**
+   * \return the delays of the current period, one by one; only kept
+   * if KeepDelaySamples is set
+   */
   std::vector<int>* GetPktRecvDeltaTimeUs_vec();
 private:
   int m_wavePktSendCount; ///< packet sent count
@@ -254,8 +336,17 @@ private:
   std::vector <int> m_waveTotalPktExpectedReceiveCounts; ///< total packet expected receive counts
   int m_log; ///< log
 
-  std::map<int, std::map<int, std::vector<int>>> pkt_revtime_per;
-  std::vector<int> m_pktRecvDeltaTimeUs;
+  /// Records a gap in the given statistics
+  void AddPirGap (PirStats &stats, int64_t gapUs);
+
+  std::unordered_map<uint64_t, PirStats> m_pir; ///< PIR statistics, by sender << 32 | receiver
+  PirStats m_pirTotal; ///< PIR statistics of all pairs
+  Time m_pirBucketWidth; ///< width of a PIR histogram bucket
+  std::vector<int> m_pktRecvDeltaTimeUs; ///< delays of the current period, if m_keepDelaySamples
+  bool m_keepDelaySamples; ///< whether to keep m_pktRecvDeltaTimeUs
+  BsmDelayHistogram m_delay; ///< delays of the current period
+  BsmDelayHistogram m_totalDelay; ///< delays of the whole run
+  std::vector<BsmDelayHistogram> m_totalDelayByRange; ///< delays of the whole run, by range index
 //  std::vector<int> m_pktRecvDeltaTimeUs_cumulative;
 //  double m_pktRecvDeltaTimeUs_mean;
 //  double m_pktRecvDeltaTimeUs_max;
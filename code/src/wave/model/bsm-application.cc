@@ -32,6 +32,7 @@
 #include <random>
 #include "ns3/run_number.h"
 #include "ns3/node-container.h"
+#include <cmath>
 
 
 
@@ -60,6 +61,7 @@ BsmApplication::BsmApplication ()
   : m_waveBsmStats (0),
     m_aperiodicStats(0),
     m_txSafetyRangesSq (),
+    m_maxTxSafetyRange (0.0),
     m_TotalSimTime (Seconds (10)),
     m_wavePacketSize (200),
     m_numWavePackets (1),
@@ -86,6 +88,8 @@ BsmApplication::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
 
+  m_receiverIndex = 0;
+
   // chain up
   Application::DoDispose ();
 }
@@ -220,11 +224,13 @@ BsmApplication::Setup (Ipv4InterfaceContainer & i,
   m_chAccessMode = chAccessMode;
   m_txSafetyRangesSq.clear ();
   m_txSafetyRangesSq.resize (size, 0);
+  m_maxTxSafetyRange = 0.0;
 
   for (int index = 0; index < size; index++)
     {
       // stored as square of value, for optimization
       m_txSafetyRangesSq[index] = rangesSq[index];
+      m_maxTxSafetyRange = std::max (m_maxTxSafetyRange, std::sqrt (rangesSq[index]));
     }
 
   m_adhocTxInterfaces = &i;
@@ -282,46 +288,7 @@ BsmApplication::GenerateWaveTraffic (Ptr<Socket> socket, uint32_t pktSize,
 
           // find other nodes within range that would be
           // expected to receive this broadbast
-          int nRxNodes = m_adhocTxInterfaces->GetN ();
-          int expectedRxNodes = 0;
-          for (int i = 0; i < nRxNodes; i++)
-            {
-              Ptr<Node> rxNode = GetNode (i);
-              int rxNodeId = rxNode->GetId ();
-              // Skip node 0 from expected receive statistics
-              if (rxNodeId == 0) {
-                  continue;  // Skip node 0
-              }
-              
-              if (rxNodeId != txNodeId)
-                {
-                  Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel> ();
-                  NS_ASSERT (rxPosition != 0);
-                  // confirm that the receiving node
-                  // has also started moving in the scenario
-                  // if it has not started moving, then
-                  // it is not a candidate to receive a packet
-                  int receiverMoving = m_nodesMoving->at (rxNodeId);
-                  if (receiverMoving == 1)
-                    {
-                      double distSq = MobilityHelper::GetDistanceSquaredBetween (txNode, rxNode);
-                      if (distSq > 0.0)
-                        {
-                          // dest node within range?
-                          int rangeCount = m_txSafetyRangesSq.size ();
-                          for (int index = 1; index <= rangeCount; index++)
-                            {
-                              if (distSq <= m_txSafetyRangesSq[index - 1])
-                                {
-                                  // we should expect dest node to receive broadcast pkt
-                                  m_waveBsmStats->IncExpectedRxPktCount (index);
-                                  expectedRxNodes++;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+          CountExpectedReceivers (txNode, m_waveBsmStats);
       }
 
       // every BSM must be scheduled with a tx time delay
@@ -360,47 +327,45 @@ void BsmApplication::ReceiveWavePacket(Ptr<Socket> socket)
         if (InetSocketAddress::IsMatchingType(senderAddr))
         {
             InetSocketAddress addr = InetSocketAddress::ConvertFrom(senderAddr);
-            int nodes = m_adhocTxInterfaces->GetN();
-            for (int i = 0; i < nodes; i++)
+            int32_t i = GetReceiverIndex()->GetIndex(addr.GetIpv4());
+            if (i < 0)
             {
-                if (addr.GetIpv4() == m_adhocTxInterfaces->GetAddress(i))
-                {
-                    Ptr<Node> txNode = GetNode(i);
+                continue; // not sent from one of m_adhocTxInterfaces
+            }
+            Ptr<Node> txNode = GetNode(i);
 
-                    // Skip statistics for node 0
-                    if (txNode->GetId() == 0)
-                    {
-                        continue; // Skip processing for node 0
-                    }
+            // Skip statistics for node 0
+            if (txNode->GetId() == 0)
+            {
+                continue; // Skip processing for node 0
+            }
 
-                    // Check if the packet is aperiodic or periodic
-                    AperiodicTag apic_tag;
-                    bool isAperiodic = packet->PeekPacketTag(apic_tag);
+            // Check if the packet is aperiodic or periodic
+            AperiodicTag apic_tag;
+            bool isAperiodic = packet->PeekPacketTag(apic_tag);
 
-                    // Remove the BsmTimeTag to calculate delay
-                    BsmTimeTag tag;
-                    packet->RemovePacketTag(tag);
-                    uint32_t delta = Simulator::Now().GetMicroSeconds() - tag.getSendingTimeUs();
+            // Remove the BsmTimeTag to calculate delay
+            BsmTimeTag tag;
+            packet->RemovePacketTag(tag);
+            uint32_t delta = Simulator::Now().GetMicroSeconds() - tag.getSendingTimeUs();
 
-                    // Skip processing if delay exceeds 100ms (100,000 microseconds)
-                    if (delta > 200000)
-                    {
-                        NS_LOG_WARN("Packet dropped due to excessive delay: " << delta << "us");
-                        continue;
-                    }
+            // Skip processing if delay exceeds 100ms (100,000 microseconds)
+            if (delta > 200000)
+            {
+                NS_LOG_WARN("Packet dropped due to excessive delay: " << delta << "us");
+                continue;
+            }
 
-                    // Handle the packet based on type (aperiodic or periodic)
-                    if (isAperiodic)
-                    {
-                        HandleReceivedAperiodicPacket(txNode, rxNode);
-                        m_aperiodicStats->LogPktRecvDeltaTimeUs(delta);
-                    }
-                    else
-                    {
-                        HandleReceivedBsmPacket(txNode, rxNode);
-                        m_waveBsmStats->LogPktRecvDeltaTimeUs(delta);
-                    }
-                }
+            // Handle the packet based on type (aperiodic or periodic)
+            if (isAperiodic)
+            {
+                HandleReceivedAperiodicPacket(txNode, rxNode);
+                m_aperiodicStats->LogPktRecvDeltaTimeUs(delta, GetRangeIndex(txNode, rxNode));
+            }
+            else
+            {
+                HandleReceivedBsmPacket(txNode, rxNode);
+                m_waveBsmStats->LogPktRecvDeltaTimeUs(delta, GetRangeIndex(txNode, rxNode));
             }
         }
     }
@@ -443,6 +408,21 @@ void BsmApplication::HandleReceivedBsmPacket (Ptr<Node> txNode,
     }
 }
 
+int
+BsmApplication::GetRangeIndex (Ptr<Node> txNode, Ptr<Node> rxNode) const
+{
+  double rxDistSq = MobilityHelper::GetDistanceSquaredBetween (rxNode, txNode);
+  int rangeCount = m_txSafetyRangesSq.size ();
+  for (int index = 1; index <= rangeCount; index++)
+    {
+      if (rxDistSq <= m_txSafetyRangesSq[index - 1])
+        {
+          return index;
+        }
+    }
+  return 0;
+}
+
 int64_t
 BsmApplication::AssignStreams (int64_t streamIndex)
 {
@@ -454,16 +434,80 @@ BsmApplication::AssignStreams (int64_t streamIndex)
   return 1;
 }
 
+void
+BsmApplication::SetReceiverIndex (Ptr<BsmReceiverIndex> index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_receiverIndex = index;
+}
+
+void
+BsmApplication::CountExpectedReceivers (Ptr<Node> txNode, Ptr<WaveBsmStats> stats)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_txSafetyRangesSq.empty ())
+    {
+      return;
+    }
+
+  // only the nodes near the sender can be within the largest range
+  Ptr<MobilityModel> txPosition = txNode->GetObject<MobilityModel> ();
+  NS_ASSERT (txPosition != 0);
+  GetReceiverIndex ()->GetCandidates (txPosition->GetPosition (), m_maxTxSafetyRange, m_candidates);
+
+  int txNodeId = txNode->GetId ();
+  for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); ++i)
+    {
+      Ptr<Node> rxNode = GetNode (*i);
+      int rxNodeId = rxNode->GetId ();
+      // Skip node 0 from expected receive statistics
+      if (rxNodeId == 0 || rxNodeId == txNodeId)
+        {
+          continue;
+        }
+      // confirm that the receiving node
+      // has also started moving in the scenario
+      // if it has not started moving, then
+      // it is not a candidate to receive a packet
+      int receiverMoving = m_nodesMoving->at (rxNodeId);
+      if (receiverMoving == 1)
+        {
+          double distSq = MobilityHelper::GetDistanceSquaredBetween (txNode, rxNode);
+          if (distSq > 0.0)
+            {
+              // dest node within range?
+              int rangeCount = m_txSafetyRangesSq.size ();
+              for (int index = 1; index <= rangeCount; index++)
+                {
+                  if (distSq <= m_txSafetyRangesSq[index - 1])
+                    {
+                      // we should expect dest node to receive broadcast pkt
+                      stats->IncExpectedRxPktCount (index);
+                    }
+                }
+            }
+        }
+    }
+}
+
 Ptr<Node>
 BsmApplication::GetNode (int id)
 {
   NS_LOG_FUNCTION (this);
 
-  std::pair<Ptr<Ipv4>, uint32_t> interface = m_adhocTxInterfaces->Get (id);
-  Ptr<Ipv4> pp = interface.first;
-  Ptr<Node> node = pp->GetObject<Node> ();
+  return GetReceiverIndex ()->GetNode (id);
+}
 
-  return node;
+Ptr<BsmReceiverIndex>
+BsmApplication::GetReceiverIndex (void)
+{
+  if (m_receiverIndex == 0)
+    {
+      m_receiverIndex = CreateObject<BsmReceiverIndex> ();
+      m_receiverIndex->Install (*m_adhocTxInterfaces);
+    }
+  return m_receiverIndex;
 }
 
 Ptr<WifiNetDevice>
@@ -532,42 +576,7 @@ void BsmApplication::GenerateAperiodicTraffic(Ptr<Socket> socket, uint32_t pktSi
           m_aperiodicStats->IncTxByteCount(pktSize);
 
           // 确定所有在范围内的节点
-          int nRxNodes = m_adhocTxInterfaces->GetN();
-          for (int j = 0; j < nRxNodes; j++)  // 遍历所有接收节点
-          {
-              Ptr<Node> rxNode = GetNode(j);
-              int rxNodeId = rxNode->GetId();
-              int expectedRxNodes = 0;
-              // Skip node 0 from expected receive statistics
-              if (rxNodeId == 0) {
-                  continue;  // Skip node 0
-              }
-
-              if (rxNodeId != txNodeId)
-              {
-                  Ptr<MobilityModel> rxPosition = rxNode->GetObject<MobilityModel>();
-                  NS_ASSERT(rxPosition != 0);
-                  // 确认接收节点是否也在移动
-                  int receiverMoving = m_nodesMoving->at(rxNodeId);
-                  if (receiverMoving == 1)
-                  {
-                      double distSq = MobilityHelper::GetDistanceSquaredBetween(txNode, rxNode);
-                      if (distSq > 0.0)
-                      {
-                          int rangeCount = m_txSafetyRangesSq.size();
-                          for (int index = 1; index <= rangeCount; index++)
-                          {
-                              if (distSq <= m_txSafetyRangesSq[index - 1])
-                              {
-                                  // **记录每个数据包的预期接收节点数**
-                                  m_aperiodicStats->IncExpectedRxPktCount(index);
-                                  expectedRxNodes++;
-                              }
-                          }
-                      }
-                  }
-              }
-          }
+          CountExpectedReceivers(txNode, m_aperiodicStats);
       
       // 随机生成下一个数据包的间隔时间
       Time randomInterval = GetAperiodicRandomInterval();
@@ -28,6 +28,9 @@
 #include "ns3/internet-stack-helper.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/MacLayerController.h"
+#include "ns3/bsm-receiver-index.h"
+
+class BsmReceiverIndexLookupTestCase;
 
 namespace ns3 {
 /**
@@ -41,6 +44,8 @@ namespace ns3 {
  */
 class BsmApplication : public Application
 {
+  /// Allow test cases to access private members
+  friend class ::BsmReceiverIndexLookupTestCase;
 public:
   /**
    * \brief Get the type ID.
@@ -98,6 +103,15 @@ public:
   */
   int64_t AssignStreams (int64_t streamIndex);
 
+  /**
+   * Share an index of the nodes of the interfaces given to Setup, used to
+   * find the expected receivers of a broadcast. Without one, the
+   * application builds its own on the first transmission.
+   *
+   * \param index the receiver index
+   */
+  void SetReceiverIndex (Ptr<BsmReceiverIndex> index);
+
   /**
   * (Arbitrary) port number that is used to create a socket for transmitting WAVE BSMs.
   */
@@ -161,12 +175,34 @@ private:
 		  	  	  	  	  	  	  uint32_t pktSize,
 								  uint32_t sendingNodeId);
   void HandleReceivedAperiodicPacket(Ptr<Node> txNode, Ptr<Node> rxNode);
+  /**
+   * Count, per tx safety range, the nodes expected to receive a broadcast.
+   *
+   * \param txNode the transmitting node
+   * \param stats the statistics to count the expected receptions in
+   */
+  void CountExpectedReceivers (Ptr<Node> txNode, Ptr<WaveBsmStats> stats);
+  /**
+   * \return the index of the nodes of m_adhocTxInterfaces, built on first
+   *         use if WaveBsmHelper did not set one
+   */
+  Ptr<BsmReceiverIndex> GetReceiverIndex (void);
+  /**
+   * \param txNode the sending node
+   * \param rxNode the receiving node
+   * \return the index of the first tx safety range the receiver is
+   *         within, from 1, or 0 if it is beyond all of them
+   */
+  int GetRangeIndex (Ptr<Node> txNode, Ptr<Node> rxNode) const;
 
 
   Ptr<WaveBsmStats> m_waveBsmStats; ///< BSM stats
   Ptr<WaveBsmStats> m_aperiodicStats; ///< BSM stats
   /// tx safety range squared, for optimization
   std::vector <double> m_txSafetyRangesSq;
+  double m_maxTxSafetyRange; ///< largest tx safety range (m)
+  Ptr<BsmReceiverIndex> m_receiverIndex; ///< index of the nodes of m_adhocTxInterfaces
+  std::vector<uint32_t> m_candidates; ///< scratch list of possible receivers
   Time m_TotalSimTime; ///< total sim time
   uint32_t m_wavePacketSize; ///< bytes
   uint32_t m_numWavePackets; ///< number of wave packets
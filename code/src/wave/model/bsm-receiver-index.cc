@@ -0,0 +1,133 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "bsm-receiver-index.h"
+#include "ns3/log.h"
+#include "ns3/mobility-model.h"
+#include "ns3/ipv4.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("BsmReceiverIndex");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (BsmReceiverIndex);
+
+TypeId
+BsmReceiverIndex::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BsmReceiverIndex")
+    .SetParent<Object> ()
+    .SetGroupName ("Wave")
+    .AddConstructor<BsmReceiverIndex> ()
+    ;
+  return tid;
+}
+
+BsmReceiverIndex::BsmReceiverIndex ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BsmReceiverIndex::~BsmReceiverIndex ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BsmReceiverIndex::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_grid.Clear ();
+  m_nodes = NodeContainer ();
+  m_addresses.clear ();
+  Object::DoDispose ();
+}
+
+void
+BsmReceiverIndex::Install (const Ipv4InterfaceContainer &interfaces)
+{
+  NS_LOG_FUNCTION (this);
+  NodeContainer nodes;
+  for (Ipv4InterfaceContainer::Iterator i = interfaces.Begin (); i != interfaces.End (); ++i)
+    {
+      nodes.Add (i->first->GetObject<Node> ());
+    }
+  Install (nodes);
+  for (uint32_t i = 0; i < interfaces.GetN (); i++)
+    {
+      // the first interface wins, as with a scan of the container
+      m_addresses.insert (std::make_pair (interfaces.GetAddress (i), i));
+    }
+}
+
+void
+BsmReceiverIndex::Install (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  m_grid.Clear ();
+  m_nodes = nodes;
+  m_addresses.clear ();
+}
+
+uint32_t
+BsmReceiverIndex::GetN (void) const
+{
+  return m_nodes.GetN ();
+}
+
+Ptr<Node>
+BsmReceiverIndex::GetNode (uint32_t index) const
+{
+  return m_nodes.Get (index);
+}
+
+int32_t
+BsmReceiverIndex::GetIndex (Ipv4Address address) const
+{
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator it = m_addresses.find (address);
+  if (it == m_addresses.end ())
+    {
+      return -1;
+    }
+  return it->second;
+}
+
+void
+BsmReceiverIndex::GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates)
+{
+  if (m_grid.NeedsRebuild (range))
+    {
+      Rebuild (range);
+    }
+  candidates.clear ();
+  // the grid compares 2d distances while callers use 3d ones: pad for rounding
+  m_grid.Query (position, range * (1 + 1e-9) + 1e-6, candidates);
+}
+
+void
+BsmReceiverIndex::Rebuild (double range)
+{
+  NS_LOG_FUNCTION (this << range);
+  std::vector<Ptr<MobilityModel> > mobility (m_nodes.GetN ());
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      mobility[i] = m_nodes.Get (i)->GetObject<MobilityModel> ();
+    }
+  m_grid.Rebuild (mobility, range);
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BSM_RECEIVER_INDEX_H
+#define BSM_RECEIVER_INDEX_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/mobile-spatial-grid.h"
+#include <vector>
+#include <unordered_map>
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup wave
+ * \brief a spatial index of the nodes taking part in BSM statistics
+ *
+ * BsmApplication uses it to find the nodes which may be expected to
+ * receive a broadcast without scanning every node. Nodes are filed in a
+ * MobileSpatialGrid by their position in the container they were
+ * installed from, so a node within range is never missed. When installed
+ * from interfaces, it also maps their addresses to the node indices, so that
+ * the sender of a received packet is found in constant time. One index is
+ * shared by all the applications installed by WaveBsmHelper.
+ */
+class BsmReceiverIndex : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  BsmReceiverIndex ();
+  virtual ~BsmReceiverIndex ();
+
+  /**
+   * Index the nodes of the given interfaces, by interface index, and
+   * the addresses of the interfaces.
+   *
+   * \param interfaces the interfaces
+   */
+  void Install (const Ipv4InterfaceContainer &interfaces);
+  /**
+   * Index the given nodes, by their index in the container.
+   *
+   * \param nodes the nodes
+   */
+  void Install (NodeContainer nodes);
+  /**
+   * \return the number of indexed nodes
+   */
+  uint32_t GetN (void) const;
+  /**
+   * \param index the index of a node
+   * \return the node
+   */
+  Ptr<Node> GetNode (uint32_t index) const;
+  /**
+   * \param address the address of an interface
+   * \return the index of the node of the interface, or -1 if the address
+   *         is not the address of an indexed interface
+   */
+  int32_t GetIndex (Ipv4Address address) const;
+
+  /**
+   * Fill candidates with the indices of the nodes which may lie within
+   * range of the given position. The list may hold nodes a little out of
+   * range, which callers filter out by their exact distance.
+   *
+   * \param position the query position
+   * \param range the query range (m)
+   * \param candidates the list to fill; it is cleared first
+   */
+  void GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * File every node at its current position.
+   *
+   * \param range the query range the cells are sized for
+   */
+  void Rebuild (double range);
+
+  NodeContainer m_nodes;               //!< The indexed nodes
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_addresses; //!< Node index, by interface address
+  MobileSpatialGrid m_grid;            //!< Node index, filed by node index
+};
+
+} // namespace ns3
+
+#endif /* BSM_RECEIVER_INDEX_H */
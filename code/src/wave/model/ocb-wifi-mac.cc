@@ -277,12 +277,7 @@ OcbWifiMac::Enqueue (Ptr<const Packet> packet, Mac48Address to)
 	  if (getTdmaEnable())
 	  {
 		  //std::cout<<"tdma "<<this->getNode()->GetId()<<std::endl;
-		  Ptr<WifiNetDevice> tdma = DynamicCast<WifiNetDevice>(this->getNode()->GetDevice(0));
-		  m_macLayerController = this->getNode()->GetObject<MacLayerController>();
-	//	  if(m_macLayerController->GetCurrentDevice() == tdma)
-	//	  {
-			  m_tdma->Queue(packet, hdr);
-	//	  }
+		  m_tdma->Queue(packet, hdr);
 	  }
 	  else
 	  {
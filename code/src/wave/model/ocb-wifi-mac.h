@@ -198,7 +198,6 @@ private:
 
   VendorSpecificContentManager m_vscManager; ///< VSC manager
   Ptr<TdmaSatmac> m_tdma;
-  Ptr<MacLayerController> m_macLayerController;
 
 public:
   void SlotGroupEnque(Ptr<const Packet> packet,const WifiMacHeader &hdr);
@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/bsm-receiver-index.h"
+#include "ns3/bsm-application.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Check that BsmReceiverIndex never misses a node within range
+ */
+class BsmReceiverIndexTestCase : public TestCase
+{
+public:
+  BsmReceiverIndexTestCase ();
+  virtual ~BsmReceiverIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Query the index around every node and compare with a full scan
+  void Check (void);
+  /// Give every node a new random velocity
+  void Turn (void);
+
+  NodeContainer m_nodes;              ///< the nodes
+  Ptr<BsmReceiverIndex> m_index;      ///< the index under test
+  Ptr<UniformRandomVariable> m_rng;   ///< random positions and speeds
+  uint32_t m_checks;                  ///< number of node pairs checked
+};
+
+BsmReceiverIndexTestCase::BsmReceiverIndexTestCase ()
+  : TestCase ("Check BsmReceiverIndex candidates against a full scan"),
+    m_checks (0)
+{
+}
+
+BsmReceiverIndexTestCase::~BsmReceiverIndexTestCase ()
+{
+}
+
+void
+BsmReceiverIndexTestCase::Check (void)
+{
+  double ranges[] = { 50.0, 300.0 };
+  std::vector<uint32_t> candidates;
+  for (uint32_t r = 0; r < sizeof (ranges) / sizeof (ranges[0]); r++)
+    {
+      for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+        {
+          Ptr<MobilityModel> tx = m_nodes.Get (i)->GetObject<MobilityModel> ();
+          m_index->GetCandidates (tx->GetPosition (), ranges[r], candidates);
+          std::sort (candidates.begin (), candidates.end ());
+          for (uint32_t j = 0; j < m_nodes.GetN (); j++)
+            {
+              Ptr<MobilityModel> rx = m_nodes.Get (j)->GetObject<MobilityModel> ();
+              double dist = tx->GetDistanceFrom (rx);
+              if (dist * dist <= ranges[r] * ranges[r])
+                {
+                  m_checks++;
+                  NS_TEST_ASSERT_MSG_EQ (std::binary_search (candidates.begin (), candidates.end (), j), true,
+                                         "node " << j << " at " << dist << "m of node " << i << " missed at "
+                                                 << Simulator::Now ().GetSeconds () << "s");
+                }
+            }
+        }
+    }
+}
+
+void
+BsmReceiverIndexTestCase::Turn (void)
+{
+  for (uint32_t i = 0; i < m_nodes.GetN (); i += 2)
+    {
+      Ptr<ConstantVelocityMobilityModel> mobility = m_nodes.Get (i)->GetObject<ConstantVelocityMobilityModel> ();
+      mobility->SetVelocity (Vector (m_rng->GetValue (-40, 40), m_rng->GetValue (-40, 40), 0));
+    }
+}
+
+void
+BsmReceiverIndexTestCase::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_nodes.Create (200);
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (m_nodes);
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> model = m_nodes.Get (i)->GetObject<ConstantVelocityMobilityModel> ();
+      model->SetPosition (Vector (m_rng->GetValue (0, 2000), m_rng->GetValue (0, 2000), 1.5));
+      // half the nodes start parked and only move after the first turn
+      double speed = i % 2 ? 30.0 : 0.0;
+      model->SetVelocity (Vector (m_rng->GetValue (-speed, speed), m_rng->GetValue (-speed, speed), 0));
+    }
+
+  m_index = CreateObject<BsmReceiverIndex> ();
+  m_index->Install (m_nodes);
+  NS_TEST_ASSERT_MSG_EQ (m_index->GetN (), 200, "wrong number of indexed nodes");
+
+  for (uint32_t t = 0; t < 40; t++)
+    {
+      Simulator::Schedule (MilliSeconds (100 * t + 7), &BsmReceiverIndexTestCase::Check, this);
+    }
+  Simulator::Schedule (MilliSeconds (1500), &BsmReceiverIndexTestCase::Turn, this);
+  Simulator::Schedule (MilliSeconds (2600), &BsmReceiverIndexTestCase::Turn, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_GT (m_checks, 0, "nothing was checked");
+  m_index->Dispose ();
+  m_index = 0;
+  m_nodes = NodeContainer ();
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Check the lookup of the senders of received BSMs
+ *
+ * BsmReceiverIndex maps the addresses of the interfaces it is installed
+ * from to their index in the container. BsmApplication builds its own
+ * index from the interfaces given to Setup on first use, unless
+ * WaveBsmHelper shared one.
+ */
+class BsmReceiverIndexLookupTestCase : public TestCase
+{
+public:
+  BsmReceiverIndexLookupTestCase ();
+  virtual ~BsmReceiverIndexLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BsmReceiverIndexLookupTestCase::BsmReceiverIndexLookupTestCase ()
+  : TestCase ("Check the lookup of BsmReceiverIndex by interface address")
+{
+}
+
+BsmReceiverIndexLookupTestCase::~BsmReceiverIndexLookupTestCase ()
+{
+}
+
+void
+BsmReceiverIndexLookupTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
+  // the interfaces in another order than the nodes
+  NetDeviceContainer reversed;
+  for (uint32_t i = devices.GetN (); i > 0; i--)
+    {
+      reversed.Add (devices.Get (i - 1));
+    }
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (reversed);
+
+  Ptr<BsmReceiverIndex> index = CreateObject<BsmReceiverIndex> ();
+  index->Install (interfaces);
+  NS_TEST_ASSERT_MSG_EQ (index->GetN (), 4, "wrong number of indexed nodes");
+  for (uint32_t i = 0; i < interfaces.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (index->GetIndex (interfaces.GetAddress (i)), (int32_t) i,
+                             "wrong index of " << interfaces.GetAddress (i));
+      NS_TEST_EXPECT_MSG_EQ (index->GetNode (i), nodes.Get (3 - i), "wrong node of interface " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (index->GetIndex (Ipv4Address ("10.1.0.200")), -1, "unknown address of the subnet found");
+  NS_TEST_EXPECT_MSG_EQ (index->GetIndex (Ipv4Address ("10.2.0.1")), -1, "unknown address found");
+  NS_TEST_EXPECT_MSG_EQ (index->GetIndex (Ipv4Address::GetLoopback ()), -1, "loopback address found");
+
+  // the nodes alone carry no addresses
+  index->Install (nodes);
+  NS_TEST_EXPECT_MSG_EQ (index->GetIndex (interfaces.GetAddress (0)), -1, "address kept from the interfaces");
+  NS_TEST_EXPECT_MSG_EQ (index->GetNode (0), nodes.Get (0), "wrong node of index 0");
+
+  // built from the interfaces of Setup on first use, then kept
+  Ptr<BsmApplication> app = CreateObject<BsmApplication> ();
+  app->m_adhocTxInterfaces = &interfaces;
+  NS_TEST_ASSERT_MSG_EQ (app->m_receiverIndex, 0, "index built before its first use");
+  Ptr<BsmReceiverIndex> own = app->GetReceiverIndex ();
+  NS_TEST_ASSERT_MSG_NE (own, 0, "no index built");
+  NS_TEST_EXPECT_MSG_EQ (app->GetReceiverIndex (), own, "index built twice");
+  NS_TEST_EXPECT_MSG_EQ (own->GetIndex (interfaces.GetAddress (1)), 1, "wrong index of the built index");
+  NS_TEST_EXPECT_MSG_EQ (app->GetNode (1), nodes.Get (2), "wrong node of the built index");
+
+  // a shared index is used as is
+  Ptr<BsmApplication> shared = CreateObject<BsmApplication> ();
+  shared->m_adhocTxInterfaces = &interfaces;
+  shared->SetReceiverIndex (index);
+  NS_TEST_EXPECT_MSG_EQ (shared->GetReceiverIndex (), index, "shared index replaced");
+
+  app->Dispose ();
+  shared->Dispose ();
+  index->Dispose ();
+  own->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief BsmReceiverIndex Test Suite
+ */
+static class BsmReceiverIndexTestSuite : public TestSuite
+{
+public:
+  BsmReceiverIndexTestSuite () : TestSuite ("wave-bsm-receiver-index", UNIT)
+  {
+    AddTestCase (new BsmReceiverIndexTestCase (), TestCase::QUICK);
+    AddTestCase (new BsmReceiverIndexLookupTestCase (), TestCase::QUICK);
+  }
+} g_bsmReceiverIndexTestSuite; ///< the test suite
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/wave-bsm-stats.h"
+#include "ns3/bsm-delay-histogram.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace ns3;
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Check the packet inter-reception statistics of WaveBsmStats
+ */
+class WaveBsmStatsPirTestCase : public TestCase
+{
+public:
+  WaveBsmStatsPirTestCase ();
+  virtual ~WaveBsmStatsPirTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a reception
+   * \param tx the sending node
+   * \param rx the receiving node
+   */
+  void Receive (int tx, int rx);
+
+  Ptr<WaveBsmStats> m_stats; ///< the stats under test
+};
+
+WaveBsmStatsPirTestCase::WaveBsmStatsPirTestCase ()
+  : TestCase ("Check the packet inter-reception statistics of WaveBsmStats")
+{
+}
+
+WaveBsmStatsPirTestCase::~WaveBsmStatsPirTestCase ()
+{
+}
+
+void
+WaveBsmStatsPirTestCase::Receive (int tx, int rx)
+{
+  m_stats->LogPktRecvTime2Map (tx, rx);
+}
+
+void
+WaveBsmStatsPirTestCase::DoRun (void)
+{
+  m_stats = CreateObject<WaveBsmStats> ();
+  int max, min;
+  NS_TEST_ASSERT_MSG_EQ (m_stats->GetPIR (&max, &min), -1, "no gap yet");
+  NS_TEST_ASSERT_MSG_EQ (max, -1, "no gap yet");
+
+  // 1 -> 2 at 100, 200 and 500 ms; 2 -> 1 at 150 and 250 ms; 3 -> 2 once
+  Simulator::Schedule (MilliSeconds (100), &WaveBsmStatsPirTestCase::Receive, this, 1, 2);
+  Simulator::Schedule (MilliSeconds (150), &WaveBsmStatsPirTestCase::Receive, this, 2, 1);
+  Simulator::Schedule (MilliSeconds (200), &WaveBsmStatsPirTestCase::Receive, this, 1, 2);
+  Simulator::Schedule (MilliSeconds (250), &WaveBsmStatsPirTestCase::Receive, this, 2, 1);
+  Simulator::Schedule (MilliSeconds (300), &WaveBsmStatsPirTestCase::Receive, this, 3, 2);
+  Simulator::Schedule (MilliSeconds (500), &WaveBsmStatsPirTestCase::Receive, this, 1, 2);
+  Simulator::Run ();
+
+  // gaps of 100, 300 and 100 ms
+  NS_TEST_ASSERT_MSG_EQ (m_stats->GetPIR (&max, &min), 166667, "wrong mean gap");
+  NS_TEST_ASSERT_MSG_EQ (max, 300000, "wrong largest gap");
+  NS_TEST_ASSERT_MSG_EQ (min, 99999, "smallest gap not capped as before");
+
+  WaveBsmStats::PirStats pair = m_stats->GetPirStats (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (pair.count, 2, "wrong gap count of 1 -> 2");
+  NS_TEST_ASSERT_MSG_EQ (pair.minUs, 100000, "wrong smallest gap of 1 -> 2");
+  NS_TEST_ASSERT_MSG_EQ (pair.lastUs, 500000, "wrong last reception of 1 -> 2");
+  NS_TEST_ASSERT_MSG_EQ (m_stats->GetPirStats (3, 2).count, 0, "3 -> 2 has no gap");
+  NS_TEST_ASSERT_MSG_EQ (m_stats->GetPirStats (2, 3).lastUs, -1, "2 -> 3 was never heard");
+
+  std::vector<uint32_t> histogram = m_stats->GetPirHistogram ();
+  NS_TEST_ASSERT_MSG_EQ (histogram.size (), WaveBsmStats::PIR_BUCKETS, "wrong bucket count");
+  NS_TEST_ASSERT_MSG_EQ (histogram[2], 2, "wrong count of 100 ms gaps");
+  NS_TEST_ASSERT_MSG_EQ (histogram[6], 1, "wrong count of 300 ms gaps");
+
+  // a reset forgets the last receptions too
+  m_stats->ResetRecvTimeMap ();
+  Simulator::Schedule (MilliSeconds (100), &WaveBsmStatsPirTestCase::Receive, this, 1, 2);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_stats->GetPIR (&max, &min), -1, "gap across a reset");
+  Simulator::Destroy ();
+  m_stats = 0;
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief Check the quantiles of BsmDelayHistogram against sorted samples
+ */
+class BsmDelayHistogramTestCase : public TestCase
+{
+public:
+  BsmDelayHistogramTestCase ();
+  virtual ~BsmDelayHistogramTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BsmDelayHistogramTestCase::BsmDelayHistogramTestCase ()
+  : TestCase ("Check the quantiles of BsmDelayHistogram against sorted samples")
+{
+}
+
+BsmDelayHistogramTestCase::~BsmDelayHistogramTestCase ()
+{
+}
+
+void
+BsmDelayHistogramTestCase::DoRun (void)
+{
+  BsmDelayHistogram empty;
+  NS_TEST_ASSERT_MSG_EQ (empty.GetQuantile (0.5), 0, "quantile of nothing");
+
+  Ptr<ExponentialRandomVariable> rng = CreateObject<ExponentialRandomVariable> ();
+  rng->SetAttribute ("Mean", DoubleValue (5000));
+  std::vector<uint64_t> samples;
+  BsmDelayHistogram first, second;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      uint64_t value = rng->GetInteger ();
+      samples.push_back (value);
+      // the halves are merged below
+      (i % 2 ? first : second).Add (value);
+    }
+  first.Merge (second);
+  NS_TEST_ASSERT_MSG_EQ (first.GetCount (), samples.size (), "values lost in the merge");
+  std::sort (samples.begin (), samples.end ());
+  NS_TEST_ASSERT_MSG_EQ (first.GetMin (), samples.front (), "wrong smallest value");
+  NS_TEST_ASSERT_MSG_EQ (first.GetMax (), samples.back (), "wrong largest value");
+
+  double quantiles[] = { 0, 0.5, 0.9, 0.99, 0.999, 1 };
+  for (uint32_t i = 0; i < sizeof (quantiles) / sizeof (quantiles[0]); i++)
+    {
+      uint64_t rank = std::max<uint64_t> (1, std::ceil (quantiles[i] * samples.size ()));
+      double exact = samples[rank - 1];
+      double estimate = first.GetQuantile (quantiles[i]);
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (estimate, exact, "quantile " << quantiles[i] << " below the exact value");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (estimate, exact * (1 + 1.0 / (1 << BsmDelayHistogram::SUB_BITS)),
+                                   "quantile " << quantiles[i] << " too far above the exact value");
+    }
+
+  first.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (first.GetCount (), 0, "values left after a reset");
+  first.Add (7);
+  NS_TEST_ASSERT_MSG_EQ (first.GetQuantile (0.99), 7, "small values are exact");
+}
+
+/**
+ * \ingroup wave-test
+ * \ingroup tests
+ *
+ * \brief WaveBsmStats Test Suite
+ */
+static class WaveBsmStatsTestSuite : public TestSuite
+{
+public:
+  WaveBsmStatsTestSuite () : TestSuite ("wave-bsm-stats", UNIT)
+  {
+    AddTestCase (new WaveBsmStatsPirTestCase (), TestCase::QUICK);
+    AddTestCase (new BsmDelayHistogramTestCase (), TestCase::QUICK);
+  }
+} g_waveBsmStatsTestSuite; ///< the test suite
@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tdma-activity-index.h"
+#include "wifi-phy.h"
+#include "wifi-phy-listener.h"
+#include "wifi-net-device.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/mobility-model.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TdmaActivityIndex");
+
+/**
+ * Listener for the PHY of a TDMA device: forwards the start of its
+ * transmissions to the TdmaActivityIndex.
+ */
+class TdmaActivityListener : public ns3::WifiPhyListener
+{
+public:
+  /**
+   * Create a TdmaActivityListener for a transmitter of the index.
+   *
+   * \param index the index
+   * \param id the index of the transmitter
+   */
+  TdmaActivityListener (TdmaActivityIndex *index, uint32_t id)
+    : m_index (index),
+      m_id (id)
+  {
+  }
+  virtual ~TdmaActivityListener ()
+  {
+  }
+  void NotifyRxStart (Time)
+  {
+  }
+  void NotifyRxEndOk (void)
+  {
+  }
+  void NotifyRxEndError (void)
+  {
+  }
+  void NotifyTxStart (Time duration, double)
+  {
+    m_index->NotifyTxStart (m_id, duration);
+  }
+  void NotifyMaybeCcaBusyStart (Time)
+  {
+  }
+  void NotifySwitchingStart (Time)
+  {
+  }
+  void NotifySleep (void)
+  {
+  }
+  void NotifyOff (void)
+  {
+  }
+  void NotifyWakeup (void)
+  {
+  }
+  void NotifyOn (void)
+  {
+  }
+
+private:
+  TdmaActivityIndex *m_index;  //!< the index to forward to
+  uint32_t m_id;               //!< the index of the transmitter
+};
+
+Ptr<TdmaActivityIndex> TdmaActivityIndex::m_index = 0;
+
+Ptr<TdmaActivityIndex>
+TdmaActivityIndex::Get (void)
+{
+  if (m_index == 0)
+    {
+      m_index = Ptr<TdmaActivityIndex> (new TdmaActivityIndex (), false);
+      Simulator::ScheduleDestroy (&TdmaActivityIndex::Destroy);
+    }
+  return m_index;
+}
+
+void
+TdmaActivityIndex::Destroy (void)
+{
+  m_index = 0;
+}
+
+TdmaActivityIndex::TdmaActivityIndex ()
+  : m_scanned (0),
+    m_grid (200.0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TdmaActivityIndex::~TdmaActivityIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_transmitters.size (); i++)
+    {
+      // a disposed PHY has already dropped its listeners
+      if (m_transmitters[i].phy->GetDevice () != 0)
+        {
+          m_transmitters[i].phy->UnregisterListener (m_transmitters[i].listener);
+        }
+      delete m_transmitters[i].listener;
+    }
+}
+
+void
+TdmaActivityIndex::Scan (void)
+{
+  std::vector<uint32_t>::iterator pending = m_pending.begin ();
+  for (std::vector<uint32_t>::const_iterator i = m_pending.begin (); i != m_pending.end (); ++i)
+    {
+      if (!Add (NodeList::GetNode (*i)))
+        {
+          *pending++ = *i;
+        }
+    }
+  m_pending.erase (pending, m_pending.end ());
+  for (; m_scanned < NodeList::GetNNodes (); m_scanned++)
+    {
+      if (!Add (NodeList::GetNode (m_scanned)))
+        {
+          m_pending.push_back (m_scanned);
+        }
+    }
+}
+
+bool
+TdmaActivityIndex::Add (Ptr<Node> node)
+{
+  if (node->GetNDevices () == 0)
+    {
+      return false;
+    }
+  Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (node->GetDevice (0));
+  if (device == 0)
+    {
+      // the first device of the node is not a TDMA device, and never will be
+      return true;
+    }
+  Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
+  if (device->GetPhy () == 0 || mobility == 0)
+    {
+      return false;
+    }
+  uint32_t id = m_transmitters.size ();
+  Transmitter transmitter;
+  transmitter.phy = device->GetPhy ();
+  transmitter.mobility = mobility;
+  transmitter.listener = new TdmaActivityListener (this, id);
+  transmitter.phy->RegisterListener (transmitter.listener);
+  m_transmitters.push_back (transmitter);
+  // the PHY may already be transmitting
+  if (transmitter.phy->IsStateTx ())
+    {
+      NotifyTxStart (id, transmitter.phy->GetDelayUntilIdle ());
+    }
+  return true;
+}
+
+void
+TdmaActivityIndex::NotifyTxStart (uint32_t id, Time duration)
+{
+  Transmitter &transmitter = m_transmitters[id];
+  transmitter.end = std::max (transmitter.end, Simulator::Now () + duration);
+  m_grid.Update (id, transmitter.mobility->GetPosition ());
+}
+
+Time
+TdmaActivityIndex::GetBusyUntil (const Vector &position, double range)
+{
+  if (m_scanned != NodeList::GetNNodes () || !m_pending.empty ())
+    {
+      Scan ();
+    }
+  Time now = Simulator::Now ();
+  Time end;
+  m_candidates.clear ();
+  // transmitters are filed where they started, and move little while on air
+  m_grid.Query (position, range + 1.0, m_candidates);
+  for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); ++i)
+    {
+      const Transmitter &transmitter = m_transmitters[*i];
+      if (transmitter.end <= now)
+        {
+          m_grid.Remove (*i);
+        }
+      else if (CalculateDistance (position, transmitter.mobility->GetPosition ()) <= range)
+        {
+          end = std::max (end, transmitter.end);
+        }
+    }
+  return end;
+}
+
+} // namespace ns3
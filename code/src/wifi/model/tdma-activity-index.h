@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TDMA_ACTIVITY_INDEX_H
+#define TDMA_ACTIVITY_INDEX_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/spatial-grid.h"
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+class WifiPhy;
+class MobilityModel;
+class WifiPhyListener;
+
+/**
+ * \brief the transmissions in progress of the TDMA devices, by position
+ *
+ * The TDMA device of a node is its first device. The index listens to
+ * the PHY of each of them and files a transmitter in a SpatialGrid when
+ * it starts to transmit, together with the time the transmission ends,
+ * so that Txop can find the TDMA transmitters around a CSMA device and
+ * the time they all fall silent without visiting every node. Finished
+ * transmissions are dropped from the grid lazily, when a query finds
+ * them.
+ *
+ * The nodes are picked up on the first query, and again whenever nodes
+ * were added since. A node whose TDMA device has no PHY or which has no
+ * mobility yet is looked at again on every query until it has both;
+ * there is one index per simulation.
+ */
+class TdmaActivityIndex : public SimpleRefCount<TdmaActivityIndex>
+{
+public:
+  /**
+   * \return the index, created on first use
+   */
+  static Ptr<TdmaActivityIndex> Get (void);
+
+  ~TdmaActivityIndex ();
+
+  /**
+   * \param position the query position
+   * \param range the query range (m)
+   * \return the time the last TDMA transmission in progress within range
+   *         of position ends, or zero if there is none
+   */
+  Time GetBusyUntil (const Vector &position, double range);
+
+  /**
+   * Record the start of a transmission.
+   *
+   * \param id the index of the transmitter
+   * \param duration the duration of the transmission
+   */
+  void NotifyTxStart (uint32_t id, Time duration);
+
+private:
+  TdmaActivityIndex ();
+  /// Listen to the TDMA devices of the nodes added or set up since the last scan
+  void Scan (void);
+  /**
+   * Listen to the TDMA device of a node.
+   *
+   * \param node the node
+   * \return false if the node is not set up yet and must be looked at again
+   */
+  bool Add (Ptr<Node> node);
+  /// Drop the index when the simulator is destroyed
+  static void Destroy (void);
+
+  static Ptr<TdmaActivityIndex> m_index;  //!< the index of the running simulation
+
+  /// A TDMA transmitter
+  struct Transmitter
+  {
+    Ptr<WifiPhy> phy;                 //!< its PHY
+    Ptr<MobilityModel> mobility;      //!< its mobility
+    WifiPhyListener *listener;        //!< our listener on its PHY
+    Time end;                         //!< end of its last transmission
+  };
+
+  std::vector<Transmitter> m_transmitters;  //!< transmitters, by id
+  uint32_t m_scanned;                       //!< nodes already scanned
+  std::vector<uint32_t> m_pending;          //!< scanned nodes which were not set up yet
+  SpatialGrid m_grid;                       //!< ids of the transmitters which may be transmitting
+  std::vector<uint32_t> m_candidates;       //!< scratch space for grid queries
+};
+
+} // namespace ns3
+
+#endif /* TDMA_ACTIVITY_INDEX_H */
@@ -29,11 +29,11 @@
 #include "mac-low.h"
 #include "wifi-remote-station-manager.h"
 #include "wifi-phy.h"
-#include "ns3/node-container.h"
+#include "tdma-activity-index.h"
 #include "ns3/node.h"
-#include "ns3/wifi-net-device.h"
 #include "ns3/vector.h"
 #include "ns3/mobility-model.h"
+#include <algorithm>
 
 #undef NS_LOG_APPEND_CONTEXT
 #define NS_LOG_APPEND_CONTEXT if (m_low != 0) { std::clog << "[mac=" << m_low->GetAddress () << "] "; }
@@ -88,8 +88,7 @@ Txop::Txop ()
     m_backoffSlots (0),
     m_backoffStart (Seconds (0.0)),
     m_currentPacket (0),
-    recursionCount(0), 
-    maxRecursionLimit(3)
+    m_accessSuspended (false)
 {
   NS_LOG_FUNCTION (this);
   m_queue = CreateObject<WifiMacQueue> ();
@@ -105,6 +104,7 @@ void
 Txop::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_tdmaDeferEvent.Cancel ();
   m_queue = 0;
   m_low = 0;
   m_stationManager = 0;
@@ -179,6 +179,17 @@ Txop::GetWifiMacQueue () const
   return m_queue;
 }
 
+void
+Txop::SetAccessSuspended (bool suspended)
+{
+  NS_LOG_FUNCTION (this << suspended);
+  m_accessSuspended = suspended;
+  if (!suspended)
+    {
+      StartAccessIfNeeded ();
+    }
+}
+
 void
 Txop::SetMinCw (uint32_t minCw)
 {
@@ -308,56 +319,44 @@ Txop::Queue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
   m_stationManager->PrepareForQueue (hdr.GetAddr1 (), &hdr, packet);
   m_queue->Enqueue (Create<WifiMacQueueItem> (packet, hdr));
 
-  Ptr<WifiPhy> phy = this->GetLow()->GetPhy();
-  Ptr<Node> node = phy->GetDevice()->GetNode();
-  Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(phy->GetDevice());
-  Ptr<WifiNetDevice> tdma = DynamicCast<WifiNetDevice>(node->GetDevice(0));
-  Ptr<WifiNetDevice> csma = DynamicCast<WifiNetDevice>(node->GetDevice(1));
-
-  Ptr<MobilityModel> currentMobility = node->GetObject<MobilityModel>();
-  Vector currentPosition = currentMobility->GetPosition();
-
-  NodeContainer nodes = NodeContainer::GetGlobal();
-  bool isTdmaTransmitting = false;
-
-  for (NodeContainer::Iterator i = nodes.Begin(); i != nodes.End(); ++i)
-  {
-    Ptr<Node> n = *i;
-    Ptr<WifiNetDevice> otherDevice = DynamicCast<WifiNetDevice>(n->GetDevice(0));  // 获取 TDMA 设备
-    if (otherDevice != 0)
+  if (m_tdmaDeferEvent.IsRunning ())
     {
-      Ptr<WifiPhy> otherPhy = otherDevice->GetPhy();
-      Ptr<MobilityModel> otherMobility = n->GetObject<MobilityModel>();
-      Vector otherPosition = otherMobility->GetPosition();
-
-      double distance = CalculateDistance(currentPosition, otherPosition);
-
-      if (distance <= 200.0 && otherPhy->IsStateTx())
-      {
-        isTdmaTransmitting = true;
-        break;  // 一旦找到有节点在发送数据，则停止检查
-      }
+      // access is requested once the nearby TDMA transmissions are over
+      return;
+    }
+  Ptr<Node> node = GetLow ()->GetPhy ()->GetDevice ()->GetNode ();
+  Vector position = node->GetObject<MobilityModel> ()->GetPosition ();
+  Time busyUntil = TdmaActivityIndex::Get ()->GetBusyUntil (position, 200.0);
+  if (busyUntil > Simulator::Now ())
+    {
+      // hold off while a TDMA device within 200 m is transmitting, for
+      // at most three of the former 0.2 ms retries
+      m_tdmaDeferDeadline = Simulator::Now () + 3 * MicroSeconds (200);
+      m_tdmaDeferEvent = Simulator::Schedule (std::min (busyUntil, m_tdmaDeferDeadline) - Simulator::Now (),
+                                              &Txop::ResumeAfterTdma, this);
+      return;
     }
-  }
+  StartAccessIfNeeded ();
+}
 
-    if (isTdmaTransmitting)
+void
+Txop::ResumeAfterTdma (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  if (now < m_tdmaDeferDeadline)
     {
-        if (recursionCount < maxRecursionLimit)
+      Ptr<Node> node = GetLow ()->GetPhy ()->GetDevice ()->GetNode ();
+      Vector position = node->GetObject<MobilityModel> ()->GetPosition ();
+      Time busyUntil = TdmaActivityIndex::Get ()->GetBusyUntil (position, 200.0);
+      if (busyUntil > now)
         {
-            recursionCount++;
-            Time delayTime = MilliSeconds(0.2); 
-            Simulator::Schedule(delayTime, &Txop::Queue, this, packet, hdr);
-            return;
-        }
-        else
-        {
-            recursionCount = 0;
-            StartAccessIfNeeded();
-            return;
+          m_tdmaDeferEvent = Simulator::Schedule (std::min (busyUntil, m_tdmaDeferDeadline) - now,
+                                                  &Txop::ResumeAfterTdma, this);
+          return;
         }
     }
-    recursionCount = 0;
-    StartAccessIfNeeded();
+  StartAccessIfNeeded ();
 }
 
 int64_t
@@ -373,7 +372,7 @@ Txop::RestartAccessIfNeeded (void)
 {
   NS_LOG_FUNCTION (this);
   if ((m_currentPacket != 0
-       || !m_queue->IsEmpty ())
+       || (!m_accessSuspended && !m_queue->IsEmpty ()))
       && !IsAccessRequested ()
       && !m_low->IsCfPeriod ())
     {
@@ -386,6 +385,7 @@ Txop::StartAccessIfNeeded (void)
 {
   NS_LOG_FUNCTION (this);
   if (m_currentPacket == 0
+      && !m_accessSuspended
       && !m_queue->IsEmpty ()
       && !IsAccessRequested ()
       && !m_low->IsCfPeriod ())
@@ -511,6 +511,11 @@ Txop::NotifyAccessGranted (void)
   m_accessRequested = false;
   if (m_currentPacket == 0)
     {
+      if (m_accessSuspended)
+        {
+          NS_LOG_DEBUG ("access suspended");
+          return;
+        }
       if (m_queue->IsEmpty ())
         {
           NS_LOG_DEBUG ("queue empty");
@@ -21,6 +21,7 @@
 #ifndef TXOP_H
 #define TXOP_H
 
+#include "ns3/event-id.h"
 #include "mac-low-transmission-parameters.h"
 #include "wifi-mac-header.h"
 
@@ -155,6 +156,14 @@ public:
    * \return WifiMacQueue
    */
   Ptr<WifiMacQueue > GetWifiMacQueue () const;
+  /**
+   * Suspend or resume channel access for the packets in the queue. While
+   * access is suspended the queue may be served by another MAC sharing it;
+   * resuming requests access if there are packets to transmit.
+   *
+   * \param suspended whether channel access is suspended
+   */
+  void SetAccessSuspended (bool suspended);
 
   /**
    * Set the minimum contention window size.
@@ -379,6 +388,11 @@ protected:
    * Request access from DCF manager if needed.
    */
   virtual void StartAccessIfNeeded (void);
+  /**
+   * Request access once the TDMA transmissions around this station are
+   * over, or the deferral deadline has passed, whichever comes first.
+   */
+  void ResumeAfterTdma (void);
 
   /**
    * \returns the current value of the CW variable. The initial value is
@@ -523,8 +537,9 @@ protected:
   MacLowTransmissionParameters m_currentParams; ///< current transmission parameters
   uint8_t m_fragmentNumber; //!< the fragment number
 
-  int recursionCount;
-  const int maxRecursionLimit;
+  bool m_accessSuspended;    //!< whether the queue is left to another MAC
+  EventId m_tdmaDeferEvent;  //!< pending ResumeAfterTdma
+  Time m_tdmaDeferDeadline;  //!< time by which access is requested anyway
 
 };
 
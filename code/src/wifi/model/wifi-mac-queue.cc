@@ -74,14 +74,28 @@ WifiMacQueue::GetMaxDelay (void) const
   return m_maxDelay;
 }
 
+void
+WifiMacQueue::SetExpiredCallback (Callback<bool, Ptr<const WifiMacQueueItem> > callback)
+{
+  NS_LOG_FUNCTION (this);
+  m_expired = callback;
+}
+
+bool
+WifiMacQueue::IsExpired (Ptr<const WifiMacQueueItem> item) const
+{
+  return Simulator::Now () > item->GetTimeStamp () + m_maxDelay
+         || (!m_expired.IsNull () && m_expired (item));
+}
+
 bool
 WifiMacQueue::TtlExceeded (ConstIterator &it)
 {
   NS_LOG_FUNCTION (this);
 
-  if (Simulator::Now () > (*it)->GetTimeStamp () + m_maxDelay)
+  if (IsExpired (*it))
     {
-      NS_LOG_DEBUG ("Removing packet that stayed in the queue for too long (" <<
+      NS_LOG_DEBUG ("Removing expired packet (queued for " <<
                     Simulator::Now () - (*it)->GetTimeStamp () << ")");
       auto curr = it++;
       DoRemove (curr);
@@ -228,9 +242,9 @@ WifiMacQueue::Peek (void) const
   NS_LOG_FUNCTION (this);
   for (auto it = Head (); it != Tail (); it++)
     {
-      // skip packets that stayed in the queue for too long. They will be
+      // skip expired packets, e.g. which stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (Simulator::Now () <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (!IsExpired (*it))
         {
           return DoPeek (it);
         }
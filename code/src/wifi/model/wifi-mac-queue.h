@@ -75,6 +75,14 @@ public:
    * \return the maximum delay
    */
   Time GetMaxDelay (void) const;
+  /**
+   * Set a callback telling whether an item has expired. The items for which
+   * it returns true are dropped like the ones which stayed longer than the
+   * maximum delay.
+   *
+   * \param callback the callback
+   */
+  void SetExpiredCallback (Callback<bool, Ptr<const WifiMacQueueItem> > callback);
 
   /**
    * Enqueue the given Wifi MAC queue item at the <i>end</i> of the queue.
@@ -220,16 +228,23 @@ public:
 
 private:
   /**
-   * Remove the item pointed to by the iterator <i>it</i> if it has been in the
-   * queue for too long. If the item is removed, the iterator is updated to
+   * Remove the item pointed to by the iterator <i>it</i> if it has expired,
+   * e.g. if it has been in the queue for too long. If the item is removed, the iterator is updated to
    * point to the item that followed the erased one.
    *
    * \param it an iterator pointing to the item
    * \return true if the item is removed, false otherwise
    */
   bool TtlExceeded (ConstIterator &it);
+  /**
+   * \param item the item
+   * \return true if the item stayed in the queue for too long, or if the
+   *         expired callback tells so
+   */
+  bool IsExpired (Ptr<const WifiMacQueueItem> item) const;
 
   Time m_maxDelay;                          //!< Time to live for packets in the queue
+  Callback<bool, Ptr<const WifiMacQueueItem> > m_expired; //!< Tells whether an item has expired
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
 
   NS_LOG_TEMPLATE_DECLARE;                  //!< redefinition of the log component
@@ -22,6 +22,8 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -33,7 +35,8 @@
 #include "ns3/location-packet-tag.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/GlobalPacketDropController.h"
-
+#include <algorithm>
+#include <limits>
 
 namespace ns3 {
 
@@ -56,11 +59,31 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("RxCulling",
+                   "If true, do not deliver transmissions to the PHYs which the propagation "
+                   "loss model chain guarantees to be below their energy detection threshold.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_rxCulling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RxCullingMargin",
+                   "Margin (dB) below the lowest energy detection threshold of the attached "
+                   "PHYs under which receivers are culled when RxCulling is enabled. Culled "
+                   "signals are missing from the interference at the culled receivers, so "
+                   "a margin which puts them well below the noise floor (e.g., 30 dB) keeps "
+                   "the receptions unchanged.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_rxCullingMargin),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_rxCulling (false),
+    m_rxCullingMargin (0.0),
+    m_cullingThresholdDbm (0.0),
+    m_cullingTxPowerDbm (std::numeric_limits<double>::quiet_NaN ()),
+    m_cullingRange (std::numeric_limits<double>::infinity ())
 {
   NS_LOG_FUNCTION (this);
 }
@@ -71,6 +94,14 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_index.Clear ();
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
@@ -116,42 +147,168 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
       return;
   }
 
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  if (!m_rxCulling || !GetCandidates (senderMobility->GetPosition (), txPowerDbm))
+    {
+      m_candidates.resize (m_phyList.size ());
+      for (uint32_t i = 0; i < m_phyList.size (); i++)
+        {
+          m_candidates[i] = i;
+        }
+    }
+
+  if (m_loss->IsBatchSupported ())
     {
-      if (sender != (*i))
+      // keep the receivers only, and compute their Rx power at once
+      uint32_t n = 0;
+      m_batchPositions.clear ();
+      for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (IsReceiver (sender, m_phyList[*i]))
             {
-              continue;
+              m_candidates[n++] = *i;
+              m_batchPositions.push_back (m_phyList[*i]->GetMobility ()->GetPosition ());
             }
+        }
+      m_candidates.resize (n);
+      m_loss->CalcRxPowerBatch (txPowerDbm, senderMobility, m_batchPositions, m_batchRxPowerDbm);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          Deliver (senderMobility, m_phyList[m_candidates[i]], packet, m_batchRxPowerDbm[i], duration);
+        }
+      return;
+    }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+  for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      SendTo (sender, senderMobility, m_phyList[*i], packet, txPowerDbm, duration);
+    }
+}
+
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+                         Ptr<const Packet> packet, double txPowerDbm, Time duration) const
+{
+  if (!IsReceiver (sender, receiver))
+    {
+      return;
+    }
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm");
+  Deliver (senderMobility, receiver, packet, rxPowerDbm, duration);
+}
+
+bool
+YansWifiChannel::IsReceiver (Ptr<YansWifiPhy> sender, Ptr<YansWifiPhy> receiver) const
+{
+  //For now don't account for inter channel interference nor channel bonding
+  return sender != receiver && receiver->GetChannelNumber () == sender->GetChannelNumber ();
+}
+
+void
+YansWifiChannel::Deliver (Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+                          Ptr<const Packet> packet, double rxPowerDbm, Time duration) const
+{
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
 
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          LocTag tag (senderMobility->GetDistanceFrom(receiverMobility));
-          copy->AddPacketTag (tag);
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Packet> copy = packet->Copy ();
+  LocTag tag (senderMobility->GetDistanceFrom(receiverMobility));
+  copy->AddPacketTag (tag);
 
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm, duration);
+}
+
+bool
+YansWifiChannel::GetCandidates (const Vector &position, double txPowerDbm) const
+{
+  if (!m_index.IsValid ())
+    {
+      // PHYs may have been added or configured since the last rebuild
+      m_cullingThresholdDbm = std::numeric_limits<double>::infinity ();
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+        {
+          m_cullingThresholdDbm = std::min (m_cullingThresholdDbm, (*i)->GetEdThreshold () - (*i)->GetRxGain ());
+        }
+      m_cullingThresholdDbm -= m_rxCullingMargin;
+      m_cullingTxPowerDbm = std::numeric_limits<double>::quiet_NaN ();
+    }
+  double range = GetCullingRange (txPowerDbm);
+  if (range == std::numeric_limits<double>::infinity ())
+    {
+      return false;
+    }
+  if (m_index.NeedsRebuild (range))
+    {
+      RebuildIndex (range);
+    }
+  m_candidates.clear ();
+  m_index.Query (position, range, m_candidates);
+  std::sort (m_candidates.begin (), m_candidates.end ());
+  NS_LOG_DEBUG ("culling range=" << range << "m, drift=" << m_index.GetDrift () << "m, " <<
+                m_candidates.size () << "/" << m_phyList.size () << " receivers");
+  return true;
+}
+
+double
+YansWifiChannel::GetCullingRange (double txPowerDbm) const
+{
+  if (txPowerDbm == m_cullingTxPowerDbm)
+    {
+      return m_cullingRange;
+    }
+  double range = std::numeric_limits<double>::infinity ();
+  double hi = 1e6;
+  if (m_loss != 0 && m_loss->GetRxPowerUpperBound (txPowerDbm, hi) < m_cullingThresholdDbm)
+    {
+      // the bound does not increase with distance: bisect for the
+      // shortest distance at which it drops below the threshold
+      double lo = 0;
+      for (uint32_t i = 0; i < 64 && hi - lo > 1e-3; i++)
+        {
+          double mid = (lo + hi) / 2;
+          if (m_loss->GetRxPowerUpperBound (txPowerDbm, mid) < m_cullingThresholdDbm)
             {
-              dstNode = 0xffffffff;
+              hi = mid;
             }
           else
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              lo = mid;
             }
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
         }
+      range = hi;
+    }
+  NS_LOG_DEBUG ("txPower=" << txPowerDbm << "dbm, threshold=" << m_cullingThresholdDbm << "dbm, culling range=" << range << "m");
+  m_cullingTxPowerDbm = txPowerDbm;
+  m_cullingRange = range;
+  return range;
+}
+
+void
+YansWifiChannel::RebuildIndex (double range) const
+{
+  NS_LOG_FUNCTION (this << range);
+  std::vector<Ptr<MobilityModel> > mobility (m_phyList.size ());
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      mobility[i] = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
     }
+  m_index.Rebuild (mobility, range);
 }
 
 void
@@ -178,6 +335,7 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
 {
   NS_LOG_FUNCTION (this << phy);
   m_phyList.push_back (phy);
+  m_index.Invalidate ();
 }
 
 int64_t
@@ -22,10 +22,13 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include "ns3/mobile-spatial-grid.h"
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
@@ -40,6 +43,19 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the RxCulling attribute is enabled, Send only visits the receivers
+ * that may be reached above the lowest energy detection threshold of the
+ * attached PHYs, as bounded by PropagationLossModel::GetRxPowerUpperBound.
+ * Receivers are kept in a MobileSpatialGrid, and the remaining receivers
+ * are visited in the order they were added, so that their receptions are
+ * unchanged.
+ * Culled receivers do not see the signal at all, not even as interference,
+ * and loss or delay models that draw random numbers per receiver will draw
+ * fewer of them. With no RxCullingMargin, a signal just under the
+ * detection threshold is culled from a receiver which is receiving another
+ * frame, and its SINR changes; a margin which puts the culled signals well
+ * below the noise floor (e.g., 30 dB) leaves the receptions unchanged.
  */
 class YansWifiChannel : public Channel
 {
@@ -98,12 +114,66 @@ public:
   int64_t AssignStreams (int64_t stream);
 
 
+protected:
+  virtual void DoDispose (void);
+
 private:
   /**
    * A vector of pointers to YansWifiPhy.
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
 
+  /**
+   * Compute the reception of a packet by one receiver and schedule it.
+   *
+   * \param sender the phy object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the phy object receiving the packet
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+               Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+  /**
+   * \param sender the phy object from which a packet is originating
+   * \param receiver a phy object of the channel
+   * \return whether the receiver gets the packets of the sender
+   */
+  bool IsReceiver (Ptr<YansWifiPhy> sender, Ptr<YansWifiPhy> receiver) const;
+  /**
+   * Schedule the reception of a packet by one receiver, at a given power.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the phy object receiving the packet
+   * \param packet the packet to send
+   * \param rxPowerDbm the rx power of the packet at the receiver, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void Deliver (Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+                Ptr<const Packet> packet, double rxPowerDbm, Time duration) const;
+  /**
+   * Fill m_candidates with the indices, in increasing order, of the PHYs
+   * which may receive a transmission from the given position.
+   *
+   * \param position the sender position
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \return false if no receiver can be excluded
+   */
+  bool GetCandidates (const Vector &position, double txPowerDbm) const;
+  /**
+   * \param txPowerDbm the tx power, in dBm
+   * \return the distance beyond which no PHY can detect the transmission,
+   *         or +infinity if the loss model chain cannot bound it
+   */
+  double GetCullingRange (double txPowerDbm) const;
+  /**
+   * File every PHY in the receiver index at its current position.
+   *
+   * \param range the culling range the cells are sized for
+   */
+  void RebuildIndex (double range) const;
+
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
@@ -119,6 +189,16 @@ private:
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  bool m_rxCulling;                    //!< Whether to skip receivers out of detection range
+  double m_rxCullingMargin;            //!< Margin (dB) below the lowest detection threshold
+  mutable MobileSpatialGrid m_index;   //!< Receiver index, filed by phy index
+  mutable double m_cullingThresholdDbm; //!< Rx power below which no PHY detects a signal (dBm)
+  mutable double m_cullingTxPowerDbm;  //!< Tx power m_cullingRange was computed for (dBm)
+  mutable double m_cullingRange;       //!< Culling range for m_cullingTxPowerDbm (m)
+  mutable std::vector<uint32_t> m_candidates; //!< Scratch list of receiver indices
+  mutable std::vector<Vector> m_batchPositions; //!< Scratch list of receiver positions, for batched Rx power
+  mutable std::vector<double> m_batchRxPowerDbm; //!< Scratch list of batched Rx powers (dBm)
 };
 
 } //namespace ns3
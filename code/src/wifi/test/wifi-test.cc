@@ -43,6 +43,9 @@
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mgt-headers.h"
+#include "ns3/wifi-mac-trailer.h"
+#include "ns3/txop.h"
+#include "ns3/tdma-activity-index.h"
 
 using namespace ns3;
 
@@ -1514,6 +1517,437 @@ Bug2831TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_countOperationalChannelWidth40, 20, "Incorrect operational channel width after channel change");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that YansWifiChannel::RxCulling leaves the receptions
+ * unchanged
+ *
+ * Two senders 400 m apart transmit at about the same time, the second one
+ * first, so that its signal is part of the interference the first one is
+ * received with, to receivers between them and others up to 4 km away.
+ * With a culling margin of 30 dB, only the receivers more than 1.5 km
+ * away, where both signals are far below the noise floor, are culled, and
+ * each receiver receives the same frames, with exactly the same Rx power
+ * and SNR, whether culling is enabled or not. (With no margin, the second
+ * signal would be culled from the receivers just out of its range, which
+ * the first one still reaches.)
+ */
+class YansWifiChannelRxCullingTest : public TestCase
+{
+public:
+  YansWifiChannelRxCullingTest ();
+  virtual ~YansWifiChannelRxCullingTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Run the scenario
+   * \param culling whether the channel culls receivers
+   */
+  void RunOne (bool culling);
+  /**
+   * Create a node with a TDMA device on its own channel and a device on
+   * the channel under test, as the channel expects of SATMAC nodes
+   * \param pos the position
+   * \param channel the channel under test
+   * \param other the channel of the TDMA device
+   * \return the PHY on the channel under test, whose frames the test
+   * receives instead of the MAC
+   */
+  Ptr<YansWifiPhy> CreateOne (Vector pos, Ptr<YansWifiChannel> channel, Ptr<YansWifiChannel> other);
+  /**
+   * Send a frame
+   * \param phy the sending PHY
+   */
+  void SendOne (Ptr<YansWifiPhy> phy);
+  /**
+   * Callback triggered when a frame is received by a receiver
+   * \param index the index of the receiver
+   * \param p the received packet
+   * \param snr the SNR of the frame
+   * \param txVector the TXVECTOR of the frame
+   */
+  void RxOk (uint32_t index, Ptr<Packet> p, double snr, WifiTxVector txVector);
+  /**
+   * Callback triggered when a receiver hands a frame up, with its Rx power
+   * \param index the index of the receiver
+   * \param p the received packet
+   * \param channelFreqMhz the frequency of the channel
+   * \param txVector the TXVECTOR of the frame
+   * \param aMpdu the A-MPDU information of the frame
+   * \param signalNoise the Rx power and the noise of the frame
+   */
+  void RxSniff (uint32_t index, Ptr<const Packet> p, uint16_t channelFreqMhz, WifiTxVector txVector,
+                MpduInfo aMpdu, SignalNoiseDbm signalNoise);
+  /**
+   * Callback triggered when a receiver drops a frame
+   * \param p the dropped packet
+   */
+  void RxDrop (Ptr<const Packet> p);
+
+  std::vector<uint32_t> m_rxOk;  ///< frames received, by receiver
+  std::vector<double> m_snr;     ///< SNR of the last frame received, by receiver
+  std::vector<std::vector<double> > m_rxPower;  ///< Rx power of the frames received, by receiver
+  uint32_t m_rxDrop;             ///< frames dropped by all receivers
+};
+
+YansWifiChannelRxCullingTest::YansWifiChannelRxCullingTest ()
+  : TestCase ("Check that receiver culling does not change the receptions"),
+    m_rxDrop (0)
+{
+}
+
+YansWifiChannelRxCullingTest::~YansWifiChannelRxCullingTest ()
+{
+}
+
+Ptr<YansWifiPhy>
+YansWifiChannelRxCullingTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel, Ptr<YansWifiChannel> other)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  ObjectFactory mac;
+  mac.SetTypeId ("ns3::AdhocWifiMac");
+  ObjectFactory manager;
+  manager.SetTypeId ("ns3::ConstantRateWifiManager");
+
+  Ptr<YansWifiPhy> phys[2];
+  Ptr<YansWifiChannel> channels[2] = { other, channel };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+      Ptr<WifiMac> wifiMac = mac.Create<WifiMac> ();
+      wifiMac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      wifiMac->SetAddress (Mac48Address::Allocate ());
+      dev->SetMac (wifiMac);
+      dev->SetRemoteStationManager (manager.Create<WifiRemoteStationManager> ());
+      phys[i] = CreateObject<YansWifiPhy> ();
+      phys[i]->SetErrorRateModel (error);
+      phys[i]->SetChannel (channels[i]);
+      phys[i]->SetMobility (mobility);
+      phys[i]->SetDevice (dev);
+      phys[i]->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      // the same reception draws in both runs
+      phys[i]->AssignStreams (2 * node->GetId () + i);
+      dev->SetPhy (phys[i]);
+      node->AddDevice (dev);
+    }
+  return phys[1];
+}
+
+void
+YansWifiChannelRxCullingTest::SendOne (Ptr<YansWifiPhy> phy)
+{
+  WifiTxVector txVector = WifiTxVector (WifiPhy::GetOfdmRate6Mbps (), 0, WIFI_PREAMBLE_LONG, false, 1, 1, 0, 20, false, false);
+  Ptr<Packet> pkt = Create<Packet> (200);
+  WifiMacHeader hdr;
+  WifiMacTrailer trailer;
+  hdr.SetType (WIFI_MAC_DATA);
+  pkt->AddHeader (hdr);
+  pkt->AddTrailer (trailer);
+  phy->SendPacket (pkt, txVector);
+}
+
+void
+YansWifiChannelRxCullingTest::RxOk (uint32_t index, Ptr<Packet> p, double snr, WifiTxVector txVector)
+{
+  m_rxOk[index]++;
+  m_snr[index] = snr;
+}
+
+void
+YansWifiChannelRxCullingTest::RxSniff (uint32_t index, Ptr<const Packet> p, uint16_t channelFreqMhz, WifiTxVector txVector,
+                                       MpduInfo aMpdu, SignalNoiseDbm signalNoise)
+{
+  m_rxPower[index].push_back (signalNoise.signal);
+}
+
+void
+YansWifiChannelRxCullingTest::RxDrop (Ptr<const Packet> p)
+{
+  m_rxDrop++;
+}
+
+void
+YansWifiChannelRxCullingTest::RunOne (bool culling)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("RxCulling", BooleanValue (culling));
+  channel->SetAttribute ("RxCullingMargin", DoubleValue (30.0));
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  Ptr<YansWifiChannel> other = CreateObject<YansWifiChannel> ();
+  other->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  other->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+
+  Ptr<YansWifiPhy> first = CreateOne (Vector (0.0, 0.0, 0.0), channel, other);
+  Ptr<YansWifiPhy> second = CreateOne (Vector (400.0, 0.0, 0.0), channel, other);
+  uint32_t n = 60;
+  m_rxOk.assign (n, 0);
+  m_snr.assign (n, 0.0);
+  m_rxPower.assign (n, std::vector<double> ());
+  m_rxDrop = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double x = i < 40 ? 5.0 + 10.0 * i : 2000.0 + 100.0 * (i - 40);
+      Ptr<YansWifiPhy> phy = CreateOne (Vector (x, 5.0, 0.0), channel, other);
+      phy->SetReceiveOkCallback (MakeCallback (&YansWifiChannelRxCullingTest::RxOk, this).Bind (i));
+      phy->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&YansWifiChannelRxCullingTest::RxDrop, this));
+      phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeCallback (&YansWifiChannelRxCullingTest::RxSniff, this).Bind (i));
+    }
+
+  for (uint32_t t = 0; t < 5; t++)
+    {
+      Simulator::Schedule (Seconds (1.0 + 0.1 * t) - MicroSeconds (5), &YansWifiChannelRxCullingTest::SendOne, this, second);
+      Simulator::Schedule (Seconds (1.0 + 0.1 * t), &YansWifiChannelRxCullingTest::SendOne, this, first);
+    }
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelRxCullingTest::DoRun (void)
+{
+  RunOne (false);
+  std::vector<uint32_t> rxOk = m_rxOk;
+  std::vector<double> snr = m_snr;
+  std::vector<std::vector<double> > rxPower = m_rxPower;
+  uint32_t rxDrop = m_rxDrop;
+  RunOne (true);
+
+  uint32_t receivers = 0;
+  for (uint32_t i = 0; i < rxOk.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxOk[i], rxOk[i], "receiver " << i << " received other frames with culling");
+      NS_TEST_ASSERT_MSG_EQ (m_snr[i], snr[i], "receiver " << i << " saw another SNR with culling");
+      NS_TEST_ASSERT_MSG_EQ (rxPower[i].size (), rxOk[i], "Rx power of receiver " << i << " not recorded");
+      NS_TEST_ASSERT_MSG_EQ (m_rxPower[i].size (), rxPower[i].size (), "receiver " << i << " handed up other frames with culling");
+      for (uint32_t j = 0; j < rxPower[i].size () && j < m_rxPower[i].size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_rxPower[i][j], rxPower[i][j], "receiver " << i << " received frame " << j << " with another Rx power");
+        }
+      receivers += (rxOk[i] > 0);
+    }
+  NS_TEST_ASSERT_MSG_GT (receivers, 0, "no receiver in range");
+  NS_TEST_ASSERT_MSG_LT (receivers, rxOk.size (), "no receiver out of range");
+  // the receivers out of detection range dropped the frames they were not culled from
+  NS_TEST_ASSERT_MSG_LT (m_rxDrop, rxDrop, "no receiver culled");
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check that Txop holds off while a TDMA device nearby transmits
+ *
+ * Every node has a TDMA device on one channel and a CSMA device on
+ * another. A frame queued on the CSMA device of a node 50 m away from a
+ * transmitting TDMA device must wait for the end of the transmission,
+ * or 0.6 ms if it lasts longer. The TDMA device of a node which only
+ * gets its mobility after the first lookup must be found as well.
+ */
+class TdmaActivityIndexTest : public TestCase
+{
+public:
+  TdmaActivityIndexTest ();
+  virtual ~TdmaActivityIndexTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Create a node with its TDMA and CSMA devices
+   * \param tdma the channel of the TDMA device
+   * \param csma the channel of the CSMA device
+   * \return the node
+   */
+  Ptr<Node> CreateOne (Ptr<YansWifiChannel> tdma, Ptr<YansWifiChannel> csma);
+  /**
+   * Give a node its position
+   * \param node the node
+   * \param pos the position
+   */
+  void SetPosition (Ptr<Node> node, Vector pos);
+  /**
+   * Send a frame on the TDMA device of a node
+   * \param node the node
+   * \param size the size of the frame payload
+   * \param end the end of the transmission
+   */
+  void SendTdma (Ptr<Node> node, uint32_t size, Time *end);
+  /**
+   * Queue a frame on the CSMA device of a node
+   * \param node the node
+   */
+  void QueueCsma (Ptr<Node> node);
+  /**
+   * Check the end of the TDMA transmissions around a position
+   * \param pos the position
+   * \param expected the expected end, zero if none
+   */
+  void CheckBusyUntil (Vector pos, const Time *expected);
+  /**
+   * Callback triggered when a CSMA device starts to transmit
+   * \param p the packet
+   */
+  void TxBegin (Ptr<const Packet> p);
+
+  std::vector<Time> m_txBegin;  ///< start of the CSMA transmissions
+};
+
+TdmaActivityIndexTest::TdmaActivityIndexTest ()
+  : TestCase ("Check that Txop holds off while a TDMA device nearby transmits")
+{
+}
+
+TdmaActivityIndexTest::~TdmaActivityIndexTest ()
+{
+}
+
+Ptr<Node>
+TdmaActivityIndexTest::CreateOne (Ptr<YansWifiChannel> tdma, Ptr<YansWifiChannel> csma)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  ObjectFactory mac;
+  mac.SetTypeId ("ns3::AdhocWifiMac");
+  ObjectFactory manager;
+  manager.SetTypeId ("ns3::ConstantRateWifiManager");
+
+  Ptr<YansWifiChannel> channels[2] = { tdma, csma };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+      Ptr<WifiMac> wifiMac = mac.Create<WifiMac> ();
+      wifiMac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      wifiMac->SetAddress (Mac48Address::Allocate ());
+      AssignWifiRandomStreams (wifiMac, 5 * (2 * node->GetId () + i));
+      dev->SetMac (wifiMac);
+      dev->SetRemoteStationManager (manager.Create<WifiRemoteStationManager> ());
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->SetErrorRateModel (error);
+      phy->SetChannel (channels[i]);
+      phy->SetDevice (dev);
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      dev->SetPhy (phy);
+      node->AddDevice (dev);
+    }
+  return node;
+}
+
+void
+TdmaActivityIndexTest::SetPosition (Ptr<Node> node, Vector pos)
+{
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+}
+
+void
+TdmaActivityIndexTest::SendTdma (Ptr<Node> node, uint32_t size, Time *end)
+{
+  Ptr<WifiPhy> phy = DynamicCast<WifiNetDevice> (node->GetDevice (0))->GetPhy ();
+  WifiTxVector txVector = WifiTxVector (WifiPhy::GetOfdmRate6Mbps (), 0, WIFI_PREAMBLE_LONG, false, 1, 1, 0, 20, false, false);
+  Ptr<Packet> pkt = Create<Packet> (size);
+  WifiMacHeader hdr;
+  WifiMacTrailer trailer;
+  hdr.SetType (WIFI_MAC_DATA);
+  pkt->AddHeader (hdr);
+  pkt->AddTrailer (trailer);
+  phy->SendPacket (pkt, txVector);
+  *end = Simulator::Now () + phy->GetDelayUntilIdle ();
+}
+
+void
+TdmaActivityIndexTest::QueueCsma (Ptr<Node> node)
+{
+  PointerValue ptr;
+  DynamicCast<WifiNetDevice> (node->GetDevice (1))->GetMac ()->GetAttribute ("Txop", ptr);
+  Ptr<Txop> txop = ptr.Get<Txop> ();
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_DATA);
+  hdr.SetAddr1 (Mac48Address::GetBroadcast ());
+  hdr.SetAddr2 (Mac48Address::Allocate ());
+  hdr.SetAddr3 (Mac48Address::Allocate ());
+  hdr.SetDsNotFrom ();
+  hdr.SetDsNotTo ();
+  txop->Queue (Create<Packet> (100), hdr);
+  NS_TEST_EXPECT_MSG_EQ (txop->IsAccessRequested (), false, "access requested while a TDMA device nearby transmits");
+}
+
+void
+TdmaActivityIndexTest::CheckBusyUntil (Vector pos, const Time *expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (TdmaActivityIndex::Get ()->GetBusyUntil (pos, 200.0), *expected,
+                         "wrong end of the TDMA transmissions around " << pos);
+}
+
+void
+TdmaActivityIndexTest::TxBegin (Ptr<const Packet> p)
+{
+  m_txBegin.push_back (Simulator::Now ());
+}
+
+void
+TdmaActivityIndexTest::DoRun (void)
+{
+  Ptr<YansWifiChannel> tdma = CreateObject<YansWifiChannel> ();
+  tdma->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  tdma->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  Ptr<YansWifiChannel> csma = CreateObject<YansWifiChannel> ();
+  csma->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  csma->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+
+  Ptr<Node> sender = CreateOne (tdma, csma);
+  SetPosition (sender, Vector (0.0, 0.0, 0.0));
+  Ptr<Node> station = CreateOne (tdma, csma);
+  SetPosition (station, Vector (50.0, 0.0, 0.0));
+  Ptr<Node> far = CreateOne (tdma, csma);
+  SetPosition (far, Vector (1000.0, 0.0, 0.0));
+  // no mobility until after the first lookup
+  Ptr<Node> late = CreateOne (tdma, csma);
+  DynamicCast<WifiNetDevice> (station->GetDevice (1))->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&TdmaActivityIndexTest::TxBegin, this));
+
+  Time none;
+  Time shortEnd;
+  Time longEnd;
+  Time lateEnd;
+  Simulator::Schedule (MilliSeconds (1), &TdmaActivityIndexTest::CheckBusyUntil, this, Vector (0.0, 0.0, 0.0), &none);
+  Simulator::Schedule (MicroSeconds (1500), &TdmaActivityIndexTest::SetPosition, this, late, Vector (3000.0, 0.0, 0.0));
+
+  // a frame shorter than the deferral bound
+  Simulator::Schedule (MilliSeconds (2), &TdmaActivityIndexTest::SendTdma, this, sender, 100, &shortEnd);
+  Simulator::Schedule (MilliSeconds (2), &TdmaActivityIndexTest::CheckBusyUntil, this, Vector (50.0, 0.0, 0.0), &shortEnd);
+  Simulator::Schedule (MilliSeconds (2), &TdmaActivityIndexTest::CheckBusyUntil, this, Vector (500.0, 0.0, 0.0), &none);
+  Simulator::Schedule (MicroSeconds (2010), &TdmaActivityIndexTest::QueueCsma, this, station);
+
+  // a frame longer than the deferral bound
+  Simulator::Schedule (MilliSeconds (10), &TdmaActivityIndexTest::SendTdma, this, sender, 1500, &longEnd);
+  Simulator::Schedule (MicroSeconds (10010), &TdmaActivityIndexTest::QueueCsma, this, station);
+
+  Simulator::Schedule (MilliSeconds (20), &TdmaActivityIndexTest::SendTdma, this, late, 100, &lateEnd);
+  Simulator::Schedule (MilliSeconds (20), &TdmaActivityIndexTest::CheckBusyUntil, this, Vector (3000.0, 0.0, 0.0), &lateEnd);
+  Simulator::Schedule (MilliSeconds (20), &TdmaActivityIndexTest::CheckBusyUntil, this, Vector (0.0, 0.0, 0.0), &none);
+
+  Simulator::Stop (MilliSeconds (30));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_txBegin.size (), 2, "wrong number of CSMA transmissions");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_txBegin[0], shortEnd, "CSMA transmission during the TDMA one");
+  NS_TEST_ASSERT_MSG_LT (m_txBegin[0], shortEnd + MicroSeconds (200), "access not requested at the end of the TDMA transmission");
+  NS_TEST_ASSERT_MSG_GT (longEnd, MicroSeconds (10610), "TDMA transmission shorter than the deferral bound");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_txBegin[1], MicroSeconds (10610), "CSMA transmission before the deferral bound");
+  NS_TEST_ASSERT_MSG_LT (m_txBegin[1], MicroSeconds (10810), "access not requested at the deferral bound");
+}
+
 //-----------------------------------------------------------------------------
 /**
  * Make sure that Wifi STA is correctly associating to the best AP (i.e.,
@@ -1715,6 +2149,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new YansWifiChannelRxCullingTest, TestCase::QUICK);
+  AddTestCase (new TdmaActivityIndexTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite